@@ -3,12 +3,61 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include "glm/glm.hpp"
 #include "glm/gtx/compatibility.hpp"
 #include "sajson.h"
 
 #include "Animation.h"
 
+// Version 2 layout, keep in sync with run_on_coal/Elements/Animation/AnimationFormat.hpp
+#define ROC_ANIMATION_VERSION2_MARKER 0xA2U
+#define ROC_ANIMATION_VERSION2 2U
+#define ROC_ANIMATION_ROTATION_RANGE 0.70710678f
+#define ROC_ANIMATION_ROTATION_STEPS 32767.f
+#define ROC_ANIMATION_RANGE_STEPS 65535.f
+
+struct AnimationFileHeader
+{
+    char m_signature[3];
+    unsigned char m_marker;
+    unsigned int m_version;
+    unsigned int m_fps;
+    unsigned int m_framesCount;
+    unsigned int m_bonesCount;
+    unsigned int m_keysCount;
+    unsigned int m_rotationsCount;
+    unsigned int m_positionsCount;
+    unsigned int m_scalesCount;
+    unsigned int m_reserved[3];
+};
+struct AnimationFileTrack
+{
+    unsigned int m_keyOffset;
+    unsigned int m_keyCount;
+    unsigned int m_rotationOffset;
+    unsigned int m_positionOffset;
+    unsigned int m_scaleOffset;
+    unsigned int m_flags;
+    glm::vec4 m_rotation;
+    glm::vec3 m_positionMin;
+    glm::vec3 m_positionExtent;
+    glm::vec3 m_scaleMin;
+    glm::vec3 m_scaleExtent;
+};
+enum AnimationFileTrackFlag : unsigned int
+{
+    AFTF_ConstantRotation = (1U << 0),
+    AFTF_ConstantPosition = (1U << 1),
+    AFTF_ConstantScale = (1U << 2)
+};
+
+// Keys are dropped while engine interpolation between remaining keys stays in these bounds
+#define ROC_ANIMATION_POSITION_TOLERANCE 0.0005f
+#define ROC_ANIMATION_ROTATION_TOLERANCE 0.001f // Radians
+#define ROC_ANIMATION_SCALE_TOLERANCE 0.0005f
+
 Animation::Animation()
 {
     m_duration = 0U;
@@ -219,37 +268,189 @@ bool Animation::Load(const std::string &f_path)
     return true;
 }
 
+float EaseInOut(float f_value)
+{
+    return -0.5f*(cos(glm::pi<float>()*f_value) - 1.f);
+}
+float GetRotationError(const glm::quat &f_rotA, const glm::quat &f_rotB)
+{
+    float l_dot = std::min(std::abs(glm::dot(glm::normalize(f_rotA), glm::normalize(f_rotB))), 1.f);
+    return 2.f*std::acos(l_dot);
+}
+
+bool Animation::IsReducible(const std::vector<keyframeData> &f_keys, size_t f_start, size_t f_end, unsigned int f_constantFlags)
+{
+    const keyframeData &l_startKey = f_keys[f_start];
+    const keyframeData &l_endKey = f_keys[f_end];
+    if(l_endKey.m_frameIndex <= l_startKey.m_frameIndex) return false;
+
+    for(size_t i = f_start + 1U; i < f_end; i++)
+    {
+        const keyframeData &l_key = f_keys[i];
+        float l_blend = EaseInOut(static_cast<float>(l_key.m_frameIndex - l_startKey.m_frameIndex) / static_cast<float>(l_endKey.m_frameIndex - l_startKey.m_frameIndex));
+        if(!(f_constantFlags & AFTF_ConstantPosition))
+        {
+            if(glm::distance(glm::lerp(l_startKey.m_position, l_endKey.m_position, l_blend), l_key.m_position) > ROC_ANIMATION_POSITION_TOLERANCE) return false;
+        }
+        if(!(f_constantFlags & AFTF_ConstantRotation))
+        {
+            if(GetRotationError(glm::slerp(l_startKey.m_rotation, l_endKey.m_rotation, l_blend), l_key.m_rotation) > ROC_ANIMATION_ROTATION_TOLERANCE) return false;
+        }
+        if(!(f_constantFlags & AFTF_ConstantScale))
+        {
+            if(glm::distance(glm::lerp(l_startKey.m_scale, l_endKey.m_scale, l_blend), l_key.m_scale) > ROC_ANIMATION_SCALE_TOLERANCE) return false;
+        }
+    }
+    return true;
+}
+void Animation::ReduceKeys(const std::vector<keyframeData> &f_keys, unsigned int f_constantFlags, std::vector<size_t> &f_selected)
+{
+    // Greedy pass, every segment is stretched while skipped keys are restored within tolerances
+    size_t l_lastKey = f_keys.size() - 1U;
+    size_t l_start = 0U;
+    f_selected.clear();
+    f_selected.push_back(l_start);
+    while(l_start < l_lastKey)
+    {
+        size_t l_end = l_start + 1U;
+        while((l_end < l_lastKey) && IsReducible(f_keys, l_start, l_end + 1U, f_constantFlags)) l_end++;
+        f_selected.push_back(l_end);
+        l_start = l_end;
+    }
+}
+
+void Animation::PackRotation(const glm::quat &f_rot, unsigned short *f_data)
+{
+    glm::vec4 l_rotation = glm::normalize(glm::vec4(f_rot.x, f_rot.y, f_rot.z, f_rot.w));
+    int l_largest = 0;
+    for(int i = 1; i < 4; i++)
+    {
+        if(std::abs(l_rotation[i]) > std::abs(l_rotation[l_largest])) l_largest = i;
+    }
+    if(l_rotation[l_largest] < 0.f) l_rotation = -l_rotation;
+
+    for(int i = 0, j = 0; i < 4; i++)
+    {
+        if(i != l_largest)
+        {
+            float l_value = glm::clamp(l_rotation[i] / ROC_ANIMATION_ROTATION_RANGE, -1.f, 1.f);
+            f_data[j++] = static_cast<unsigned short>(std::round((l_value*0.5f + 0.5f)*ROC_ANIMATION_ROTATION_STEPS));
+        }
+    }
+    f_data[0] |= static_cast<unsigned short>((l_largest & 1) << 15);
+    f_data[1] |= static_cast<unsigned short>((l_largest >> 1) << 15);
+}
+void Animation::PackRange(const glm::vec3 &f_value, const glm::vec3 &f_min, const glm::vec3 &f_extent, unsigned short *f_data)
+{
+    for(int i = 0; i < 3; i++)
+    {
+        float l_value = ((f_extent[i] > 0.f) ? glm::clamp((f_value[i] - f_min[i]) / f_extent[i], 0.f, 1.f) : 0.f);
+        f_data[i] = static_cast<unsigned short>(std::round(l_value*ROC_ANIMATION_RANGE_STEPS));
+    }
+}
+
 bool Animation::Generate(const std::string &f_path)
 {
-    bool l_result = false;
-    if(m_loaded)
+    if(!m_loaded) ReportError("Animation hasn't been loaded yet");
+    if(m_duration > 0xFFFFU) ReportError("Animation duration is over 65535 frames");
+
+    std::vector<AnimationFileTrack> l_tracks;
+    std::vector<unsigned short> l_keyFrames;
+    std::vector<unsigned short> l_rotations;
+    std::vector<unsigned short> l_positions;
+    std::vector<unsigned short> l_scales;
+    std::vector<size_t> l_selected;
+    size_t l_sourceKeys = 0U;
+    for(unsigned int i = 0U; i < m_bonesCount; i++)
     {
-        std::ofstream l_file(f_path, std::ios::out | std::ios::binary);
-        if(!l_file.fail())
+        const std::vector<keyframeData> &l_keys = m_bones[i].m_keyframes;
+        l_sourceKeys += l_keys.size();
+
+        AnimationFileTrack l_track;
+        std::memset(&l_track, 0, sizeof(AnimationFileTrack));
+        l_track.m_flags = (AFTF_ConstantRotation | AFTF_ConstantPosition | AFTF_ConstantScale);
+        for(const auto &iter : l_keys)
+        {
+            if((iter.m_frameIndex < 0) || (iter.m_frameIndex > 0xFFFF)) ReportError("Bone " << i << " has key out of 65535 frames");
+            if(glm::distance(iter.m_position, l_keys[0].m_position) > ROC_ANIMATION_POSITION_TOLERANCE) l_track.m_flags &= ~AFTF_ConstantPosition;
+            if(GetRotationError(iter.m_rotation, l_keys[0].m_rotation) > ROC_ANIMATION_ROTATION_TOLERANCE) l_track.m_flags &= ~AFTF_ConstantRotation;
+            if(glm::distance(iter.m_scale, l_keys[0].m_scale) > ROC_ANIMATION_SCALE_TOLERANCE) l_track.m_flags &= ~AFTF_ConstantScale;
+        }
+        ReduceKeys(l_keys, l_track.m_flags, l_selected);
+
+        glm::vec3 l_positionMax, l_scaleMax;
+        l_track.m_positionMin = l_positionMax = l_keys[0].m_position;
+        l_track.m_scaleMin = l_scaleMax = l_keys[0].m_scale;
+        for(auto iter : l_selected)
         {
-            l_file.write(reinterpret_cast<char*>(&m_fps), sizeof(unsigned int));
-            l_file.write(reinterpret_cast<char*>(&m_duration), sizeof(unsigned int));
-            l_file.write(reinterpret_cast<char*>(&m_bonesCount), sizeof(unsigned int));
-            for(auto &iter : m_bones)
+            l_track.m_positionMin = glm::min(l_track.m_positionMin, l_keys[iter].m_position);
+            l_positionMax = glm::max(l_positionMax, l_keys[iter].m_position);
+            l_track.m_scaleMin = glm::min(l_track.m_scaleMin, l_keys[iter].m_scale);
+            l_scaleMax = glm::max(l_scaleMax, l_keys[iter].m_scale);
+        }
+        if(l_track.m_flags & AFTF_ConstantPosition) l_track.m_positionMin = l_keys[0].m_position;
+        else l_track.m_positionExtent = l_positionMax - l_track.m_positionMin;
+        if(l_track.m_flags & AFTF_ConstantScale) l_track.m_scaleMin = l_keys[0].m_scale;
+        else l_track.m_scaleExtent = l_scaleMax - l_track.m_scaleMin;
+        l_track.m_rotation = glm::vec4(l_keys[0].m_rotation.x, l_keys[0].m_rotation.y, l_keys[0].m_rotation.z, l_keys[0].m_rotation.w);
+
+        l_track.m_keyOffset = static_cast<unsigned int>(l_keyFrames.size());
+        l_track.m_keyCount = static_cast<unsigned int>(l_selected.size());
+        l_track.m_rotationOffset = static_cast<unsigned int>(l_rotations.size() / 3U);
+        l_track.m_positionOffset = static_cast<unsigned int>(l_positions.size() / 3U);
+        l_track.m_scaleOffset = static_cast<unsigned int>(l_scales.size() / 3U);
+        for(auto iter : l_selected)
+        {
+            const keyframeData &l_key = l_keys[iter];
+            unsigned short l_packed[3];
+            l_keyFrames.push_back(static_cast<unsigned short>(l_key.m_frameIndex));
+            if(!(l_track.m_flags & AFTF_ConstantRotation))
             {
-                int l_keyframesCount = iter.m_keyframes.size();
-                l_file.write(reinterpret_cast<char*>(&l_keyframesCount), sizeof(int));
-                for(auto &iter1 : iter.m_keyframes)
-                {
-                    l_file.write(reinterpret_cast<char*>(&iter1.m_position), sizeof(glm::vec3));
-                    l_file.write(reinterpret_cast<char*>(&iter1.m_rotation), sizeof(glm::quat));
-                    l_file.write(reinterpret_cast<char*>(&iter1.m_scale), sizeof(glm::vec3));
-                    l_file.write(reinterpret_cast<char*>(&iter1.m_frameIndex), sizeof(int));
-                }
+                PackRotation(l_key.m_rotation, l_packed);
+                l_rotations.insert(l_rotations.end(), l_packed, l_packed + 3);
+            }
+            if(!(l_track.m_flags & AFTF_ConstantPosition))
+            {
+                PackRange(l_key.m_position, l_track.m_positionMin, l_track.m_positionExtent, l_packed);
+                l_positions.insert(l_positions.end(), l_packed, l_packed + 3);
+            }
+            if(!(l_track.m_flags & AFTF_ConstantScale))
+            {
+                PackRange(l_key.m_scale, l_track.m_scaleMin, l_track.m_scaleExtent, l_packed);
+                l_scales.insert(l_scales.end(), l_packed, l_packed + 3);
             }
-            l_file.flush();
-            l_file.close();
-
-            Info("Animation has been converted to " << f_path);
-            l_result = true;
         }
-        else Info("Unable to create file " << f_path);
+        l_tracks.push_back(l_track);
+        Info("Bone " << i << ", " << l_keys.size() << " -> " << l_selected.size() << " keyframes" << ((l_track.m_flags & AFTF_ConstantRotation) ? ", constant rotation" : "") << ((l_track.m_flags & AFTF_ConstantPosition) ? ", constant position" : "") << ((l_track.m_flags & AFTF_ConstantScale) ? ", constant scale" : ""));
     }
-    else Info("Animation hasn't been loaded yet");
-    return l_result;
+
+    AnimationFileHeader l_header;
+    std::memset(&l_header, 0, sizeof(AnimationFileHeader));
+    std::memcpy(l_header.m_signature, "ROC", 3U);
+    l_header.m_marker = ROC_ANIMATION_VERSION2_MARKER;
+    l_header.m_version = ROC_ANIMATION_VERSION2;
+    l_header.m_fps = m_fps;
+    l_header.m_framesCount = m_duration;
+    l_header.m_bonesCount = m_bonesCount;
+    l_header.m_keysCount = static_cast<unsigned int>(l_keyFrames.size());
+    l_header.m_rotationsCount = static_cast<unsigned int>(l_rotations.size() / 3U);
+    l_header.m_positionsCount = static_cast<unsigned int>(l_positions.size() / 3U);
+    l_header.m_scalesCount = static_cast<unsigned int>(l_scales.size() / 3U);
+
+    std::ofstream l_file(f_path, std::ios::out | std::ios::binary);
+    if(l_file.fail()) ReportError("Unable to create file " << f_path);
+    l_file.write(reinterpret_cast<char*>(&l_header), sizeof(AnimationFileHeader));
+    l_file.write(reinterpret_cast<char*>(l_tracks.data()), l_tracks.size()*sizeof(AnimationFileTrack));
+    l_file.write(reinterpret_cast<char*>(l_keyFrames.data()), l_keyFrames.size()*sizeof(unsigned short));
+    l_file.write(reinterpret_cast<char*>(l_rotations.data()), l_rotations.size()*sizeof(unsigned short));
+    l_file.write(reinterpret_cast<char*>(l_positions.data()), l_positions.size()*sizeof(unsigned short));
+    l_file.write(reinterpret_cast<char*>(l_scales.data()), l_scales.size()*sizeof(unsigned short));
+    l_file.flush();
+    l_file.close();
+
+    size_t l_sourceSize = 12U + m_bonesCount*sizeof(int) + l_sourceKeys*44U;
+    size_t l_resultSize = sizeof(AnimationFileHeader) + l_tracks.size()*sizeof(AnimationFileTrack) + (l_keyFrames.size() + l_rotations.size() + l_positions.size() + l_scales.size())*sizeof(unsigned short);
+    Info("Keyframes reduced from " << l_sourceKeys << " to " << l_keyFrames.size() << ", size is " << l_resultSize << " bytes instead of " << l_sourceSize);
+    Info("Animation has been converted to " << f_path);
+    return true;
 }
@@ -22,6 +22,11 @@ class Animation
 
     void Clean();
 
+    static void ReduceKeys(const std::vector<keyframeData> &f_keys, unsigned int f_constantFlags, std::vector<size_t> &f_selected);
+    static bool IsReducible(const std::vector<keyframeData> &f_keys, size_t f_start, size_t f_end, unsigned int f_constantFlags);
+    static void PackRotation(const glm::quat &f_rot, unsigned short *f_data);
+    static void PackRange(const glm::vec3 &f_value, const glm::vec3 &f_min, const glm::vec3 &f_extent, unsigned short *f_data);
+
     struct boneData
     {
         glm::vec3 m_position;
@@ -5,11 +5,24 @@
 #include <fstream>
 #include <sstream>
 #include <bitset>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 #include "glm/glm.hpp"
 #include "glm/gtc/quaternion.hpp"
+#include "glm/gtc/type_precision.hpp"
 #include "sajson.h"
 #include "zlib.h"
 
+#include "Elements/Geometry/GeometryFormat.hpp"
+#include "Utils/MeshUtils.h"
+
+using ROC::GeometryFileHeader;
+using ROC::GeometryFileSection;
+using ROC::GeometryFileMaterial;
+using ROC::GeometryFileAttribute;
+
 struct Face
 {
     int m_materialIndices[9];
@@ -57,10 +70,10 @@ int GetMaxCompressedLen(int nLenSrc)
     return (nLenSrc + 6 + (n16kBlocks * 5));
 }
 
-#define Error(T) { std::cout << "Error: " << T << std::endl; return; }
+#define Error(T) { std::cout << "Error: " << T << std::endl; return false; }
 #define Info(T) std::cout << "Info: " << T << std::endl
 
-void ConvertJSON(std::string &f_path, std::string &f_out)
+bool ConvertJSON(std::string &f_path, std::string &f_out)
 {
     std::ifstream l_inputFile;
     l_inputFile.open(f_path);
@@ -443,9 +456,10 @@ void ConvertJSON(std::string &f_path, std::string &f_out)
     l_file.flush();
     l_file.close();
     Info("Model has been converted to " << f_out);
+    return true;
 }
 
-void ConvertOBJ(std::string &f_path, std::string &f_out)
+bool ConvertOBJ(std::string &f_path, std::string &f_out)
 {
     std::vector<glm::vec3> temp_vertex;
     std::vector<glm::vec2> temp_uv;
@@ -681,6 +695,257 @@ void ConvertOBJ(std::string &f_path, std::string &f_out)
     l_compressedData.clear();
 
     Info("Model has been converted to " << f_out);
+    return true;
+}
+
+struct GeometryCorner
+{
+    int m_vertex;
+    int m_uv;
+    int m_normal;
+    bool operator==(const GeometryCorner &f_corner) const { return ((m_vertex == f_corner.m_vertex) && (m_uv == f_corner.m_uv) && (m_normal == f_corner.m_normal)); }
+};
+struct GeometryCornerHash
+{
+    size_t operator()(const GeometryCorner &f_corner) const
+    {
+        size_t l_hash = std::hash<int>()(f_corner.m_vertex);
+        l_hash ^= std::hash<int>()(f_corner.m_uv) + 0x9E3779B9U + (l_hash << 6) + (l_hash >> 2);
+        l_hash ^= std::hash<int>()(f_corner.m_normal) + 0x9E3779B9U + (l_hash << 6) + (l_hash >> 2);
+        return l_hash;
+    }
+};
+
+void AddSection(std::vector<GeometryFileSection> &f_sections, std::vector<std::vector<unsigned char>> &f_blocks, unsigned int f_type, const void *f_data, size_t f_size, bool f_compress)
+{
+    GeometryFileSection l_section;
+    l_section.m_type = f_type;
+    l_section.m_compression = ROC::GFC_None;
+    l_section.m_offset = 0U;
+    l_section.m_size = l_section.m_rawSize = f_size;
+
+    std::vector<unsigned char> l_block(static_cast<const unsigned char*>(f_data), static_cast<const unsigned char*>(f_data) + f_size);
+    if(f_compress && (f_size > 0U))
+    {
+        int l_maxSize = GetMaxCompressedLen(static_cast<int>(f_size));
+        std::vector<unsigned char> l_compressedData(l_maxSize);
+        int l_compressedSize = CompressData(l_block.data(), static_cast<int>(f_size), l_compressedData.data(), l_maxSize);
+        if((l_compressedSize != -1) && (static_cast<size_t>(l_compressedSize) < f_size))
+        {
+            // Compression is kept only where it pays off, other sections stay mappable as is
+            l_compressedData.resize(l_compressedSize);
+            l_block.swap(l_compressedData);
+            l_section.m_compression = ROC::GFC_Zlib;
+            l_section.m_size = l_compressedSize;
+        }
+    }
+    f_sections.push_back(l_section);
+    f_blocks.push_back(l_block);
+}
+
+template<class T> void ReadBlock(std::istream &f_stream, std::vector<T> &f_data)
+{
+    int l_compressedSize, l_uncompressedSize;
+    f_stream.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+    f_stream.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+    std::vector<unsigned char> l_compressedData(l_compressedSize);
+    f_stream.read(reinterpret_cast<char*>(l_compressedData.data()), l_compressedSize);
+    f_data.resize(l_uncompressedSize / sizeof(T));
+    UncompressData(l_compressedData.data(), l_compressedSize, f_data.data(), l_uncompressedSize);
+}
+
+// Rewrites version 1 file as version 2: indexed and interleaved GPU-ready blocks in 16 bytes aligned sections
+bool ConvertToVersion2(const std::string &f_path, bool f_compress)
+{
+    std::ifstream l_inputFile(f_path, std::ios::in | std::ios::binary);
+    if(l_inputFile.fail()) Error("Unable to open " << f_path);
+    std::string l_fileData((std::istreambuf_iterator<char>(l_inputFile)), std::istreambuf_iterator<char>());
+    l_inputFile.close();
+
+    std::istringstream l_stream(l_fileData);
+    l_stream.exceptions(std::istream::failbit | std::istream::badbit);
+
+    GeometryFileHeader l_header = { { 'R', 'O', 'C' }, ROC_GEOMETRY_VERSION2_MARKER, ROC_GEOMETRY_VERSION2, 0U, 0U, glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()), { 0U, 0U } };
+    std::vector<GeometryFileSection> l_sections;
+    std::vector<std::vector<unsigned char>> l_blocks;
+    try
+    {
+        std::string l_signature(3U, '\0');
+        l_stream.read(&l_signature[0], 3U);
+        if(l_signature.compare("ROC")) Error("Not a geometry file");
+        unsigned char l_type;
+        l_stream.read(reinterpret_cast<char*>(&l_type), sizeof(unsigned char));
+        if(l_type == ROC_GEOMETRY_VERSION2_MARKER)
+        {
+            Info("File is already in version 2 format");
+            return true;
+        }
+        bool l_animated = (l_type == ROC_GEOMETRY_SETTER_ANIMATED);
+        if(l_animated) l_header.m_flags |= ROC::GFF_Animated;
+
+        std::vector<glm::vec3> l_vertexData, l_normalData;
+        std::vector<glm::vec2> l_uvData;
+        std::vector<glm::vec4> l_weightData;
+        std::vector<glm::ivec4> l_indexData;
+        ReadBlock(l_stream, l_vertexData);
+        ReadBlock(l_stream, l_uvData);
+        ReadBlock(l_stream, l_normalData);
+        if(l_animated)
+        {
+            ReadBlock(l_stream, l_weightData);
+            ReadBlock(l_stream, l_indexData);
+        }
+
+        int l_materialCount;
+        l_stream.read(reinterpret_cast<char*>(&l_materialCount), sizeof(int));
+        for(int i = 0; i < l_materialCount; i++)
+        {
+            GeometryFileMaterial l_material;
+            unsigned char l_textureLength;
+            std::string l_texture;
+            l_stream.read(reinterpret_cast<char*>(&l_material.m_type), sizeof(unsigned char));
+            l_stream.read(reinterpret_cast<char*>(&l_material.m_params), sizeof(glm::vec4));
+            l_stream.read(reinterpret_cast<char*>(&l_textureLength), sizeof(unsigned char));
+            if(l_textureLength)
+            {
+                l_texture.resize(l_textureLength);
+                l_stream.read(&l_texture[0], l_textureLength);
+            }
+            std::vector<int> l_faceIndex;
+            ReadBlock(l_stream, l_faceIndex);
+
+            std::vector<GeometryCorner> l_corners;
+            std::vector<unsigned int> l_elements;
+            std::unordered_map<GeometryCorner, unsigned int, GeometryCornerHash> l_cornerMap;
+            for(size_t j = 0U; j + 9U <= l_faceIndex.size(); j += 9U)
+            {
+                for(size_t k = 0U; k < 3U; k++)
+                {
+                    GeometryCorner l_corner = { l_faceIndex[j + k], l_faceIndex[j + 3U + k], l_faceIndex[j + 6U + k] };
+                    if((l_corner.m_vertex < 0) || (l_corner.m_vertex >= static_cast<int>(l_vertexData.size())) || (l_corner.m_uv < 0) || (l_corner.m_uv >= static_cast<int>(l_uvData.size())) ||
+                        (l_corner.m_normal < 0) || (l_corner.m_normal >= static_cast<int>(l_normalData.size()))) Error("Wrong face index in material " << i);
+                    auto l_cornerIter = l_cornerMap.find(l_corner);
+                    if(l_cornerIter == l_cornerMap.end())
+                    {
+                        l_cornerMap.insert(std::make_pair(l_corner, static_cast<unsigned int>(l_corners.size())));
+                        l_elements.push_back(static_cast<unsigned int>(l_corners.size()));
+                        l_corners.push_back(l_corner);
+                    }
+                    else l_elements.push_back(l_cornerIter->second);
+                }
+            }
+            MeshUtils::OptimizeVertexCache(l_elements, static_cast<unsigned int>(l_corners.size()));
+
+            std::vector<unsigned int> l_remap(l_corners.size(), std::numeric_limits<unsigned int>::max());
+            std::vector<glm::vec3> l_tempVertex, l_tempNormal;
+            std::vector<glm::vec2> l_tempUV;
+            std::vector<glm::vec4> l_tempWeight;
+            std::vector<glm::ivec4> l_tempIndex;
+            for(auto &iter : l_elements)
+            {
+                if(l_remap[iter] == std::numeric_limits<unsigned int>::max())
+                {
+                    const GeometryCorner &l_corner = l_corners[iter];
+                    l_remap[iter] = static_cast<unsigned int>(l_tempVertex.size());
+                    l_tempVertex.push_back(l_vertexData[l_corner.m_vertex]);
+                    l_tempUV.push_back(l_uvData[l_corner.m_uv]);
+                    l_tempNormal.push_back(l_normalData[l_corner.m_normal]);
+                    if(l_animated)
+                    {
+                        l_tempWeight.push_back(l_weightData[l_corner.m_vertex]);
+                        l_tempIndex.push_back(l_indexData[l_corner.m_vertex]);
+                    }
+                    l_header.m_boundMin = glm::min(l_header.m_boundMin, l_tempVertex.back());
+                    l_header.m_boundMax = glm::max(l_header.m_boundMax, l_tempVertex.back());
+                }
+                iter = l_remap[iter];
+            }
+
+            std::vector<GeometryFileAttribute> l_attributes;
+            std::vector<unsigned char> l_vertexBuffer;
+            MeshUtils::PackVertices(l_tempVertex, l_tempUV, l_tempNormal, l_tempWeight, l_tempIndex, true, l_attributes, l_material.m_stride, l_vertexBuffer);
+
+            std::vector<unsigned char> l_elementBuffer;
+            l_material.m_elementSize = (l_tempVertex.size() <= std::numeric_limits<unsigned short>::max()) ? 2U : 4U;
+            l_elementBuffer.resize(l_elements.size()*l_material.m_elementSize);
+            for(size_t j = 0U; j < l_elements.size(); j++)
+            {
+                if(l_material.m_elementSize == 2U)
+                {
+                    unsigned short l_element = static_cast<unsigned short>(l_elements[j]);
+                    std::memcpy(l_elementBuffer.data() + j*2U, &l_element, sizeof(unsigned short));
+                }
+                else std::memcpy(l_elementBuffer.data() + j*4U, &l_elements[j], sizeof(unsigned int));
+            }
+
+            l_material.m_textureLength = l_textureLength;
+            l_material.m_attributeCount = static_cast<unsigned char>(l_attributes.size());
+            l_material.m_vertexCount = static_cast<unsigned int>(l_tempVertex.size());
+            l_material.m_elementCount = static_cast<unsigned int>(l_elements.size());
+            std::vector<unsigned char> l_materialBuffer(sizeof(GeometryFileMaterial) + l_attributes.size()*sizeof(GeometryFileAttribute) + l_texture.size());
+            std::memcpy(l_materialBuffer.data(), &l_material, sizeof(GeometryFileMaterial));
+            std::memcpy(l_materialBuffer.data() + sizeof(GeometryFileMaterial), l_attributes.data(), l_attributes.size()*sizeof(GeometryFileAttribute));
+            if(!l_texture.empty()) std::memcpy(l_materialBuffer.data() + sizeof(GeometryFileMaterial) + l_attributes.size()*sizeof(GeometryFileAttribute), l_texture.data(), l_texture.size());
+
+            AddSection(l_sections, l_blocks, ROC::GFST_Material, l_materialBuffer.data(), l_materialBuffer.size(), false);
+            AddSection(l_sections, l_blocks, ROC::GFST_Vertices, l_vertexBuffer.data(), l_vertexBuffer.size(), f_compress);
+            AddSection(l_sections, l_blocks, ROC::GFST_Elements, l_elementBuffer.data(), l_elementBuffer.size(), f_compress);
+            Info("Material " << i << ", " << l_material.m_vertexCount << " vertices, " << l_material.m_elementCount << " elements, stride " << l_material.m_stride);
+        }
+
+        if(l_animated)
+        {
+            // Bones and collision blocks are copied as is, engine parses them with version 1 readers
+            size_t l_bonesStart = static_cast<size_t>(l_stream.tellg());
+            int l_bonesCount;
+            l_stream.read(reinterpret_cast<char*>(&l_bonesCount), sizeof(int));
+            for(int i = 0; i < l_bonesCount; i++)
+            {
+                unsigned char l_nameLength;
+                l_stream.read(reinterpret_cast<char*>(&l_nameLength), sizeof(unsigned char));
+                l_stream.ignore(l_nameLength + sizeof(int) + sizeof(glm::vec3) + sizeof(glm::quat) + sizeof(glm::vec3));
+            }
+            size_t l_bonesEnd = static_cast<size_t>(l_stream.tellg());
+            if(l_bonesEnd > l_fileData.size()) Error("Wrong bones data");
+            AddSection(l_sections, l_blocks, ROC::GFST_Bones, l_fileData.data() + l_bonesStart, l_bonesEnd - l_bonesStart, f_compress);
+
+            if((l_bonesEnd < l_fileData.size()) && (static_cast<unsigned char>(l_fileData[l_bonesEnd]) == ROC_GEOMETRY_SETTER_COLLISION))
+            {
+                AddSection(l_sections, l_blocks, ROC::GFST_Collision, l_fileData.data() + l_bonesEnd + 1U, l_fileData.size() - l_bonesEnd - 1U, f_compress);
+            }
+        }
+    }
+    catch(const std::exception&)
+    {
+        Error("Unable to parse " << f_path);
+    }
+    if(l_header.m_boundMin.x > l_header.m_boundMax.x) l_header.m_boundMin = l_header.m_boundMax = glm::vec3(0.f);
+
+    l_header.m_sectionCount = static_cast<unsigned int>(l_sections.size());
+    unsigned long long l_offset = sizeof(GeometryFileHeader) + l_sections.size()*sizeof(GeometryFileSection);
+    for(auto &iter : l_sections)
+    {
+        l_offset = (l_offset + ROC_GEOMETRY_VERSION2_ALIGNMENT - 1U) & ~static_cast<unsigned long long>(ROC_GEOMETRY_VERSION2_ALIGNMENT - 1U);
+        iter.m_offset = l_offset;
+        l_offset += iter.m_size;
+    }
+
+    std::ofstream l_outputFile(f_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if(l_outputFile.fail()) Error("Unable to create output file");
+    l_outputFile.write(reinterpret_cast<char*>(&l_header), sizeof(GeometryFileHeader));
+    l_outputFile.write(reinterpret_cast<char*>(l_sections.data()), l_sections.size()*sizeof(GeometryFileSection));
+    unsigned long long l_position = sizeof(GeometryFileHeader) + l_sections.size()*sizeof(GeometryFileSection);
+    const char l_padding[ROC_GEOMETRY_VERSION2_ALIGNMENT] = { 0 };
+    for(size_t i = 0U; i < l_sections.size(); i++)
+    {
+        l_outputFile.write(l_padding, static_cast<std::streamsize>(l_sections[i].m_offset - l_position));
+        l_outputFile.write(reinterpret_cast<char*>(l_blocks[i].data()), l_blocks[i].size());
+        l_position = l_sections[i].m_offset + l_sections[i].m_size;
+    }
+    l_outputFile.flush();
+    l_outputFile.close();
+    Info("Model has been converted to version 2 format, " << l_sections.size() << " sections" << (f_compress ? ", compressed" : ""));
+    return true;
 }
 
 int main(int argc, char *argv[])
@@ -689,6 +954,15 @@ int main(int argc, char *argv[])
     {
         std::string l_inputFile(argv[1]);
         std::string l_outputFile;
+        // Version 2 upgrade is opt-in, version 1 output can be extended by collisionConverter
+        bool l_version2 = false;
+        bool l_compress = false;
+        for(int i = 2; i < argc; i++)
+        {
+            std::string l_option(argv[i]);
+            if(!l_option.compare("-v2")) l_version2 = true;
+            else if(!l_option.compare("-z")) l_compress = true;
+        }
 
         size_t l_searchResult = l_inputFile.find(std::string(".obj"));
         if(l_searchResult != std::string::npos)
@@ -697,7 +971,7 @@ int main(int argc, char *argv[])
             l_inputFile = l_inputFile.substr(0U, l_searchResult);
             l_outputFile.assign(l_inputFile);
             l_outputFile.append(".rmf");
-            ConvertOBJ(l_inputFile, l_outputFile);
+            if(ConvertOBJ(l_inputFile, l_outputFile) && l_version2) ConvertToVersion2(l_outputFile, l_compress);
         }
         else
         {
@@ -707,12 +981,21 @@ int main(int argc, char *argv[])
                 Info("Converting THREE.js JSON (animated)...");
                 l_outputFile = l_inputFile.substr(0U, l_searchResult);
                 l_outputFile.append(".rmf");
-                ConvertJSON(l_inputFile, l_outputFile);
+                if(ConvertJSON(l_inputFile, l_outputFile) && l_version2) ConvertToVersion2(l_outputFile, l_compress);
+            }
+            else
+            {
+                l_searchResult = l_inputFile.find(std::string(".rmf"));
+                if(l_searchResult != std::string::npos)
+                {
+                    Info("Upgrading RMF to version 2 ...");
+                    ConvertToVersion2(l_inputFile, l_compress);
+                }
+                else Info("Unknown format. Avaliable formats: obj, json (THREE.js animated), rmf (upgrade)");
             }
-            else Info("Unknown format. Avaliable formats: obj, json (THREE.js animated)");
         }
     }
-    else std::cout << "Usage: [input_file]" << std::endl;
+    else std::cout << "Usage: [input_file] [-v2] [-z]" << std::endl;
     Info("Press any key to exit");
     std::getchar();
     return EXIT_SUCCESS;
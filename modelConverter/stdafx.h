@@ -0,0 +1,10 @@
+#pragma once
+// Engine sources shared with converter include "stdafx.h", this one takes place of engine's precompiled header
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
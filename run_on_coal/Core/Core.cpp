@@ -18,6 +18,7 @@
 #include "Lua/LuaArguments.h"
 
 #include "Utils/SystemTick.h"
+#include "Utils/WorkerPool.h"
 
 #define CORE_DEFAULT_SCIPTS_PATH "scripts/"
 
@@ -35,6 +36,16 @@ ROC::Core::Core()
     m_workingDir.push_back('/');
 
     m_configManager = new ConfigManager();
+
+    unsigned int l_threadsCount = m_configManager->GetUpdateThreads();
+    if(l_threadsCount == 0U)
+    {
+        // Main thread takes part in jobs too
+        l_threadsCount = std::thread::hardware_concurrency();
+        l_threadsCount = (l_threadsCount > 1U) ? (l_threadsCount - 1U) : 0U;
+    }
+    m_workerPool = new WorkerPool(l_threadsCount);
+
     m_logManager = new LogManager(this);
     m_memoryManager = new MemoryManager();
     m_inheritManager = new InheritanceManager(this);
@@ -70,6 +81,7 @@ ROC::Core::~Core()
     delete m_preRenderManager;
     delete m_sfmlManager;
     delete m_logManager;
+    delete m_workerPool;
     delete m_configManager;
 
     delete m_argument;
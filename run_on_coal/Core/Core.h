@@ -17,6 +17,7 @@ class PreRenderManager;
 class RenderManager;
 class SoundManager;
 class LuaArguments;
+class WorkerPool;
 
 typedef void(*OnEngineStartCallback)(void);
 typedef void(*OnEngineStopCallback)(void);
@@ -38,6 +39,7 @@ class Core final
     RenderManager *m_renderManager;
     PreRenderManager *m_preRenderManager;
     SoundManager *m_soundManager;
+    WorkerPool *m_workerPool;
 
     std::string m_workingDir;
     bool m_state;
@@ -73,6 +75,7 @@ public:
     inline RenderManager* GetRenderManager() { return m_renderManager; }
     inline PreRenderManager* GetPreRenderManager() { return m_preRenderManager; }
     inline SoundManager* GetSoundManager() { return m_soundManager; }
+    inline WorkerPool* GetWorkerPool() { return m_workerPool; }
 };
 
 }
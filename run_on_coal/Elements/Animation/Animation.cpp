@@ -1,12 +1,14 @@
 #include "stdafx.h"
 
 #include "Elements/Animation/Animation.h"
-#include "Elements/Animation/BoneFrameData.h"
 
-#include "Elements/Model/Bone.h"
 #include "Utils/MathUtils.h"
 
-ROC::Animation::Animation()
+#define ROC_ANIMATION_CURSOR_STEPS 4U
+#define ROC_ANIMATION_VERSION1_HEADER_SIZE 12U
+#define ROC_ANIMATION_VERSION1_KEY_SIZE 44U
+
+ROC::Animation::Animation(bool f_async)
 {
     m_elementType = ET_Animation;
     m_elementTypeName.assign("Animation");
@@ -15,9 +17,10 @@ ROC::Animation::Animation()
     m_duration = 0U;
     m_fps = 0U;
     m_frameDelta = 0U;
-    m_tempFrameData = nullptr;
     m_bonesCount = 0U;
     m_loaded = false;
+    m_async = f_async;
+    m_released = !m_async;
 }
 ROC::Animation::~Animation()
 {
@@ -30,18 +33,12 @@ void ROC::Animation::Clean()
     m_framesCount = 0U;
     m_duration = 0U;
     m_fps = 0U;
-    delete m_tempFrameData;
-    for(auto iter : m_boneIntervals)
-    {
-        auto &l_intervals = iter->intervals;
-        for(size_t i = 0, j = l_intervals.size(); i < j; i++)
-        {
-            if(i == 0U) delete l_intervals[i].value.m_leftData;
-            else delete l_intervals[i].value.m_rightData;
-        }
-        delete iter;
-    }
-    m_boneIntervals.clear();
+    m_tracks.clear();
+    m_keyFrames.clear();
+    m_rotations.clear();
+    m_positions.clear();
+    m_scales.clear();
+    m_staticKeys.clear();
     m_loaded = false;
 }
 
@@ -53,62 +50,24 @@ bool ROC::Animation::Load(const std::string &f_path)
         l_animFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
         try
         {
+            // Whole file is read at once and decoded from memory
             l_animFile.open(f_path, std::ios::binary | std::ios::in);
-            l_animFile.read(reinterpret_cast<char*>(&m_fps), sizeof(unsigned int));
-            l_animFile.read(reinterpret_cast<char*>(&m_framesCount), sizeof(unsigned int));
-            l_animFile.read(reinterpret_cast<char*>(&m_bonesCount), sizeof(unsigned int));
-
-            m_frameDelta = 1000U / m_fps;
-            m_duration = m_framesCount * m_frameDelta;
+            l_animFile.seekg(0, std::ios::end);
+            size_t l_fileSize = static_cast<size_t>(l_animFile.tellg());
+            l_animFile.seekg(0, std::ios::beg);
+            std::vector<unsigned char> l_fileData(l_fileSize);
+            if(l_fileSize > 0U) l_animFile.read(reinterpret_cast<char*>(l_fileData.data()), l_fileSize);
+            l_animFile.close();
 
-            for(unsigned int i = 0; i < m_bonesCount; i++)
+            bool l_version2 = ((l_fileSize >= sizeof(AnimationFileHeader)) && (std::memcmp(l_fileData.data(), "ROC", 3U) == 0) && (l_fileData[3] == ROC_ANIMATION_VERSION2_MARKER));
+            m_loaded = (l_version2 ? LoadVersion2(l_fileData) : LoadVersion1(l_fileData));
+            if(m_loaded)
             {
-                std::vector<Interval<keyframeData>> l_intervals;
-                Interval<keyframeData> l_interval(0, 0, keyframeData());
-
-                int l_intervalsCount = 0;
-                l_animFile.read(reinterpret_cast<char*>(&l_intervalsCount), sizeof(int));
-
-                for(int j = 0; j < l_intervalsCount; j++)
-                {
-                    glm::vec3 l_position;
-                    glm::quat l_rotation;
-                    glm::vec3 l_scale;
-                    int l_frameIndex;
-                    l_animFile.read(reinterpret_cast<char*>(&l_position), sizeof(glm::vec3));
-                    l_animFile.read(reinterpret_cast<char*>(&l_rotation), sizeof(glm::quat));
-                    l_animFile.read(reinterpret_cast<char*>(&l_scale), sizeof(glm::vec3));
-                    l_animFile.read(reinterpret_cast<char*>(&l_frameIndex), sizeof(int));
-
-                    if(j == 0)
-                    {
-                        l_interval.start = l_frameIndex;
-                        l_interval.value.m_leftData = new BoneFrameData(l_position, l_rotation, l_scale);
-                    }
-                    else
-                    {
-                        l_interval.stop = l_frameIndex;
-
-                        auto &l_value = l_interval.value;
-                        l_value.m_rightData = new BoneFrameData(l_position, l_rotation, l_scale);
-                        l_value.m_duration = l_frameIndex*m_frameDelta - l_value.m_startTime;
-                        l_value.m_static = l_value.m_leftData->IsEqual(l_value.m_rightData);
-                        l_intervals.push_back(l_interval);
-
-                        l_interval.start = l_frameIndex;
-                        l_value.m_leftData = l_value.m_rightData;
-                        l_value.m_startTime = l_frameIndex*m_frameDelta;
-                        l_value.m_rightData = nullptr;
-                    }
-                }
-                l_intervals.shrink_to_fit();
-                m_boneIntervals.push_back(new IntervalTree<keyframeData>(l_intervals));
+                GenerateStaticKeys();
+                m_frameDelta = 1000U / m_fps;
+                m_duration = m_framesCount * m_frameDelta;
             }
-            m_boneIntervals.shrink_to_fit();
-            l_animFile.close();
-
-            m_tempFrameData = new BoneFrameData();
-            m_loaded = true;
+            else Clean();
         }
         catch(const std::exception&)
         {
@@ -118,26 +77,332 @@ bool ROC::Animation::Load(const std::string &f_path)
     return m_loaded;
 }
 
-void ROC::Animation::GetData(unsigned int f_tick, std::vector<Bone*> &f_bones)
+bool ROC::Animation::LoadVersion1(const std::vector<unsigned char> &f_data)
+{
+    bool l_result = (f_data.size() >= ROC_ANIMATION_VERSION1_HEADER_SIZE);
+    if(l_result)
+    {
+        std::memcpy(&m_fps, f_data.data(), sizeof(unsigned int));
+        std::memcpy(&m_framesCount, f_data.data() + 4U, sizeof(unsigned int));
+        std::memcpy(&m_bonesCount, f_data.data() + 8U, sizeof(unsigned int));
+        l_result = ((m_fps > 0U) && (m_fps <= 1000U) && (m_framesCount > 0U));
+    }
+
+    // Old files have full precision keys, they are quantized on load without keys reduction
+    size_t l_offset = ROC_ANIMATION_VERSION1_HEADER_SIZE;
+    std::vector<glm::vec3> l_positions;
+    std::vector<glm::quat> l_rotations;
+    std::vector<glm::vec3> l_scales;
+    for(unsigned int i = 0U; l_result && (i < m_bonesCount); i++)
+    {
+        int l_keysCount = 0;
+        l_result = (f_data.size() - l_offset >= sizeof(int));
+        if(l_result)
+        {
+            std::memcpy(&l_keysCount, f_data.data() + l_offset, sizeof(int));
+            l_offset += sizeof(int);
+            l_result = ((l_keysCount >= 0) && (static_cast<size_t>(l_keysCount) <= (f_data.size() - l_offset) / ROC_ANIMATION_VERSION1_KEY_SIZE));
+        }
+        if(!l_result) break;
+
+        AnimationFileTrack l_track;
+        std::memset(&l_track, 0, sizeof(AnimationFileTrack));
+        l_track.m_keyOffset = static_cast<unsigned int>(m_keyFrames.size());
+        l_track.m_keyCount = static_cast<unsigned int>(l_keysCount);
+        l_track.m_flags = (AFTF_ConstantRotation | AFTF_ConstantPosition | AFTF_ConstantScale);
+
+        l_positions.resize(l_track.m_keyCount);
+        l_rotations.resize(l_track.m_keyCount);
+        l_scales.resize(l_track.m_keyCount);
+        glm::vec3 l_positionMax(0.f), l_scaleMax(0.f);
+        for(unsigned int j = 0U; l_result && (j < l_track.m_keyCount); j++)
+        {
+            const unsigned char *l_key = f_data.data() + l_offset;
+            int l_frameIndex;
+            std::memcpy(&l_positions[j], l_key, sizeof(glm::vec3));
+            std::memcpy(&l_rotations[j], l_key + 12U, sizeof(glm::quat));
+            std::memcpy(&l_scales[j], l_key + 28U, sizeof(glm::vec3));
+            std::memcpy(&l_frameIndex, l_key + 40U, sizeof(int));
+            l_offset += ROC_ANIMATION_VERSION1_KEY_SIZE;
+
+            l_result = ((l_frameIndex >= 0) && (l_frameIndex <= std::numeric_limits<unsigned short>::max()));
+            m_keyFrames.push_back(static_cast<unsigned short>(l_frameIndex));
+
+            if(j == 0U)
+            {
+                l_track.m_positionMin = l_positionMax = l_positions[j];
+                l_track.m_scaleMin = l_scaleMax = l_scales[j];
+            }
+            else
+            {
+                if(l_positions[j] != l_positions[0]) l_track.m_flags &= ~AFTF_ConstantPosition;
+                if(l_rotations[j] != l_rotations[0]) l_track.m_flags &= ~AFTF_ConstantRotation;
+                if(l_scales[j] != l_scales[0]) l_track.m_flags &= ~AFTF_ConstantScale;
+                l_track.m_positionMin = glm::min(l_track.m_positionMin, l_positions[j]);
+                l_positionMax = glm::max(l_positionMax, l_positions[j]);
+                l_track.m_scaleMin = glm::min(l_track.m_scaleMin, l_scales[j]);
+                l_scaleMax = glm::max(l_scaleMax, l_scales[j]);
+            }
+        }
+        if(!l_result) break;
+
+        l_track.m_positionExtent = l_positionMax - l_track.m_positionMin;
+        l_track.m_scaleExtent = l_scaleMax - l_track.m_scaleMin;
+        if(l_track.m_keyCount > 0U) l_track.m_rotation = glm::vec4(l_rotations[0].x, l_rotations[0].y, l_rotations[0].z, l_rotations[0].w);
+        l_track.m_rotationOffset = static_cast<unsigned int>(m_rotations.size() / 3U);
+        l_track.m_positionOffset = static_cast<unsigned int>(m_positions.size() / 3U);
+        l_track.m_scaleOffset = static_cast<unsigned int>(m_scales.size() / 3U);
+        for(unsigned int j = 0U; j < l_track.m_keyCount; j++)
+        {
+            unsigned short l_packed[3];
+            if(!(l_track.m_flags & AFTF_ConstantRotation))
+            {
+                PackRotation(l_rotations[j], l_packed);
+                m_rotations.insert(m_rotations.end(), l_packed, l_packed + 3);
+            }
+            if(!(l_track.m_flags & AFTF_ConstantPosition))
+            {
+                PackRange(l_positions[j], l_track.m_positionMin, l_track.m_positionExtent, l_packed);
+                m_positions.insert(m_positions.end(), l_packed, l_packed + 3);
+            }
+            if(!(l_track.m_flags & AFTF_ConstantScale))
+            {
+                PackRange(l_scales[j], l_track.m_scaleMin, l_track.m_scaleExtent, l_packed);
+                m_scales.insert(m_scales.end(), l_packed, l_packed + 3);
+            }
+        }
+        m_tracks.push_back(l_track);
+    }
+    if(l_result)
+    {
+        m_tracks.shrink_to_fit();
+        m_keyFrames.shrink_to_fit();
+        m_rotations.shrink_to_fit();
+        m_positions.shrink_to_fit();
+        m_scales.shrink_to_fit();
+    }
+    return l_result;
+}
+bool ROC::Animation::LoadVersion2(const std::vector<unsigned char> &f_data)
+{
+    bool l_result = false;
+
+    AnimationFileHeader l_header;
+    std::memcpy(&l_header, f_data.data(), sizeof(AnimationFileHeader));
+    if((l_header.m_version == ROC_ANIMATION_VERSION2) && (l_header.m_fps > 0U) && (l_header.m_fps <= 1000U) && (l_header.m_framesCount > 0U))
+    {
+        size_t l_tracksSize = static_cast<size_t>(l_header.m_bonesCount)*sizeof(AnimationFileTrack);
+        size_t l_framesSize = static_cast<size_t>(l_header.m_keysCount)*sizeof(unsigned short);
+        size_t l_rotationsSize = static_cast<size_t>(l_header.m_rotationsCount)*3U*sizeof(unsigned short);
+        size_t l_positionsSize = static_cast<size_t>(l_header.m_positionsCount)*3U*sizeof(unsigned short);
+        size_t l_scalesSize = static_cast<size_t>(l_header.m_scalesCount)*3U*sizeof(unsigned short);
+        if(f_data.size() == sizeof(AnimationFileHeader) + l_tracksSize + l_framesSize + l_rotationsSize + l_positionsSize + l_scalesSize)
+        {
+            m_fps = l_header.m_fps;
+            m_framesCount = l_header.m_framesCount;
+            m_bonesCount = l_header.m_bonesCount;
+
+            const unsigned char *l_data = f_data.data() + sizeof(AnimationFileHeader);
+            m_tracks.resize(m_bonesCount);
+            if(l_tracksSize > 0U) std::memcpy(m_tracks.data(), l_data, l_tracksSize);
+            l_data += l_tracksSize;
+            m_keyFrames.resize(l_header.m_keysCount);
+            if(l_framesSize > 0U) std::memcpy(m_keyFrames.data(), l_data, l_framesSize);
+            l_data += l_framesSize;
+            m_rotations.resize(l_header.m_rotationsCount*3U);
+            if(l_rotationsSize > 0U) std::memcpy(m_rotations.data(), l_data, l_rotationsSize);
+            l_data += l_rotationsSize;
+            m_positions.resize(l_header.m_positionsCount*3U);
+            if(l_positionsSize > 0U) std::memcpy(m_positions.data(), l_data, l_positionsSize);
+            l_data += l_positionsSize;
+            m_scales.resize(l_header.m_scalesCount*3U);
+            if(l_scalesSize > 0U) std::memcpy(m_scales.data(), l_data, l_scalesSize);
+
+            // Tracks are checked once, sampling doesn't validate offsets
+            l_result = true;
+            for(const auto &iter : m_tracks)
+            {
+                size_t l_keyCount = iter.m_keyCount;
+                l_result = (static_cast<size_t>(iter.m_keyOffset) + l_keyCount <= l_header.m_keysCount);
+                if(l_result && !(iter.m_flags & AFTF_ConstantRotation)) l_result = (static_cast<size_t>(iter.m_rotationOffset) + l_keyCount <= l_header.m_rotationsCount);
+                if(l_result && !(iter.m_flags & AFTF_ConstantPosition)) l_result = (static_cast<size_t>(iter.m_positionOffset) + l_keyCount <= l_header.m_positionsCount);
+                if(l_result && !(iter.m_flags & AFTF_ConstantScale)) l_result = (static_cast<size_t>(iter.m_scaleOffset) + l_keyCount <= l_header.m_scalesCount);
+                if(!l_result) break;
+            }
+        }
+    }
+    return l_result;
+}
+
+void ROC::Animation::PackRotation(const glm::quat &f_rot, unsigned short *f_data)
+{
+    // Largest component is dropped and restored from unit length, it's made positive as q and -q are same rotation
+    glm::vec4 l_rotation = glm::normalize(glm::vec4(f_rot.x, f_rot.y, f_rot.z, f_rot.w));
+    int l_largest = 0;
+    for(int i = 1; i < 4; i++)
+    {
+        if(std::abs(l_rotation[i]) > std::abs(l_rotation[l_largest])) l_largest = i;
+    }
+    if(l_rotation[l_largest] < 0.f) l_rotation = -l_rotation;
+
+    for(int i = 0, j = 0; i < 4; i++)
+    {
+        if(i != l_largest)
+        {
+            float l_value = glm::clamp(l_rotation[i] / ROC_ANIMATION_ROTATION_RANGE, -1.f, 1.f);
+            f_data[j++] = static_cast<unsigned short>(std::round((l_value*0.5f + 0.5f)*ROC_ANIMATION_ROTATION_STEPS));
+        }
+    }
+    f_data[0] |= static_cast<unsigned short>((l_largest & 1) << 15);
+    f_data[1] |= static_cast<unsigned short>((l_largest >> 1) << 15);
+}
+void ROC::Animation::UnpackRotation(const unsigned short *f_data, glm::quat &f_rot)
+{
+    int l_largest = static_cast<int>((f_data[0] >> 15) | ((f_data[1] >> 15) << 1));
+    glm::vec3 l_values;
+    for(int i = 0; i < 3; i++) l_values[i] = (static_cast<float>(f_data[i] & 0x7FFFU)*(2.f / ROC_ANIMATION_ROTATION_STEPS) - 1.f)*ROC_ANIMATION_ROTATION_RANGE;
+
+    glm::vec4 l_rotation;
+    for(int i = 0, j = 0; i < 4; i++) l_rotation[i] = ((i == l_largest) ? std::sqrt(std::max(0.f, 1.f - glm::dot(l_values, l_values))) : l_values[j++]);
+    f_rot = glm::quat(l_rotation.w, l_rotation.x, l_rotation.y, l_rotation.z);
+}
+void ROC::Animation::PackRange(const glm::vec3 &f_value, const glm::vec3 &f_min, const glm::vec3 &f_extent, unsigned short *f_data)
+{
+    for(int i = 0; i < 3; i++)
+    {
+        float l_value = ((f_extent[i] > 0.f) ? glm::clamp((f_value[i] - f_min[i]) / f_extent[i], 0.f, 1.f) : 0.f);
+        f_data[i] = static_cast<unsigned short>(std::round(l_value*ROC_ANIMATION_RANGE_STEPS));
+    }
+}
+
+void ROC::Animation::GenerateStaticKeys()
+{
+    // Intervals with equal keys are found once, sampling skips their blending
+    m_staticKeys.assign(m_keyFrames.size(), 0U);
+    for(const auto &iter : m_tracks)
+    {
+        for(unsigned int i = 0U; i + 1U < iter.m_keyCount; i++)
+        {
+            bool l_static = true;
+            if(!(iter.m_flags & AFTF_ConstantRotation)) l_static = (std::memcmp(&m_rotations[(iter.m_rotationOffset + i)*3U], &m_rotations[(iter.m_rotationOffset + i + 1U)*3U], 3U*sizeof(unsigned short)) == 0);
+            if(l_static && !(iter.m_flags & AFTF_ConstantPosition)) l_static = (std::memcmp(&m_positions[(iter.m_positionOffset + i)*3U], &m_positions[(iter.m_positionOffset + i + 1U)*3U], 3U*sizeof(unsigned short)) == 0);
+            if(l_static && !(iter.m_flags & AFTF_ConstantScale)) l_static = (std::memcmp(&m_scales[(iter.m_scaleOffset + i)*3U], &m_scales[(iter.m_scaleOffset + i + 1U)*3U], 3U*sizeof(unsigned short)) == 0);
+            m_staticKeys[iter.m_keyOffset + i] = (l_static ? 1U : 0U);
+        }
+    }
+}
+
+size_t ROC::Animation::FindKey(unsigned int f_bone, unsigned int f_frame, size_t f_cursor) const
+{
+    size_t l_result = std::numeric_limits<size_t>::max();
+    const AnimationFileTrack &l_track = m_tracks[f_bone];
+    if(l_track.m_keyCount > 1U)
+    {
+        size_t l_firstKey = l_track.m_keyOffset;
+        size_t l_lastKey = l_firstKey + l_track.m_keyCount - 1U;
+        if((f_cursor >= l_firstKey) && (f_cursor < l_lastKey) && (m_keyFrames[f_cursor] <= f_frame))
+        {
+            // Playback goes forward, frame is in same or one of next intervals
+            for(unsigned int i = 0U; (i < ROC_ANIMATION_CURSOR_STEPS) && (l_result == std::numeric_limits<size_t>::max()) && (f_cursor < l_lastKey); i++)
+            {
+                // Frame of next key starts next interval, only last interval includes its end
+                if((f_frame < m_keyFrames[f_cursor + 1U]) || ((f_cursor + 1U == l_lastKey) && (f_frame == m_keyFrames[l_lastKey]))) l_result = f_cursor;
+                else f_cursor++;
+            }
+        }
+        if(l_result == std::numeric_limits<size_t>::max())
+        {
+            // Random seek, interval starts at last key not after the frame
+            auto l_begin = m_keyFrames.begin() + l_firstKey;
+            auto l_next = std::upper_bound(l_begin, m_keyFrames.begin() + l_lastKey + 1U, f_frame);
+            if(l_next != l_begin)
+            {
+                size_t l_key = static_cast<size_t>(l_next - m_keyFrames.begin()) - 1U;
+                if(l_key < l_lastKey) l_result = l_key;
+                else if(m_keyFrames[l_lastKey] == f_frame) l_result = l_lastKey - 1U;
+            }
+        }
+    }
+    return l_result;
+}
+void ROC::Animation::DecodeKey(const AnimationFileTrack &f_track, size_t f_key, glm::vec3 &f_pos, glm::quat &f_rot, glm::vec3 &f_scl) const
+{
+    size_t l_index = f_key - f_track.m_keyOffset;
+    if(f_track.m_flags & AFTF_ConstantRotation) f_rot = glm::quat(f_track.m_rotation.w, f_track.m_rotation.x, f_track.m_rotation.y, f_track.m_rotation.z);
+    else UnpackRotation(&m_rotations[(f_track.m_rotationOffset + l_index)*3U], f_rot);
+
+    if(f_track.m_flags & AFTF_ConstantPosition) f_pos = f_track.m_positionMin;
+    else
+    {
+        const unsigned short *l_data = &m_positions[(f_track.m_positionOffset + l_index)*3U];
+        f_pos = f_track.m_positionMin + glm::vec3(l_data[0], l_data[1], l_data[2])*(f_track.m_positionExtent*(1.f / ROC_ANIMATION_RANGE_STEPS));
+    }
+
+    if(f_track.m_flags & AFTF_ConstantScale) f_scl = f_track.m_scaleMin;
+    else
+    {
+        const unsigned short *l_data = &m_scales[(f_track.m_scaleOffset + l_index)*3U];
+        f_scl = f_track.m_scaleMin + glm::vec3(l_data[0], l_data[1], l_data[2])*(f_track.m_scaleExtent*(1.f / ROC_ANIMATION_RANGE_STEPS));
+    }
+}
+
+void ROC::Animation::GetData(unsigned int f_tick, std::vector<AnimationCursor> &f_cursors, const std::vector<float> &f_mask, AnimationPose &f_pose)
 {
     unsigned int l_frame = ((f_tick - f_tick%m_frameDelta) / m_frameDelta) % m_framesCount;
     f_tick = f_tick%m_duration;
 
+    if(f_cursors.size() != m_bonesCount)
+    {
+        f_cursors.resize(m_bonesCount);
+        for(unsigned int i = 0; i < m_bonesCount; i++)
+        {
+            f_cursors[i].m_key = m_tracks[i].m_keyOffset;
+            f_cursors[i].m_decoded = false;
+        }
+    }
+    if(f_pose.m_sampled.size() != m_bonesCount)
+    {
+        f_pose.m_positions.resize(m_bonesCount);
+        f_pose.m_rotations.resize(m_bonesCount);
+        f_pose.m_scales.resize(m_bonesCount);
+        f_pose.m_sampled.resize(m_bonesCount);
+    }
+
     for(unsigned int i = 0; i < m_bonesCount; i++)
     {
-        m_boneIntervals[i]->findOverlapping(l_frame, l_frame, m_searchResult);
-        if(!m_searchResult.empty())
+        f_pose.m_sampled[i] = 0U;
+        if(!f_mask.empty() && (f_mask[i] <= 0.f)) continue;
+
+        AnimationCursor &l_cursor = f_cursors[i];
+        size_t l_key = FindKey(i, l_frame, l_cursor.m_key);
+        if(l_key != std::numeric_limits<size_t>::max())
         {
-            keyframeData &l_keyframeData = m_searchResult.back().value;
-            if(l_keyframeData.m_static) f_bones[i]->SetFrameData(l_keyframeData.m_leftData);
-            else
+            bool l_static = (m_staticKeys[l_key] != 0U);
+            if(!l_cursor.m_decoded || (l_cursor.m_key != l_key))
             {
-                float l_blend = MathUtils::EaseInOut(static_cast<float>(f_tick - l_keyframeData.m_startTime) / static_cast<float>(l_keyframeData.m_duration));
-                m_tempFrameData->SetInterpolated(l_keyframeData.m_leftData, l_keyframeData.m_rightData, l_blend);
-                f_bones[i]->SetFrameData(m_tempFrameData);
+                const AnimationFileTrack &l_track = m_tracks[i];
+                DecodeKey(l_track, l_key, l_cursor.m_positions[0], l_cursor.m_rotations[0], l_cursor.m_scales[0]);
+                if(!l_static) DecodeKey(l_track, l_key + 1U, l_cursor.m_positions[1], l_cursor.m_rotations[1], l_cursor.m_scales[1]);
+                l_cursor.m_key = l_key;
+                l_cursor.m_decoded = true;
             }
 
-            m_searchResult.clear();
+            if(l_static)
+            {
+                f_pose.m_positions[i] = l_cursor.m_positions[0];
+                f_pose.m_rotations[i] = l_cursor.m_rotations[0];
+                f_pose.m_scales[i] = l_cursor.m_scales[0];
+            }
+            else
+            {
+                unsigned int l_startTime = m_keyFrames[l_key]*m_frameDelta;
+                unsigned int l_duration = m_keyFrames[l_key + 1U]*m_frameDelta - l_startTime;
+                float l_blend = MathUtils::EaseInOut(static_cast<float>(f_tick - l_startTime) / static_cast<float>(l_duration));
+                f_pose.m_positions[i] = glm::lerp(l_cursor.m_positions[0], l_cursor.m_positions[1], l_blend);
+                f_pose.m_rotations[i] = glm::slerp(l_cursor.m_rotations[0], l_cursor.m_rotations[1], l_blend);
+                f_pose.m_scales[i] = glm::lerp(l_cursor.m_scales[0], l_cursor.m_scales[1], l_blend);
+            }
+            f_pose.m_sampled[i] = 1U;
         }
     }
 }
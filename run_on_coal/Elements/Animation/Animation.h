@@ -1,11 +1,29 @@
 #pragma once
 #include "Elements/Element.h"
+#include "Elements/Animation/AnimationFormat.hpp"
 
 namespace ROC
 {
 
-class Bone;
-class BoneFrameData;
+// Local transforms of sampled bones, bones without keys or out of mask aren't sampled
+struct AnimationPose
+{
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::quat> m_rotations;
+    std::vector<glm::vec3> m_scales;
+    std::vector<unsigned char> m_sampled;
+};
+
+// Sampling position of bone, keys of current interval are decoded once while playback stays in it
+struct AnimationCursor
+{
+    size_t m_key = 0U;
+    bool m_decoded = false;
+    glm::vec3 m_positions[2];
+    glm::quat m_rotations[2];
+    glm::vec3 m_scales[2];
+};
+
 class Animation final : public Element
 {
     unsigned int m_bonesCount;
@@ -14,30 +32,44 @@ class Animation final : public Element
     unsigned int m_fps;
     unsigned int m_frameDelta;
 
-    struct keyframeData
-    {
-        BoneFrameData *m_leftData = nullptr;
-        BoneFrameData *m_rightData = nullptr;
-        unsigned int m_startTime = 0U;
-        unsigned int m_duration = 0U; // Duration between left and right keyframes in milliseconds
-        bool m_static = false;
-    };
-    std::vector<IntervalTree<keyframeData>*> m_boneIntervals;
-    BoneFrameData *m_tempFrameData;
-    std::vector<Interval<keyframeData>> m_searchResult;
+    // Quantized keys of all bones are kept as in file, tracks give key ranges of bones
+    std::vector<AnimationFileTrack> m_tracks;
+    std::vector<unsigned short> m_keyFrames;
+    std::vector<unsigned short> m_rotations; // 3 values per key
+    std::vector<unsigned short> m_positions; // 3 values per key
+    std::vector<unsigned short> m_scales; // 3 values per key
+    std::vector<unsigned char> m_staticKeys; // Key equals next one, interval isn't interpolated
 
     bool m_loaded;
+    bool m_async;
+    bool m_released;
 
     void Clean();
+    bool LoadVersion1(const std::vector<unsigned char> &f_data);
+    bool LoadVersion2(const std::vector<unsigned char> &f_data);
+    void GenerateStaticKeys();
+
+    size_t FindKey(unsigned int f_bone, unsigned int f_frame, size_t f_cursor) const;
+    void DecodeKey(const AnimationFileTrack &f_track, size_t f_key, glm::vec3 &f_pos, glm::quat &f_rot, glm::vec3 &f_scl) const;
+
+    static void PackRotation(const glm::quat &f_rot, unsigned short *f_data);
+    static void UnpackRotation(const unsigned short *f_data, glm::quat &f_rot);
+    static void PackRange(const glm::vec3 &f_value, const glm::vec3 &f_min, const glm::vec3 &f_extent, unsigned short *f_data);
 public:
-    inline unsigned int GetBonesCount() const { return m_bonesCount; }
-    inline unsigned int GetDuration() const { return m_duration; }
-    void GetData(unsigned int f_tick, std::vector<Bone*> &f_bones);
+    inline bool IsLoaded() const { return (m_released && m_loaded); }
+    inline unsigned int GetBonesCount() const { return (IsLoaded() ? m_bonesCount : 0U); }
+    inline unsigned int GetDuration() const { return (IsLoaded() ? m_duration : 0U); }
+    void GetData(unsigned int f_tick, std::vector<AnimationCursor> &f_cursors, const std::vector<float> &f_mask, AnimationPose &f_pose);
 protected:
-    Animation();
+    explicit Animation(bool f_async);
     ~Animation();
     bool Load(const std::string &f_path);
 
+    inline bool IsAsyncLoad() const { return m_async; }
+    inline bool IsReleased() const { return m_released; }
+    inline void SetReleased() { m_released = true; }
+
+    friend class AsyncManager;
     friend class ElementManager;
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+// Version 2 animation layout: header, track table, then frame, rotation, position and scale streams of 16-bit values
+#define ROC_ANIMATION_VERSION2_MARKER 0xA2U
+#define ROC_ANIMATION_VERSION2 2U
+
+// Rotations are smallest three quaternions, 15 bits per component and 2 bits of dropped component index in 48 bits
+#define ROC_ANIMATION_ROTATION_RANGE 0.70710678f
+#define ROC_ANIMATION_ROTATION_STEPS 32767.f
+// Positions and scales are quantized in range of their track
+#define ROC_ANIMATION_RANGE_STEPS 65535.f
+
+namespace ROC
+{
+
+struct AnimationFileHeader
+{
+    char m_signature[3]; // "ROC"
+    unsigned char m_marker; // ROC_ANIMATION_VERSION2_MARKER, version 1 has FPS here
+    unsigned int m_version;
+    unsigned int m_fps;
+    unsigned int m_framesCount;
+    unsigned int m_bonesCount;
+    unsigned int m_keysCount;
+    unsigned int m_rotationsCount;
+    unsigned int m_positionsCount;
+    unsigned int m_scalesCount;
+    unsigned int m_reserved[3];
+};
+
+// Offsets are in keys, constant channels have no keys in streams and keep value in track
+struct AnimationFileTrack
+{
+    unsigned int m_keyOffset;
+    unsigned int m_keyCount;
+    unsigned int m_rotationOffset;
+    unsigned int m_positionOffset;
+    unsigned int m_scaleOffset;
+    unsigned int m_flags;
+    glm::vec4 m_rotation; // x, y, z, w
+    glm::vec3 m_positionMin;
+    glm::vec3 m_positionExtent;
+    glm::vec3 m_scaleMin;
+    glm::vec3 m_scaleExtent;
+};
+
+enum AnimationFileTrackFlag : unsigned int
+{
+    AFTF_ConstantRotation = (1U << 0),
+    AFTF_ConstantPosition = (1U << 1),
+    AFTF_ConstantScale = (1U << 2)
+};
+
+static_assert(sizeof(AnimationFileHeader) == 48U, "AnimationFileHeader layout");
+static_assert(sizeof(AnimationFileTrack) == 88U, "AnimationFileTrack layout");
+
+}
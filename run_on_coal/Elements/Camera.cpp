@@ -2,6 +2,8 @@
 
 #include "Elements/Camera.h"
 
+unsigned int ROC::Camera::ms_frustumCounter = 0U;
+
 ROC::Camera::Camera(int f_type)
 {
     m_elementType = ET_Camera;
@@ -24,6 +26,9 @@ ROC::Camera::Camera(int f_type)
 
     m_rebuildView = false;
     m_rebuildProjection = false;
+
+    for(auto &iter : m_planes) iter = glm::vec4(0.f);
+    m_frustumVersion = 0U;
 }
 ROC::Camera::~Camera()
 {
@@ -127,6 +132,7 @@ void ROC::Camera::Update()
         m_planes[4] = glm::row(m_viewProjectionMatrix, 3) + glm::row(m_viewProjectionMatrix, 2);
         m_planes[5] = glm::row(m_viewProjectionMatrix, 3) - glm::row(m_viewProjectionMatrix, 2);
         for(auto &iter : m_planes) iter /= sqrtf(iter.x*iter.x + iter.y*iter.y + iter.z*iter.z);
+        m_frustumVersion = ++ms_frustumCounter;
 
         m_rebuildView = false;
         m_rebuildProjection = false;
@@ -149,12 +155,10 @@ bool ROC::Camera::IsInFrustum(const glm::vec3 &f_pos, float f_radius)
 bool ROC::Camera::IsInFrustum(const glm::mat4 &f_mat, float f_radius)
 {
     bool l_result = true;
-    btTransform l_transform = btTransform::getIdentity();
-    l_transform.setFromOpenGLMatrix(glm::value_ptr(f_mat));
-    const btVector3 &l_position = l_transform.getOrigin();
+    const glm::vec4 &l_position = f_mat[3];
     for(auto &iter : m_planes)
     {
-        if(iter.x*l_position.x() + iter.y*l_position.y() + iter.z*l_position.z() + iter.w < -f_radius)
+        if(iter.x*l_position.x + iter.y*l_position.y + iter.z*l_position.z + iter.w < -f_radius)
         {
             l_result = false;
             break;
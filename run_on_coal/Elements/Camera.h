@@ -23,6 +23,8 @@ class Camera final : public Element
     glm::vec2 m_depth;
 
     glm::vec4 m_planes[6];
+    unsigned int m_frustumVersion;
+    static unsigned int ms_frustumCounter;
 public:
     enum CameraProjectionType
     {
@@ -66,7 +68,13 @@ protected:
 
     void Update();
 
+    // Version changes with every planes rebuild and is unique among cameras
+    inline const glm::vec4* GetPlanes() const { return m_planes; }
+    inline unsigned int GetFrustumVersion() const { return m_frustumVersion; }
+
     friend class ElementManager;
+    friend class FrustumCuller;
+    friend class PreRenderManager;
     friend class RenderManager;
 };
 
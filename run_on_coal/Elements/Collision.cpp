@@ -2,10 +2,12 @@
 
 #include "Elements/Collision.h"
 #include "Elements/Model/Model.h"
+#include "Utils/CollisionShapeCache.h"
 
 namespace ROC
 {
 
+extern const glm::quat g_DefaultRotation;
 extern const glm::vec3 g_DefaultScale;
 
 }
@@ -16,7 +18,11 @@ ROC::Collision::Collision()
     m_elementTypeName.assign("Collision");
 
     m_rigidBody = nullptr;
+    m_previousPosition = glm::vec3(0.f);
+    m_previousRotation = g_DefaultRotation;
     m_motionType = CMT_Default;
+    m_type = CT_None;
+    m_size = glm::vec3(0.f);
     m_scale = g_DefaultScale;
     m_parentModel = nullptr;
 }
@@ -24,6 +30,7 @@ ROC::Collision::~Collision()
 {
     if(m_rigidBody)
     {
+        CollisionShapeCache::ReleaseShape(m_rigidBody->getCollisionShape());
         delete m_rigidBody->getMotionState();
         delete m_rigidBody;
     }
@@ -34,26 +41,11 @@ bool ROC::Collision::Create(int f_type, const glm::vec3 &f_size, float f_mass)
     if(!m_rigidBody)
     {
         btClamp(f_type, static_cast<int>(CT_Sphere), static_cast<int>(CT_Cone));
+        m_type = f_type;
+        std::memcpy(&m_size, &f_size, sizeof(glm::vec3));
+
         btVector3 l_inertia;
-        btCollisionShape *l_shape = nullptr;
-        switch(f_type)
-        {
-            case CT_Sphere:
-                l_shape = new btSphereShape(f_size.x);
-                break;
-            case CT_Box:
-                l_shape = new btBoxShape(btVector3(f_size.x, f_size.y, f_size.z));
-                break;
-            case CT_Cylinder:
-                l_shape = new btCylinderShape(btVector3(f_size.x, f_size.y, f_size.z));
-                break;
-            case CT_Capsule:
-                l_shape = new btCapsuleShape(f_size.x, f_size.y);
-                break;
-            case CT_Cone:
-                l_shape = new btConeShape(f_size.x, f_size.y);
-                break;
-        }
+        btCollisionShape *l_shape = CollisionShapeCache::AcquireShape(m_type, m_size, m_scale);
         if(l_shape)
         {
             l_shape->calculateLocalInertia(f_mass, l_inertia);
@@ -111,8 +103,10 @@ void ROC::Collision::SetPosition(const glm::vec3 &f_pos)
     switch(m_motionType)
     {
         case CMT_Default: case CMT_Static:
+        {
             m_rigidBody->setCenterOfMassTransform(l_transform);
-            break;
+            SaveTransform();
+        } break;
         case CMT_Kinematic:
             m_rigidBody->getMotionState()->setWorldTransform(l_transform);
             break;
@@ -151,8 +145,10 @@ void ROC::Collision::SetRotation(const glm::quat &f_rot)
     switch(m_motionType)
     {
         case CMT_Default: case CMT_Static:
+        {
             m_rigidBody->setCenterOfMassTransform(l_transform);
-            break;
+            SaveTransform();
+        } break;
         case CMT_Kinematic:
             m_rigidBody->getMotionState()->setWorldTransform(l_transform);
             break;
@@ -162,14 +158,25 @@ void ROC::Collision::SetRotation(const glm::quat &f_rot)
 
 void ROC::Collision::SetScale(const glm::vec3 &f_val)
 {
+    // Shared shape isn't scaled, body takes shape of new scale
     std::memcpy(&m_scale, &f_val, sizeof(glm::vec3));
-    m_rigidBody->getCollisionShape()->setLocalScaling(btVector3(m_scale.x, m_scale.y, m_scale.z));
+    btCollisionShape *l_shape = m_rigidBody->getCollisionShape();
+    m_rigidBody->setCollisionShape(CollisionShapeCache::AcquireShape(m_type, m_size, m_scale));
+    CollisionShapeCache::ReleaseShape(l_shape);
 }
 void ROC::Collision::GetScale(glm::vec3 &f_val)
 {
     std::memcpy(&f_val, &m_scale, sizeof(glm::vec3));
 }
 
+void ROC::Collision::SaveTransform()
+{
+    const btTransform &l_transform = m_rigidBody->getCenterOfMassTransform();
+    std::memcpy(&m_previousPosition, l_transform.getOrigin().m_floats, sizeof(glm::vec3));
+    btQuaternion l_rotation = l_transform.getRotation();
+    for(int i = 0; i < 4; i++) m_previousRotation[i] = l_rotation[i];
+}
+
 void ROC::Collision::SetVelocity(const glm::vec3 &f_val)
 {
     m_rigidBody->setLinearVelocity(btVector3(f_val.x, f_val.y, f_val.z));
@@ -272,14 +279,25 @@ void ROC::Collision::SetMotionType(int f_type)
             m_rigidBody->setActivationState(DISABLE_DEACTIVATION);
         } break;
     }
+    SaveTransform();
 }
 
-void ROC::Collision::GetTransform(glm::mat4 &f_mat, glm::vec3 &f_pos, glm::quat &f_rot)
+void ROC::Collision::GetTransform(glm::mat4 &f_mat, glm::vec3 &f_pos, glm::quat &f_rot, float f_interpolation)
 {
     btTransform l_transform;
     switch(m_motionType)
     {
-        case CMT_Default: case CMT_Static:
+        case CMT_Default:
+        {
+            l_transform = m_rigidBody->getCenterOfMassTransform();
+            if(f_interpolation < 1.f)
+            {
+                btQuaternion l_previousRotation(m_previousRotation.x, m_previousRotation.y, m_previousRotation.z, m_previousRotation.w);
+                l_transform.setOrigin(btVector3(m_previousPosition.x, m_previousPosition.y, m_previousPosition.z).lerp(l_transform.getOrigin(), f_interpolation));
+                l_transform.setRotation(l_previousRotation.slerp(l_transform.getRotation(), f_interpolation));
+            }
+        } break;
+        case CMT_Static:
             l_transform = m_rigidBody->getCenterOfMassTransform();
             break;
         case CMT_Kinematic:
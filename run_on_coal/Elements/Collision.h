@@ -8,7 +8,11 @@ class Model;
 class Collision final : public Element
 {
     btRigidBody *m_rigidBody;
+    glm::vec3 m_previousPosition; // Before last physics step, render transform is interpolated from it
+    glm::quat m_previousRotation;
     int m_motionType;
+    int m_type;
+    glm::vec3 m_size;
     glm::vec3 m_scale;
     Model *m_parentModel;
 public:
@@ -64,7 +68,7 @@ public:
     void SetMotionType(int f_type);
     inline int GetMotionType() const { return m_motionType; }
 
-    void GetTransform(glm::mat4 &f_mat, glm::vec3 &f_pos, glm::quat &f_rot);
+    void GetTransform(glm::mat4 &f_mat, glm::vec3 &f_pos, glm::quat &f_rot, float f_interpolation = 1.f);
 protected:
     Collision();
     ~Collision();
@@ -78,6 +82,8 @@ protected:
 
     void SetScale(const glm::vec3 &f_val);
 
+    void SaveTransform();
+
     friend class ElementManager;
     friend class InheritanceManager;
     friend class PhysicsManager;
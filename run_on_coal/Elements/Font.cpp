@@ -16,6 +16,7 @@ const GLint g_FontSwizzleMask[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
 #define ROC_FONT_TEXT_BLOCK 512U
 
 FT_Library ROC::Font::ms_library = FT_Library();
+std::mutex ROC::Font::ms_libraryMutex;
 
 std::vector<glm::vec3> ROC::Font::ms_vertices;
 GLuint ROC::Font::ms_vertexVBO = 0U;
@@ -24,12 +25,14 @@ GLuint ROC::Font::ms_uvVBO = 0U;
 GLuint ROC::Font::ms_VAO = 0U;
 bool ROC::Font::ms_switch = false;
 
-ROC::Font::Font()
+ROC::Font::Font(bool f_async)
 {
     m_elementType = ET_Font;
     m_elementTypeName.assign("Font");
 
     m_loaded = false;
+    m_async = f_async;
+    m_released = !m_async;
     m_face = FT_Face();
     m_size = 0.f;
 
@@ -45,10 +48,11 @@ ROC::Font::Font()
 }
 ROC::Font::~Font()
 {
-    if(m_loaded)
+    if(m_atlasTexture != 0U) glDeleteTextures(1, &m_atlasTexture);
+    delete m_atlasPack;
+    if(m_face)
     {
-        glDeleteTextures(1, &m_atlasTexture);
-        delete m_atlasPack;
+        std::lock_guard<std::mutex> l_lock(ms_libraryMutex);
         FT_Done_Face(m_face);
     }
 }
@@ -96,9 +100,18 @@ void ROC::Font::DestroyVAO()
 
 bool ROC::Font::Load(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter)
 {
-    if(!m_loaded)
+    return (LoadFace(f_path, f_size, f_atlas, f_filter) && GenerateAtlas());
+}
+bool ROC::Font::LoadFace(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter)
+{
+    bool l_result = false;
+    if(!m_loaded && !m_face)
     {
-        if(!FT_New_Face(ms_library, f_path.c_str(), 0, &m_face))
+        // Face creation touches shared library, faces themselves are independent
+        ms_libraryMutex.lock();
+        FT_Error l_error = FT_New_Face(ms_library, f_path.c_str(), 0, &m_face);
+        ms_libraryMutex.unlock();
+        if(!l_error)
         {
             FT_Select_Charmap(m_face, ft_encoding_unicode);
             FT_Set_Pixel_Sizes(m_face, 0, f_size);
@@ -126,23 +139,31 @@ bool ROC::Font::Load(const std::string &f_path, int f_size, const glm::ivec2 &f_
                 m_atlasSize.y = ROC_FONT_ATLAS_SIZE;
                 m_atlasOffset.y = g_FontDefaultAtlasOffset;
             }
-
-            // Generate atlas texture
-            glGenTextures(1, &m_atlasTexture);
-            glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST + m_filteringType);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST + m_filteringType);
-            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, g_FontSwizzleMask);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, m_atlasSize.x, m_atlasSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
-
-            // Generate atlas
-            m_atlasPack = new rbp::MaxRectsBinPack();
-            m_atlasPack->Init(m_atlasSize.x, m_atlasSize.y, false);
-
-            m_loaded = true;
+            l_result = true;
         }
+        else m_face = FT_Face();
+    }
+    return l_result;
+}
+bool ROC::Font::GenerateAtlas()
+{
+    if(!m_loaded && m_face)
+    {
+        // Generate atlas texture
+        glGenTextures(1, &m_atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST + m_filteringType);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST + m_filteringType);
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, g_FontSwizzleMask);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, m_atlasSize.x, m_atlasSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+
+        // Generate atlas
+        m_atlasPack = new rbp::MaxRectsBinPack();
+        m_atlasPack->Init(m_atlasSize.x, m_atlasSize.y, false);
+
+        m_loaded = true;
     }
     return m_loaded;
 }
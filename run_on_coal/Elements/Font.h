@@ -9,6 +9,7 @@ namespace ROC
 class Font final : public Element
 {
     static FT_Library ms_library;
+    static std::mutex ms_libraryMutex;
     FT_Face m_face;
     float m_size;
 
@@ -38,6 +39,8 @@ class Font final : public Element
     int m_filteringType;
 
     bool m_loaded;
+    bool m_async;
+    bool m_released;
 
     bool LoadChar(unsigned int f_char);
 public:
@@ -50,7 +53,7 @@ public:
 
     inline int GetFiltering() const { return m_filteringType; }
 protected:
-    Font();
+    explicit Font(bool f_async);
     ~Font();
 
     static void CreateVAO();
@@ -58,12 +61,19 @@ protected:
     static void CreateLibrary();
     static void DestroyLibrary();
     bool Load(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter = FFT_Nearest);
+    bool LoadFace(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter = FFT_Nearest);
+    bool GenerateAtlas();
+
+    inline bool IsAsyncLoad() const { return m_async; }
+    inline bool IsReleased() const { return m_released; }
+    inline void SetReleased() { m_released = true; }
 
     static inline GLuint GetVAO() { return ms_VAO; }
     inline GLuint GetAtlasTexture() const { return m_atlasTexture; }
 
     void Draw(const sf::String &f_text, const glm::vec2 &f_pos, const glm::bvec2 &f_bind);
 
+    friend class AsyncManager;
     friend class ElementManager;
     friend class RenderManager;
 };
@@ -4,12 +4,53 @@
 #include "Elements/Geometry/BoneCollisionData.hpp"
 #include "Elements/Geometry/BoneData.hpp"
 #include "Elements/Geometry/BoneJointData.hpp"
+#include "Elements/Geometry/GeometryFormat.hpp"
 #include "Elements/Geometry/Material.h"
+#include "Elements/Geometry/VertexFormat.h"
 
+#include "Utils/MeshUtils.h"
 #include "Utils/zlibUtils.h"
 
-#define ROC_GEOMETRY_SETTER_ANIMATED 0x2U
-#define ROC_GEOMETRY_SETTER_COLLISION 0xCBU
+namespace ROC
+{
+
+// Face corner is unique combination of vertex, UV and normal indices
+struct GeometryCornerHash
+{
+    size_t operator()(const glm::ivec3 &f_corner) const
+    {
+        size_t l_hash = std::hash<int>()(f_corner.x);
+        l_hash ^= std::hash<int>()(f_corner.y) + 0x9E3779B9U + (l_hash << 6) + (l_hash >> 2);
+        l_hash ^= std::hash<int>()(f_corner.z) + 0x9E3779B9U + (l_hash << 6) + (l_hash >> 2);
+        return l_hash;
+    }
+};
+
+// Uncompressed sections point into file data, compressed ones are inflated to buffer
+unsigned char* GetGeometrySectionData(std::vector<unsigned char> &f_file, const GeometryFileSection &f_section, std::vector<unsigned char> &f_buffer)
+{
+    unsigned char *l_data = nullptr;
+    if((f_section.m_offset <= f_file.size()) && (f_section.m_size <= f_file.size() - f_section.m_offset))
+    {
+        unsigned char *l_source = f_file.data() + f_section.m_offset;
+        switch(f_section.m_compression)
+        {
+            case GFC_None:
+            {
+                if(f_section.m_rawSize == f_section.m_size) l_data = l_source;
+            } break;
+            case GFC_Zlib:
+            {
+                f_buffer.resize(static_cast<size_t>(f_section.m_rawSize) + 1U);
+                int l_size = zlibUtils::UncompressData(l_source, static_cast<int>(f_section.m_size), f_buffer.data(), static_cast<int>(f_section.m_rawSize));
+                if(l_size == static_cast<int>(f_section.m_rawSize)) l_data = f_buffer.data();
+            } break;
+        }
+    }
+    return l_data;
+}
+
+}
 
 ROC::Geometry::Geometry(bool f_async)
 {
@@ -20,13 +61,15 @@ ROC::Geometry::Geometry(bool f_async)
     m_async = f_async;
     m_released = !m_async;
     m_materialCount = 0U;
+    m_boundMin = glm::vec3(0.f);
+    m_boundMax = glm::vec3(0.f);
+    m_boundSphereCenter = glm::vec3(0.f);
     m_boundSphereRaduis = 0.f;
 }
 ROC::Geometry::~Geometry()
 {
     Clear();
 }
-
 bool ROC::Geometry::Load(const std::string &f_path)
 {
     bool l_result = false;
@@ -34,7 +77,6 @@ bool ROC::Geometry::Load(const std::string &f_path)
     {
         m_loadState = GLS_Loading;
 
-        unsigned char l_type;
         std::ifstream l_file;
         l_file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 
@@ -45,258 +87,438 @@ bool ROC::Geometry::Load(const std::string &f_path)
             l_file.read(&l_header[0], 3);
             if(!l_header.compare("ROC"))
             {
+                unsigned char l_type;
                 l_file.read(reinterpret_cast<char*>(&l_type), sizeof(unsigned char));
+                l_result = ((l_type == ROC_GEOMETRY_VERSION2_MARKER) ? LoadVersion2(l_file) : LoadVersion1(l_file, l_type));
+            }
+        }
+        catch(const std::exception&)
+        {
+            l_result = false;
+        }
+        if(l_result)
+        {
+            if(!m_async) m_loadState = GLS_Loaded;
+        }
+        else Clear();
+    }
+    return l_result;
+}
+
+bool ROC::Geometry::LoadVersion1(std::istream &f_file, unsigned char f_type)
+{
+    int l_compressedSize, l_uncompressedSize;
+    std::vector<unsigned char> l_tempData;
+
+    //Vertices
+    std::vector<glm::vec3> l_vertexData;
+    f_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+    f_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+    l_tempData.resize(l_compressedSize);
+    f_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
+    l_vertexData.resize(l_uncompressedSize / sizeof(glm::vec3));
+    zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_vertexData.data(), l_uncompressedSize);
+
+    //UVs
+    std::vector<glm::vec2> l_uvData;
+    f_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+    f_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+    l_tempData.resize(l_compressedSize);
+    f_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
+    l_uvData.resize(l_uncompressedSize / sizeof(glm::vec2));
+    zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_uvData.data(), l_uncompressedSize);
+
+    //Normals
+    std::vector<glm::vec3> l_normalData;
+    f_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+    f_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+    l_tempData.resize(l_compressedSize);
+    f_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
+    l_normalData.resize(l_uncompressedSize / sizeof(glm::vec3));
+    zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_normalData.data(), l_uncompressedSize);
+
+    std::vector<glm::vec4> l_weightData;
+    std::vector<glm::ivec4> l_indexData;
+    if(f_type == ROC_GEOMETRY_SETTER_ANIMATED)
+    {
+        // Weights
+        f_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+        f_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+        l_tempData.resize(l_compressedSize);
+        f_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
+        l_weightData.resize(l_uncompressedSize / sizeof(glm::vec4));
+        zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_weightData.data(), l_uncompressedSize);
+
+        //Indices
+        f_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+        f_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+        l_tempData.resize(l_compressedSize);
+        f_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
+        l_indexData.resize(l_uncompressedSize / sizeof(glm::vec4));
+        zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_indexData.data(), l_uncompressedSize);
+    }
+
+    //Materials
+    int l_materialCount;
+    f_file.read(reinterpret_cast<char*>(&l_materialCount), sizeof(int));
+    for(int i = 0; i < l_materialCount; i++)
+    {
+        unsigned char l_materialType;
+        glm::vec4 l_materialParam;
+        unsigned char l_difTextureLength;
+        std::string l_difTexture;
+
+        f_file.read(reinterpret_cast<char*>(&l_materialType), sizeof(unsigned char));
+        f_file.read(reinterpret_cast<char*>(&l_materialParam), sizeof(glm::vec4));
+        f_file.read(reinterpret_cast<char*>(&l_difTextureLength), sizeof(unsigned char));
+        if(l_difTextureLength)
+        {
+            l_difTexture.resize(l_difTextureLength);
+            f_file.read(&l_difTexture[0], l_difTextureLength);
+        }
 
-                int l_compressedSize, l_uncompressedSize;
-                std::vector<unsigned char> l_tempData;
-
-                //Vertices
-                std::vector<glm::vec3> l_vertexData;
-                l_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
-                l_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
-                l_tempData.resize(l_compressedSize);
-                l_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
-                l_vertexData.resize(l_uncompressedSize / sizeof(glm::vec3));
-                zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_vertexData.data(), l_uncompressedSize);
-
-                //UVs
-                std::vector<glm::vec2> l_uvData;
-                l_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
-                l_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
-                l_tempData.resize(l_compressedSize);
-                l_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
-                l_uvData.resize(l_uncompressedSize / sizeof(glm::vec2));
-                zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_uvData.data(), l_uncompressedSize);
-
-                //Normals
-                std::vector<glm::vec3> l_normalData;
-                l_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
-                l_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
-                l_tempData.resize(l_compressedSize);
-                l_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
-                l_normalData.resize(l_uncompressedSize / sizeof(glm::vec3));
-                zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_normalData.data(), l_uncompressedSize);
-
-                std::vector<glm::vec4> l_weightData;
-                std::vector<glm::ivec4> l_indexData;
-                if(l_type == ROC_GEOMETRY_SETTER_ANIMATED)
+        std::vector<int> l_faceIndex;
+        f_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
+        f_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
+        l_tempData.resize(l_compressedSize);
+        f_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
+        l_faceIndex.resize(l_uncompressedSize / sizeof(int));
+        zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_faceIndex.data(), l_uncompressedSize);
+
+        // Merge repeated face corners into indexed vertices
+        std::vector<glm::ivec3> l_corners;
+        std::vector<unsigned int> l_elements;
+        std::unordered_map<glm::ivec3, unsigned int, GeometryCornerHash> l_cornerMap;
+        l_elements.reserve(l_faceIndex.size() / 3U);
+        for(int j = 0, k = static_cast<int>(l_faceIndex.size()); j < k; j += 9)
+        {
+            for(int l = 0; l < 3; l++)
+            {
+                glm::ivec3 l_corner(l_faceIndex[j + l], l_faceIndex[j + 3 + l], l_faceIndex[j + 6 + l]);
+                auto l_cornerIter = l_cornerMap.find(l_corner);
+                if(l_cornerIter == l_cornerMap.end())
                 {
-                    // Weights
-                    l_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
-                    l_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
-                    l_tempData.resize(l_compressedSize);
-                    l_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
-                    l_weightData.resize(l_uncompressedSize / sizeof(glm::vec4));
-                    zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_weightData.data(), l_uncompressedSize);
-
-                    //Indices
-                    l_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
-                    l_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
-                    l_tempData.resize(l_compressedSize);
-                    l_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
-                    l_indexData.resize(l_uncompressedSize / sizeof(glm::vec4));
-                    zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_indexData.data(), l_uncompressedSize);
+                    unsigned int l_cornerIndex = static_cast<unsigned int>(l_corners.size());
+                    l_cornerMap.insert(std::make_pair(l_corner, l_cornerIndex));
+                    l_corners.push_back(l_corner);
+                    l_elements.push_back(l_cornerIndex);
                 }
+                else l_elements.push_back(l_cornerIter->second);
+            }
+        }
+        MeshUtils::OptimizeVertexCache(l_elements, static_cast<unsigned int>(l_corners.size()));
+
+        // Lay vertices out in order of first use after triangle reordering
+        std::vector<unsigned int> l_remap(l_corners.size(), std::numeric_limits<unsigned int>::max());
+        std::vector<glm::vec3> l_tempVertex;
+        std::vector<glm::vec2> l_tempUV;
+        std::vector<glm::vec3> l_tempNormal;
+        std::vector<glm::vec4> l_tempWeight;
+        std::vector<glm::ivec4> l_tempIndex;
+        for(auto &iter : l_elements)
+        {
+            if(l_remap[iter] == std::numeric_limits<unsigned int>::max())
+            {
+                const glm::ivec3 &l_corner = l_corners[iter];
+                l_remap[iter] = static_cast<unsigned int>(l_tempVertex.size());
+                l_tempVertex.push_back(l_vertexData[l_corner.x]);
+                l_tempUV.push_back(l_uvData[l_corner.y]);
+                l_tempNormal.push_back(l_normalData[l_corner.z]);
+                if(f_type == ROC_GEOMETRY_SETTER_ANIMATED)
+                {
+                    l_tempWeight.push_back(l_weightData[l_corner.x]);
+                    l_tempIndex.push_back(l_indexData[l_corner.x]);
+                }
+            }
+            iter = l_remap[iter];
+        }
+
+        Material *l_material = new Material(m_async);
+        m_materialVector.push_back(l_material);
+        l_material->SetType(l_materialType);
+        l_material->SetParams(l_materialParam);
+        VertexFormat l_vertexFormat;
+        std::vector<unsigned char> l_vertexBuffer;
+        VertexFormat::Pack(l_tempVertex, l_tempUV, l_tempNormal, l_tempWeight, l_tempIndex, l_vertexFormat, l_vertexBuffer);
+        l_material->LoadVertices(l_vertexFormat, l_vertexBuffer.data(), l_vertexBuffer.size());
+        l_material->LoadElements(l_elements);
+        if(!m_async) l_material->GenerateVAO();
+        l_material->SetTexturePath(l_difTexture);
+    }
+    SortMaterials();
+
+    // Sphere is centered on box, radius covers farthest vertex from that center
+    if(!l_vertexData.empty())
+    {
+        m_boundMin = m_boundMax = l_vertexData.front();
+        for(const auto &iter : l_vertexData)
+        {
+            m_boundMin = glm::min(m_boundMin, iter);
+            m_boundMax = glm::max(m_boundMax, iter);
+        }
+        m_boundSphereCenter = (m_boundMin + m_boundMax)*0.5f;
+        float l_radiusSq = 0.f;
+        for(const auto &iter : l_vertexData)
+        {
+            glm::vec3 l_offset = iter - m_boundSphereCenter;
+            l_radiusSq = std::max(l_radiusSq, glm::dot(l_offset, l_offset));
+        }
+        m_boundSphereRaduis = std::sqrt(l_radiusSq);
+    }
+
+    if(f_type == ROC_GEOMETRY_SETTER_ANIMATED)
+    {
+        LoadBonesData(f_file);
+
+        try
+        {
+            unsigned char l_physicBlock = 0U;
+            f_file.read(reinterpret_cast<char*>(&l_physicBlock), sizeof(unsigned char));
+            if(l_physicBlock == ROC_GEOMETRY_SETTER_COLLISION) LoadCollisionData(f_file);
+        }
+        catch(const std::exception&)
+        {
+            for(auto iter : m_collisionData) delete iter;
+            m_collisionData.clear();
+
+            for(auto iter : m_jointData) delete iter;
+            m_jointData.clear();
+        }
+    }
+    return true;
+}
 
-                //Materials
-                int l_materialCount;
-                glm::vec3 l_farthestPoint(0.f);
-                l_file.read(reinterpret_cast<char*>(&l_materialCount), sizeof(int));
-                for(int i = 0; i < l_materialCount; i++)
+bool ROC::Geometry::LoadVersion2(std::istream &f_file)
+{
+    bool l_result = false;
+
+    // Whole file is read at once, uncompressed blocks are handed to GL straight from it
+    f_file.seekg(0, std::ios::end);
+    size_t l_fileSize = static_cast<size_t>(f_file.tellg());
+    f_file.seekg(0, std::ios::beg);
+    if(l_fileSize >= sizeof(GeometryFileHeader))
+    {
+        std::vector<unsigned char> l_fileData(l_fileSize);
+        f_file.read(reinterpret_cast<char*>(l_fileData.data()), l_fileSize);
+
+        GeometryFileHeader l_header;
+        std::memcpy(&l_header, l_fileData.data(), sizeof(GeometryFileHeader));
+        size_t l_tableEnd = sizeof(GeometryFileHeader) + static_cast<size_t>(l_header.m_sectionCount)*sizeof(GeometryFileSection);
+        if((l_header.m_version == ROC_GEOMETRY_VERSION2) && (l_tableEnd <= l_fileSize))
+        {
+            l_result = true;
+
+            std::vector<unsigned char> l_sectionBuffer;
+            Material *l_material = nullptr;
+            GeometryFileMaterial l_fileMaterial;
+            VertexFormat l_vertexFormat;
+            std::string l_texture;
+            bool l_packedNormals = VertexFormat::IsPackedNormalSupported();
+            for(unsigned int i = 0U; l_result && (i < l_header.m_sectionCount); i++)
+            {
+                GeometryFileSection l_section;
+                std::memcpy(&l_section, l_fileData.data() + sizeof(GeometryFileHeader) + i*sizeof(GeometryFileSection), sizeof(GeometryFileSection));
+
+                unsigned char *l_data = GetGeometrySectionData(l_fileData, l_section, l_sectionBuffer);
+                size_t l_size = static_cast<size_t>(l_section.m_rawSize);
+                if(!l_data)
                 {
-                    unsigned char l_materialType;
-                    glm::vec4 l_materialParam;
-                    unsigned char l_difTextureLength;
-                    std::string l_difTexture;
-
-                    l_file.read(reinterpret_cast<char*>(&l_materialType), sizeof(unsigned char));
-                    l_file.read(reinterpret_cast<char*>(&l_materialParam), sizeof(glm::vec4));
-                    l_file.read(reinterpret_cast<char*>(&l_difTextureLength), sizeof(unsigned char));
-                    if(l_difTextureLength)
+                    l_result = false;
+                    break;
+                }
+
+                switch(l_section.m_type)
+                {
+                    case GFST_Material:
                     {
-                        l_difTexture.resize(l_difTextureLength);
-                        l_file.read(&l_difTexture[0], l_difTextureLength);
-                    }
-
-                    std::vector<int> l_faceIndex;
-                    l_file.read(reinterpret_cast<char*>(&l_compressedSize), sizeof(int));
-                    l_file.read(reinterpret_cast<char*>(&l_uncompressedSize), sizeof(int));
-                    l_tempData.resize(l_compressedSize);
-                    l_file.read(reinterpret_cast<char*>(l_tempData.data()), l_compressedSize);
-                    l_faceIndex.resize(l_uncompressedSize / sizeof(int));
-                    zlibUtils::UncompressData(l_tempData.data(), l_compressedSize, l_faceIndex.data(), l_uncompressedSize);
-
-                    std::vector<glm::vec3> l_tempVertex;
-                    std::vector<glm::vec2> l_tempUV;
-                    std::vector<glm::vec3> l_tempNormal;
-                    std::vector<glm::vec4> l_tempWeight;
-                    std::vector<glm::ivec4> l_tempIndex;
-                    for(int j = 0, k = static_cast<int>(l_faceIndex.size()); j < k; j += 9)
+                        l_result = false;
+                        l_material = nullptr;
+                        if(l_size >= sizeof(GeometryFileMaterial))
+                        {
+                            std::memcpy(&l_fileMaterial, l_data, sizeof(GeometryFileMaterial));
+                            size_t l_attributesSize = l_fileMaterial.m_attributeCount*sizeof(GeometryFileAttribute);
+                            if(l_size == sizeof(GeometryFileMaterial) + l_attributesSize + l_fileMaterial.m_textureLength)
+                            {
+                                l_vertexFormat.Clear();
+                                for(unsigned char j = 0U; j < l_fileMaterial.m_attributeCount; j++)
+                                {
+                                    GeometryFileAttribute l_fileAttribute;
+                                    std::memcpy(&l_fileAttribute, l_data + sizeof(GeometryFileMaterial) + j*sizeof(GeometryFileAttribute), sizeof(GeometryFileAttribute));
+                                    l_vertexFormat.AddAttribute(l_fileAttribute);
+                                }
+                                l_texture.assign(reinterpret_cast<char*>(l_data) + sizeof(GeometryFileMaterial) + l_attributesSize, l_fileMaterial.m_textureLength);
+
+                                if(l_vertexFormat.GetStride() == l_fileMaterial.m_stride)
+                                {
+                                    l_material = new Material(m_async);
+                                    m_materialVector.push_back(l_material);
+                                    l_material->SetType(l_fileMaterial.m_type);
+                                    l_material->SetParams(l_fileMaterial.m_params);
+                                    l_result = true;
+                                }
+                            }
+                        }
+                    } break;
+                    case GFST_Vertices:
                     {
-                        l_tempVertex.push_back(l_vertexData[l_faceIndex[j]]);
-                        l_farthestPoint = glm::max(l_farthestPoint, l_tempVertex.back());
-                        l_tempVertex.push_back(l_vertexData[l_faceIndex[j + 1]]);
-                        l_farthestPoint = glm::max(l_farthestPoint, l_tempVertex.back());
-                        l_tempVertex.push_back(l_vertexData[l_faceIndex[j + 2]]);
-                        l_farthestPoint = glm::max(l_farthestPoint, l_tempVertex.back());
-                        l_tempUV.push_back(l_uvData[l_faceIndex[j + 3]]);
-                        l_tempUV.push_back(l_uvData[l_faceIndex[j + 4]]);
-                        l_tempUV.push_back(l_uvData[l_faceIndex[j + 5]]);
-                        l_tempNormal.push_back(l_normalData[l_faceIndex[j + 6]]);
-                        l_tempNormal.push_back(l_normalData[l_faceIndex[j + 7]]);
-                        l_tempNormal.push_back(l_normalData[l_faceIndex[j + 8]]);
-                        if(l_type == ROC_GEOMETRY_SETTER_ANIMATED)
+                        if(l_material && (l_size == static_cast<size_t>(l_fileMaterial.m_vertexCount)*l_fileMaterial.m_stride))
                         {
-                            l_tempWeight.push_back(l_weightData[l_faceIndex[j]]);
-                            l_tempWeight.push_back(l_weightData[l_faceIndex[j + 1]]);
-                            l_tempWeight.push_back(l_weightData[l_faceIndex[j + 2]]);
-                            l_tempIndex.push_back(l_indexData[l_faceIndex[j]]);
-                            l_tempIndex.push_back(l_indexData[l_faceIndex[j + 1]]);
-                            l_tempIndex.push_back(l_indexData[l_faceIndex[j + 2]]);
+                            if(!l_packedNormals) l_vertexFormat.ConvertPackedNormals(l_data, l_fileMaterial.m_vertexCount);
+                            l_material->LoadVertices(l_vertexFormat, l_data, l_size);
                         }
-                    }
-
-                    Material *l_material = new Material();
-                    m_materialVector.push_back(l_material);
-                    l_material->SetType(l_materialType);
-                    l_material->SetParams(l_materialParam);
-                    l_material->LoadVertices(l_tempVertex);
-                    l_material->LoadUVs(l_tempUV);
-                    l_material->LoadNormals(l_tempNormal);
-                    if(l_type == ROC_GEOMETRY_SETTER_ANIMATED)
+                        else l_result = false;
+                    } break;
+                    case GFST_Elements:
                     {
-                        l_material->LoadWeights(l_tempWeight);
-                        l_material->LoadIndices(l_tempIndex);
-                    }
-                    if(!m_async) l_material->GenerateVAO();
-                    l_material->LoadTexture(l_difTexture);
-                }
-                m_materialCount = static_cast<unsigned int>(l_materialCount);
-                if(m_materialCount > 0U)
-                {
-                    std::vector<Material*> l_matVecDef, l_matVecDefDouble, l_matVecDefTransp;
-                    for(auto iter : m_materialVector)
+                        if(l_material && ((l_fileMaterial.m_elementSize == 2U) || (l_fileMaterial.m_elementSize == 4U)) && (l_size == static_cast<size_t>(l_fileMaterial.m_elementCount)*l_fileMaterial.m_elementSize))
+                        {
+                            l_material->LoadElements(l_data, l_fileMaterial.m_elementCount, (l_fileMaterial.m_elementSize == 2U) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+                            if(!m_async) l_material->GenerateVAO();
+                            l_material->SetTexturePath(l_texture);
+                        }
+                        else l_result = false;
+                    } break;
+                    case GFST_Bones:
                     {
-                        if(iter->IsTransparent() || !iter->HasDepth()) l_matVecDefTransp.push_back(iter);
-                        else iter->IsDoubleSided() ? l_matVecDefDouble.push_back(iter) : l_matVecDef.push_back(iter);
-                    }
-                    m_materialVector.clear();
-                    m_materialVector.insert(m_materialVector.end(), l_matVecDefDouble.begin(), l_matVecDefDouble.end());
-                    m_materialVector.insert(m_materialVector.end(), l_matVecDef.begin(), l_matVecDef.end());
-                    m_materialVector.insert(m_materialVector.end(), l_matVecDefTransp.begin(), l_matVecDefTransp.end());
-                    m_materialVector.shrink_to_fit();
-                }
-                m_boundSphereRaduis = glm::length(l_farthestPoint);
-
-                if(l_type == ROC_GEOMETRY_SETTER_ANIMATED)
-                {
-                    int l_bonesSize;
-                    l_file.read(reinterpret_cast<char*>(&l_bonesSize), sizeof(int));
-
-                    for(int i = 0; i < l_bonesSize; i++)
+                        std::istringstream l_stream(std::string(reinterpret_cast<char*>(l_data), l_size));
+                        l_stream.exceptions(std::istream::failbit | std::istream::badbit);
+                        LoadBonesData(l_stream);
+                    } break;
+                    case GFST_Collision:
                     {
-                        BoneData *l_boneData = new BoneData();
-                        m_bonesData.push_back(l_boneData);
-                        unsigned char l_boneNameLength;
-
-                        l_file.read(reinterpret_cast<char*>(&l_boneNameLength), sizeof(unsigned char));
-                        if(l_boneNameLength)
+                        try
+                        {
+                            std::istringstream l_stream(std::string(reinterpret_cast<char*>(l_data), l_size));
+                            l_stream.exceptions(std::istream::failbit | std::istream::badbit);
+                            LoadCollisionData(l_stream);
+                        }
+                        catch(const std::exception&)
                         {
-                            l_boneData->m_name.resize(l_boneNameLength);
-                            l_file.read(&l_boneData->m_name[0], l_boneNameLength);
+                            for(auto iter : m_collisionData) delete iter;
+                            m_collisionData.clear();
+
+                            for(auto iter : m_jointData) delete iter;
+                            m_jointData.clear();
                         }
-                        l_file.read(reinterpret_cast<char*>(&l_boneData->m_parent), sizeof(int));
-                        l_file.read(reinterpret_cast<char*>(&l_boneData->m_position), sizeof(glm::vec3));
-                        l_file.read(reinterpret_cast<char*>(&l_boneData->m_rotation), sizeof(glm::quat));
-                        l_file.read(reinterpret_cast<char*>(&l_boneData->m_scale), sizeof(glm::vec3));
-                    }
-                    m_bonesData.shrink_to_fit();
+                    } break;
                 }
-                l_result = true;
+            }
+
+            if(l_result)
+            {
+                SortMaterials();
+
+                // Vertices are packed here, sphere encloses the box stored by converter
+                m_boundMin = l_header.m_boundMin;
+                m_boundMax = l_header.m_boundMax;
+                m_boundSphereCenter = (m_boundMin + m_boundMax)*0.5f;
+                m_boundSphereRaduis = glm::distance(m_boundMax, m_boundSphereCenter);
             }
         }
-        catch(const std::exception&)
+    }
+    return l_result;
+}
+
+void ROC::Geometry::LoadBonesData(std::istream &f_stream)
+{
+    int l_bonesSize;
+    f_stream.read(reinterpret_cast<char*>(&l_bonesSize), sizeof(int));
+
+    for(int i = 0; i < l_bonesSize; i++)
+    {
+        BoneData *l_boneData = new BoneData();
+        m_bonesData.push_back(l_boneData);
+        unsigned char l_boneNameLength;
+
+        f_stream.read(reinterpret_cast<char*>(&l_boneNameLength), sizeof(unsigned char));
+        if(l_boneNameLength)
         {
-            Clear();
+            l_boneData->m_name.resize(l_boneNameLength);
+            f_stream.read(&l_boneData->m_name[0], l_boneNameLength);
         }
-        if(l_result && !m_async) m_loadState = GLS_Loaded;
+        f_stream.read(reinterpret_cast<char*>(&l_boneData->m_parent), sizeof(int));
+        f_stream.read(reinterpret_cast<char*>(&l_boneData->m_position), sizeof(glm::vec3));
+        f_stream.read(reinterpret_cast<char*>(&l_boneData->m_rotation), sizeof(glm::quat));
+        f_stream.read(reinterpret_cast<char*>(&l_boneData->m_scale), sizeof(glm::vec3));
+    }
+    m_bonesData.shrink_to_fit();
+}
+void ROC::Geometry::LoadCollisionData(std::istream &f_stream)
+{
+    unsigned int l_scbCount = 0U;
+    f_stream.read(reinterpret_cast<char*>(&l_scbCount), sizeof(unsigned int));
+    for(unsigned int i = 0U; i < l_scbCount; i++)
+    {
+        BoneCollisionData *l_colData = new BoneCollisionData();
+        m_collisionData.push_back(l_colData);
+        f_stream.read(reinterpret_cast<char*>(&l_colData->m_type), sizeof(unsigned char));
+        f_stream.read(reinterpret_cast<char*>(&l_colData->m_size), sizeof(glm::vec3));
+        f_stream.read(reinterpret_cast<char*>(&l_colData->m_offset), sizeof(glm::vec3));
+        f_stream.read(reinterpret_cast<char*>(&l_colData->m_offsetRotation), sizeof(glm::quat));
+        f_stream.read(reinterpret_cast<char*>(&l_colData->m_boneID), sizeof(unsigned int));
+    }
+    m_collisionData.shrink_to_fit();
 
-        if(l_result && (l_type == ROC_GEOMETRY_SETTER_ANIMATED))
+    unsigned int l_jointsCount = 0U;
+    f_stream.read(reinterpret_cast<char*>(&l_jointsCount), sizeof(unsigned int));
+    for(unsigned int i = 0U; i < l_jointsCount; i++)
+    {
+        unsigned int l_jointParts = 0U;
+        f_stream.read(reinterpret_cast<char*>(&l_jointParts), sizeof(unsigned int));
+
+        if(l_jointParts > 0U)
         {
-            try
+            BoneJointData *l_joint = new BoneJointData();
+            m_jointData.push_back(l_joint);
+            f_stream.read(reinterpret_cast<char*>(&l_joint->m_boneID), sizeof(unsigned int));
+            for(unsigned int j = 0; j < l_jointParts; j++)
             {
-                unsigned char l_physicBlock = 0U;
-                l_file.read(reinterpret_cast<char*>(&l_physicBlock), sizeof(unsigned char));
-                if(l_physicBlock == ROC_GEOMETRY_SETTER_COLLISION)
-                {
-                    unsigned int l_scbCount = 0U;
-                    l_file.read(reinterpret_cast<char*>(&l_scbCount), sizeof(unsigned int));
-                    for(unsigned int i = 0U; i < l_scbCount; i++)
-                    {
-                        BoneCollisionData *l_colData = new BoneCollisionData();
-                        m_collisionData.push_back(l_colData);
-                        l_file.read(reinterpret_cast<char*>(&l_colData->m_type), sizeof(unsigned char));
-                        l_file.read(reinterpret_cast<char*>(&l_colData->m_size), sizeof(glm::vec3));
-                        l_file.read(reinterpret_cast<char*>(&l_colData->m_offset), sizeof(glm::vec3));
-                        l_file.read(reinterpret_cast<char*>(&l_colData->m_offsetRotation), sizeof(glm::quat));
-                        l_file.read(reinterpret_cast<char*>(&l_colData->m_boneID), sizeof(unsigned int));
-                    }
-                    m_collisionData.shrink_to_fit();
-
-                    unsigned int l_jointsCount = 0U;
-                    l_file.read(reinterpret_cast<char*>(&l_jointsCount), sizeof(unsigned int));
-                    for(unsigned int i = 0U; i < l_jointsCount; i++)
-                    {
-                        unsigned int l_jointParts = 0U;
-                        l_file.read(reinterpret_cast<char*>(&l_jointParts), sizeof(unsigned int));
-
-                        if(l_jointParts > 0U)
-                        {
-                            BoneJointData *l_joint = new BoneJointData();
-                            m_jointData.push_back(l_joint);
-                            l_file.read(reinterpret_cast<char*>(&l_joint->m_boneID), sizeof(unsigned int));
-                            for(unsigned int j = 0; j < l_jointParts; j++)
-                            {
-                                BoneJointPartData l_jointPart;
+                BoneJointPartData l_jointPart;
 
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_boneID), sizeof(unsigned int));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_type), sizeof(unsigned char));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_size), sizeof(glm::vec3));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_offset), sizeof(glm::vec3));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_rotation), sizeof(glm::quat));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_boneID), sizeof(unsigned int));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_type), sizeof(unsigned char));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_size), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_offset), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_rotation), sizeof(glm::quat));
 
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_mass), sizeof(float));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_restutition), sizeof(float));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_friction), sizeof(float));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_damping), sizeof(glm::vec2));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_mass), sizeof(float));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_restutition), sizeof(float));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_friction), sizeof(float));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_damping), sizeof(glm::vec2));
 
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_lowerAngularLimit), sizeof(glm::vec3));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_upperAngularLimit), sizeof(glm::vec3));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_angularStiffness), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_lowerAngularLimit), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_upperAngularLimit), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_angularStiffness), sizeof(glm::vec3));
 
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_lowerLinearLimit), sizeof(glm::vec3));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_upperLinearLimit), sizeof(glm::vec3));
-                                l_file.read(reinterpret_cast<char*>(&l_jointPart.m_linearStiffness), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_lowerLinearLimit), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_upperLinearLimit), sizeof(glm::vec3));
+                f_stream.read(reinterpret_cast<char*>(&l_jointPart.m_linearStiffness), sizeof(glm::vec3));
 
-                                l_joint->m_jointPartVector.push_back(l_jointPart);
-                            }
-                            l_joint->m_jointPartVector.shrink_to_fit();
-                        }
-                    }
-                    m_jointData.shrink_to_fit();
-                }
+                l_joint->m_jointPartVector.push_back(l_jointPart);
             }
-            catch(const std::exception&)
-            {
-                for(auto iter : m_collisionData) delete iter;
-                m_collisionData.clear();
+            l_joint->m_jointPartVector.shrink_to_fit();
+        }
+    }
+    m_jointData.shrink_to_fit();
+}
 
-                for(auto iter : m_jointData) delete iter;
-                m_jointData.clear();
-            }
+void ROC::Geometry::SortMaterials()
+{
+    m_materialCount = static_cast<unsigned int>(m_materialVector.size());
+    if(m_materialCount > 0U)
+    {
+        std::vector<Material*> l_matVecDef, l_matVecDefDouble, l_matVecDefTransp;
+        for(auto iter : m_materialVector)
+        {
+            if(iter->IsTransparent() || !iter->HasDepth()) l_matVecDefTransp.push_back(iter);
+            else iter->IsDoubleSided() ? l_matVecDefDouble.push_back(iter) : l_matVecDef.push_back(iter);
         }
+        m_materialVector.clear();
+        m_materialVector.insert(m_materialVector.end(), l_matVecDefDouble.begin(), l_matVecDefDouble.end());
+        m_materialVector.insert(m_materialVector.end(), l_matVecDef.begin(), l_matVecDef.end());
+        m_materialVector.insert(m_materialVector.end(), l_matVecDefTransp.begin(), l_matVecDefTransp.end());
+        m_materialVector.shrink_to_fit();
     }
-    return l_result;
 }
 
 void ROC::Geometry::Clear()
@@ -305,6 +527,9 @@ void ROC::Geometry::Clear()
     m_materialVector.clear();
 
     m_materialCount = 0U;
+    m_boundMin = glm::vec3(0.f);
+    m_boundMax = glm::vec3(0.f);
+    m_boundSphereCenter = glm::vec3(0.f);
     m_boundSphereRaduis = 0.f;
 
     for(auto iter : m_bonesData) delete iter;
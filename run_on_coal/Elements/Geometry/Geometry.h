@@ -13,6 +13,9 @@ class Geometry final : public Element
     std::vector<Material*> m_materialVector;
     unsigned int m_materialCount;
 
+    glm::vec3 m_boundMin;
+    glm::vec3 m_boundMax;
+    glm::vec3 m_boundSphereCenter;
     float m_boundSphereRaduis;
 
     std::vector<BoneData*> m_bonesData;
@@ -29,9 +32,17 @@ class Geometry final : public Element
     bool m_async;
     bool m_released;
 
+    bool LoadVersion1(std::istream &f_file, unsigned char f_type);
+    bool LoadVersion2(std::istream &f_file);
+    void LoadBonesData(std::istream &f_stream);
+    void LoadCollisionData(std::istream &f_stream);
+    void SortMaterials();
     void Clear();
 public:
     inline bool IsLoaded() const { return (m_loadState == GLS_Loaded); }
+    inline const glm::vec3& GetBoundMin() const { return m_boundMin; }
+    inline const glm::vec3& GetBoundMax() const { return m_boundMax; }
+    inline const glm::vec3& GetBoundSphereCenter() const { return m_boundSphereCenter; }
     inline float GetBoundSphereRadius() const { return m_boundSphereRaduis; }
 
     inline bool HasBonesData() const { return !m_bonesData.empty(); }
@@ -0,0 +1,89 @@
+#pragma once
+
+// Version 2 geometry layout: header, section table, 16 bytes aligned sections. Shared with modelConverter
+#define ROC_GEOMETRY_VERSION2_MARKER 0xF2U
+#define ROC_GEOMETRY_VERSION2 2U
+#define ROC_GEOMETRY_VERSION2_ALIGNMENT 16U
+
+// Version 1 files have these after signature and bones block
+#define ROC_GEOMETRY_SETTER_ANIMATED 0x2U
+#define ROC_GEOMETRY_SETTER_COLLISION 0xCBU
+
+// Attribute types are stored as OpenGL enum values, modelConverter doesn't use OpenGL headers
+#define ROC_GEOMETRY_TYPE_BYTE 0x1400U
+#define ROC_GEOMETRY_TYPE_UNSIGNED_BYTE 0x1401U
+#define ROC_GEOMETRY_TYPE_UNSIGNED_SHORT 0x1403U
+#define ROC_GEOMETRY_TYPE_FLOAT 0x1406U
+#define ROC_GEOMETRY_TYPE_INT_2_10_10_10_REV 0x8D9FU
+
+namespace ROC
+{
+
+struct GeometryFileHeader
+{
+    char m_signature[3]; // "ROC"
+    unsigned char m_marker; // ROC_GEOMETRY_VERSION2_MARKER, version 1 has type byte here
+    unsigned int m_version;
+    unsigned int m_flags;
+    unsigned int m_sectionCount;
+    glm::vec3 m_boundMin;
+    glm::vec3 m_boundMax;
+    unsigned int m_reserved[2];
+};
+
+struct GeometryFileSection
+{
+    unsigned int m_type;
+    unsigned int m_compression;
+    unsigned long long m_offset;
+    unsigned long long m_size;
+    unsigned long long m_rawSize;
+};
+
+// Material section is followed by attributes and texture name, vertices and elements sections follow it
+struct GeometryFileMaterial
+{
+    unsigned char m_type;
+    unsigned char m_textureLength;
+    unsigned char m_attributeCount;
+    unsigned char m_elementSize;
+    glm::vec4 m_params;
+    unsigned int m_vertexCount;
+    unsigned int m_elementCount;
+    unsigned int m_stride;
+};
+
+struct GeometryFileAttribute
+{
+    unsigned char m_location;
+    unsigned char m_size;
+    unsigned char m_normalized;
+    unsigned char m_integer;
+    unsigned int m_type;
+    unsigned int m_offset;
+};
+
+enum GeometryFileFlag : unsigned int
+{
+    GFF_Animated = (1U << 0)
+};
+enum GeometryFileSectionType : unsigned int
+{
+    GFST_Material = 1U,
+    GFST_Vertices,
+    GFST_Elements,
+    GFST_Bones,
+    GFST_Collision
+};
+enum GeometryFileCompression : unsigned int
+{
+    GFC_None = 0U,
+    GFC_Zlib
+};
+
+static_assert(sizeof(GeometryFileHeader) == 48U, "GeometryFileHeader layout");
+static_assert(sizeof(GeometryFileSection) == 32U, "GeometryFileSection layout");
+static_assert(sizeof(GeometryFileMaterial) == 32U, "GeometryFileMaterial layout");
+static_assert(sizeof(GeometryFileAttribute) == 12U, "GeometryFileAttribute layout");
+
+}
@@ -1,18 +1,24 @@
 #include "stdafx.h"
 
 #include "Elements/Geometry/Material.h"
+#include "Elements/Geometry/VertexFormat.h"
 #include "Elements/Texture.h"
 
-ROC::Material::Material()
+#define ROC_MATERIAL_INSTANCE_ATTRIB 5U
+
+GLuint ROC::Material::ms_instanceVBO = 0U;
+
+ROC::Material::Material(bool f_async)
 {
     m_verticesCount = 0;
+    m_elementsCount = 0U;
+    m_elementsType = GL_UNSIGNED_INT;
 
     m_vertexVBO = 0U;
-    m_uvVBO = 0U;
-    m_normalVBO = 0U;
-    m_weightVBO = 0U;
-    m_indexVBO = 0U;
+    m_elementVBO = 0U;
     m_VAO = 0U;
+    m_vertexFormat = new VertexFormat();
+    m_async = f_async;
 
     m_params = glm::vec4(1.f);
     m_type = 0;
@@ -23,58 +29,50 @@ ROC::Material::Material()
 ROC::Material::~Material()
 {
     if(m_vertexVBO != 0U) glDeleteBuffers(1, &m_vertexVBO);
-    if(m_uvVBO != 0U) glDeleteBuffers(1, &m_uvVBO);
-    if(m_normalVBO != 0U) glDeleteBuffers(1, &m_normalVBO);
-    if(m_weightVBO != 0U) glDeleteBuffers(1, &m_weightVBO);
-    if(m_indexVBO != 0U) glDeleteBuffers(1, &m_indexVBO);
+    if(m_elementVBO != 0U) glDeleteBuffers(1, &m_elementVBO);
     if(m_VAO != 0U) glDeleteVertexArrays(1, &m_VAO);
-    delete m_texture;
+    delete m_vertexFormat;
 }
 
-void ROC::Material::LoadVertices(const std::vector<glm::vec3> &f_vector)
-{
-    if(m_vertexVBO == 0U)
-    {
-        m_verticesCount = f_vector.size();
-        glGenBuffers(1, &m_vertexVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, m_vertexVBO);
-        glBufferData(GL_ARRAY_BUFFER, m_verticesCount*sizeof(glm::vec3), f_vector.data(), GL_STATIC_DRAW);
-    }
-}
-void ROC::Material::LoadUVs(const std::vector<glm::vec2> &f_vector)
+void ROC::Material::LoadVertices(const VertexFormat &f_format, const void *f_data, size_t f_size)
 {
-    if(m_uvVBO == 0U)
+    if((m_vertexVBO == 0U) && (f_format.GetStride() > 0U))
     {
-        glGenBuffers(1, &m_uvVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, m_uvVBO);
-        glBufferData(GL_ARRAY_BUFFER, f_vector.size()*sizeof(glm::vec2), f_vector.data(), GL_STATIC_DRAW);
-    }
-}
-void ROC::Material::LoadNormals(const std::vector<glm::vec3> &f_vector)
-{
-    if(m_normalVBO == 0U)
-    {
-        glGenBuffers(1, &m_normalVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, m_normalVBO);
-        glBufferData(GL_ARRAY_BUFFER, f_vector.size()*sizeof(glm::vec3), f_vector.data(), GL_STATIC_DRAW);
+        *m_vertexFormat = f_format;
+        m_verticesCount = static_cast<unsigned int>(f_size / f_format.GetStride());
+        if(m_async) m_vertexData.assign(static_cast<const unsigned char*>(f_data), static_cast<const unsigned char*>(f_data) + f_size);
+        else
+        {
+            glGenBuffers(1, &m_vertexVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, m_vertexVBO);
+            glBufferData(GL_ARRAY_BUFFER, f_size, f_data, GL_STATIC_DRAW);
+        }
     }
 }
-void ROC::Material::LoadWeights(const std::vector<glm::vec4> &f_vector)
+void ROC::Material::LoadElements(const std::vector<unsigned int> &f_vector)
 {
-    if(m_weightVBO == 0U)
+    if(m_verticesCount <= std::numeric_limits<unsigned short>::max())
     {
-        glGenBuffers(1, &m_weightVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, m_weightVBO);
-        glBufferData(GL_ARRAY_BUFFER, f_vector.size()*sizeof(glm::vec4), f_vector.data(), GL_STATIC_DRAW);
+        std::vector<unsigned short> l_shortElements(f_vector.begin(), f_vector.end());
+        LoadElements(l_shortElements.data(), static_cast<unsigned int>(l_shortElements.size()), GL_UNSIGNED_SHORT);
     }
+    else LoadElements(f_vector.data(), static_cast<unsigned int>(f_vector.size()), GL_UNSIGNED_INT);
 }
-void ROC::Material::LoadIndices(const std::vector<glm::ivec4> &f_vector)
+void ROC::Material::LoadElements(const void *f_data, unsigned int f_count, GLenum f_type)
 {
-    if(m_indexVBO == 0U)
+    if(m_elementVBO == 0U)
     {
-        glGenBuffers(1, &m_indexVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, m_indexVBO);
-        glBufferData(GL_ARRAY_BUFFER, f_vector.size()*sizeof(glm::ivec4), f_vector.data(), GL_STATIC_DRAW);
+        // Uploaded through GL_ARRAY_BUFFER, element binding belongs to VAO that isn't created yet
+        m_elementsCount = f_count;
+        m_elementsType = f_type;
+        size_t l_size = m_elementsCount*((m_elementsType == GL_UNSIGNED_SHORT) ? sizeof(unsigned short) : sizeof(unsigned int));
+        if(m_async) m_elementData.assign(static_cast<const unsigned char*>(f_data), static_cast<const unsigned char*>(f_data) + l_size);
+        else
+        {
+            glGenBuffers(1, &m_elementVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, m_elementVBO);
+            glBufferData(GL_ARRAY_BUFFER, l_size, f_data, GL_STATIC_DRAW);
+        }
     }
 }
 
@@ -82,60 +80,89 @@ void ROC::Material::GenerateVAO()
 {
     if(m_VAO == 0U)
     {
-        glGenVertexArrays(1, &m_VAO);
-        glBindVertexArray(m_VAO);
-
-        if(m_vertexVBO != 0U)
+        if(!m_vertexData.empty())
         {
-            glEnableVertexAttribArray(0);
+            glGenBuffers(1, &m_vertexVBO);
             glBindBuffer(GL_ARRAY_BUFFER, m_vertexVBO);
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
-        }
-        if(m_uvVBO != 0U)
-        {
-            glEnableVertexAttribArray(1);
-            glBindBuffer(GL_ARRAY_BUFFER, m_uvVBO);
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+            glBufferData(GL_ARRAY_BUFFER, m_vertexData.size(), m_vertexData.data(), GL_STATIC_DRAW);
+            std::vector<unsigned char>().swap(m_vertexData);
         }
-        if(m_normalVBO != 0U)
+        if(!m_elementData.empty())
         {
-            glEnableVertexAttribArray(2);
-            glBindBuffer(GL_ARRAY_BUFFER, m_normalVBO);
-            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+            glGenBuffers(1, &m_elementVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, m_elementVBO);
+            glBufferData(GL_ARRAY_BUFFER, m_elementData.size(), m_elementData.data(), GL_STATIC_DRAW);
+            std::vector<unsigned char>().swap(m_elementData);
         }
-        if(m_weightVBO != 0U)
+        if(m_texture && !m_texture->IsAsyncLoad()) m_texture->Upload();
+
+        glGenVertexArrays(1, &m_VAO);
+        glBindVertexArray(m_VAO);
+
+        if(m_vertexVBO != 0U)
         {
-            glEnableVertexAttribArray(3);
-            glBindBuffer(GL_ARRAY_BUFFER, m_weightVBO);
-            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, NULL);
+            glBindBuffer(GL_ARRAY_BUFFER, m_vertexVBO);
+            m_vertexFormat->Apply();
         }
-        if(m_indexVBO != 0U)
+        if(m_elementVBO != 0U) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementVBO);
+        if(ms_instanceVBO != 0U)
         {
-            glEnableVertexAttribArray(4);
-            glBindBuffer(GL_ARRAY_BUFFER, m_indexVBO);
-            glVertexAttribIPointer(4, 4, GL_INT, 0, NULL);
+            // Per-instance model matrix takes four consecutive locations
+            glBindBuffer(GL_ARRAY_BUFFER, ms_instanceVBO);
+            for(unsigned int i = 0U; i < 4U; i++)
+            {
+                glEnableVertexAttribArray(ROC_MATERIAL_INSTANCE_ATTRIB + i);
+                glVertexAttribPointer(ROC_MATERIAL_INSTANCE_ATTRIB + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void*>(i*sizeof(glm::vec4)));
+                GLEW_VERSION_3_3 ? glVertexAttribDivisor(ROC_MATERIAL_INSTANCE_ATTRIB + i, 1) : glVertexAttribDivisorARB(ROC_MATERIAL_INSTANCE_ATTRIB + i, 1);
+            }
         }
         glBindVertexArray(NULL);
     }
 }
-void ROC::Material::LoadTexture(const std::string &f_path)
+
+void ROC::Material::Draw(bool f_bind)
 {
-    if(!m_texture)
+    if(m_VAO != 0U)
     {
-        m_texture = new Texture();
-        if(!m_texture->Load(f_path, IsTransparent() ? Texture::TT_RGBA : Texture::TT_RGB, GetFilteringType(), IsCompressed()))
-        {
-            delete m_texture;
-            m_texture = nullptr;
-        }
+        if(f_bind) glBindVertexArray(m_VAO);
+        if(m_elementVBO != 0U) glDrawElements(GL_TRIANGLES, m_elementsCount, m_elementsType, NULL);
+        else glDrawArrays(GL_TRIANGLES, 0, m_verticesCount);
     }
 }
-
-void ROC::Material::Draw(bool f_bind)
+void ROC::Material::DrawInstanced(bool f_bind, unsigned int f_count)
 {
     if(m_VAO != 0U)
     {
         if(f_bind) glBindVertexArray(m_VAO);
-        glDrawArrays(GL_TRIANGLES, 0, m_verticesCount);
+        if(m_elementVBO != 0U) glDrawElementsInstanced(GL_TRIANGLES, m_elementsCount, m_elementsType, NULL, f_count);
+        else glDrawArraysInstanced(GL_TRIANGLES, 0, m_verticesCount, f_count);
+    }
+}
+
+void ROC::Material::CreateInstanceVBO()
+{
+    if((ms_instanceVBO == 0U) && (GLEW_VERSION_3_3 || GLEW_ARB_instanced_arrays))
+    {
+        glGenBuffers(1, &ms_instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, ms_instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * ROC_MATERIAL_INSTANCES_COUNT, NULL, GL_STREAM_DRAW);
+    }
+}
+void ROC::Material::DestroyInstanceVBO()
+{
+    if(ms_instanceVBO != 0U)
+    {
+        glDeleteBuffers(1, &ms_instanceVBO);
+        ms_instanceVBO = 0U;
+    }
+}
+void ROC::Material::SetInstanceMatrices(const std::vector<glm::mat4> &f_value)
+{
+    if(ms_instanceVBO != 0U)
+    {
+        size_t l_matrixCount = std::min(f_value.size(), static_cast<size_t>(ROC_MATERIAL_INSTANCES_COUNT));
+        glBindBuffer(GL_ARRAY_BUFFER, ms_instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::mat4) * ROC_MATERIAL_INSTANCES_COUNT, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, l_matrixCount*sizeof(glm::mat4), f_value.data());
     }
 }
@@ -1,22 +1,33 @@
 #pragma once
 
+#define ROC_MATERIAL_INSTANCES_COUNT 512U
+
 namespace ROC
 {
 
 class Texture;
+class VertexFormat;
 class Material final
 {
     unsigned int m_verticesCount;
+    unsigned int m_elementsCount;
+    GLenum m_elementsType;
     GLuint m_vertexVBO;
-    GLuint m_uvVBO;
-    GLuint m_normalVBO;
-    GLuint m_weightVBO;
-    GLuint m_indexVBO;
+    GLuint m_elementVBO;
     GLuint m_VAO;
+    VertexFormat *m_vertexFormat;
+
+    // Async geometries keep data here until upload on main thread
+    bool m_async;
+    std::vector<unsigned char> m_vertexData;
+    std::vector<unsigned char> m_elementData;
 
     unsigned char m_type;
     glm::vec4 m_params;
+    std::string m_texturePath;
     Texture *m_texture;
+
+    static GLuint ms_instanceVBO;
 public:
     enum MaterialPropertyBit : unsigned char
     {
@@ -39,27 +50,37 @@ public:
     inline unsigned char GetFilteringType() const { return ((m_type&MPB_Filtering) >> 4); }
     inline bool HasTexture() const { return (m_texture != nullptr); }
 protected:
-    Material();
+    explicit Material(bool f_async);
     ~Material();
 
-    void LoadVertices(const std::vector<glm::vec3> &f_vector);
-    void LoadUVs(const std::vector<glm::vec2> &f_vector);
-    void LoadNormals(const std::vector<glm::vec3> &f_vector);
-    void LoadWeights(const std::vector<glm::vec4> &f_vector);
-    void LoadIndices(const std::vector<glm::ivec4> &f_vector);
-    void LoadTexture(const std::string &f_path);
+    void LoadVertices(const VertexFormat &f_format, const void *f_data, size_t f_size);
+    void LoadElements(const std::vector<unsigned int> &f_vector);
+    void LoadElements(const void *f_data, unsigned int f_count, GLenum f_type);
     void GenerateVAO();
 
     inline void SetType(unsigned char f_type) { m_type = f_type; }
 
+    // Texture is shared through element manager texture cache
+    inline void SetTexturePath(const std::string &f_path) { m_texturePath.assign(f_path); }
+    inline const std::string& GetTexturePath() const { return m_texturePath; }
+    inline void SetTexture(Texture *f_texture) { m_texture = f_texture; }
+
     inline void SetParams(const glm::vec4 &f_params) { std::memcpy(&m_params, &f_params, sizeof(glm::vec4)); }
 
     inline GLuint GetVAO() const { return m_VAO; }
     inline Texture* GetTexture() { return m_texture; }
 
     void Draw(bool f_bind);
+    void DrawInstanced(bool f_bind, unsigned int f_count);
+
+    static void CreateInstanceVBO();
+    static void DestroyInstanceVBO();
+    static void SetInstanceMatrices(const std::vector<glm::mat4> &f_value);
+    static inline bool IsInstancingSupported() { return (ms_instanceVBO != 0U); }
 
+    friend class ElementManager;
     friend class RenderManager;
+    friend class RenderQueue;
     friend class Geometry;
 };
 
@@ -0,0 +1,127 @@
+#include "stdafx.h"
+
+#include "Elements/Geometry/VertexFormat.h"
+#include "Elements/Geometry/GeometryFormat.hpp"
+
+#include "Utils/MeshUtils.h"
+
+ROC::VertexFormat::VertexFormat()
+{
+    m_stride = 0U;
+}
+ROC::VertexFormat::~VertexFormat()
+{
+    m_attributes.clear();
+}
+
+void ROC::VertexFormat::AddAttribute(unsigned char f_location, unsigned char f_size, GLenum f_type, bool f_normalized, bool f_integer)
+{
+    VertexAttribute l_attribute;
+    l_attribute.m_location = f_location;
+    l_attribute.m_size = f_size;
+    l_attribute.m_type = f_type;
+    l_attribute.m_normalized = f_normalized;
+    l_attribute.m_integer = f_integer;
+    l_attribute.m_offset = m_stride;
+    m_attributes.push_back(l_attribute);
+
+    m_stride += GetAttributeBytes(f_size, f_type);
+    m_stride = (m_stride + 3U) & ~3U;
+}
+void ROC::VertexFormat::AddAttribute(const VertexAttribute &f_attribute)
+{
+    m_attributes.push_back(f_attribute);
+
+    unsigned int l_end = f_attribute.m_offset + GetAttributeBytes(f_attribute.m_size, f_attribute.m_type);
+    m_stride = glm::max(m_stride, (l_end + 3U) & ~3U);
+}
+void ROC::VertexFormat::AddAttribute(const GeometryFileAttribute &f_attribute)
+{
+    VertexAttribute l_attribute;
+    l_attribute.m_location = f_attribute.m_location;
+    l_attribute.m_size = f_attribute.m_size;
+    l_attribute.m_type = static_cast<GLenum>(f_attribute.m_type);
+    l_attribute.m_normalized = (f_attribute.m_normalized != 0U);
+    l_attribute.m_integer = (f_attribute.m_integer != 0U);
+    l_attribute.m_offset = f_attribute.m_offset;
+    AddAttribute(l_attribute);
+}
+void ROC::VertexFormat::Clear()
+{
+    m_attributes.clear();
+    m_stride = 0U;
+}
+
+void ROC::VertexFormat::Apply() const
+{
+    for(const auto &iter : m_attributes)
+    {
+        glEnableVertexAttribArray(iter.m_location);
+        if(iter.m_integer) glVertexAttribIPointer(iter.m_location, iter.m_size, iter.m_type, m_stride, reinterpret_cast<void*>(static_cast<size_t>(iter.m_offset)));
+        else glVertexAttribPointer(iter.m_location, iter.m_size, iter.m_type, iter.m_normalized ? GL_TRUE : GL_FALSE, m_stride, reinterpret_cast<void*>(static_cast<size_t>(iter.m_offset)));
+    }
+}
+
+void ROC::VertexFormat::ConvertPackedNormals(unsigned char *f_data, size_t f_count)
+{
+    for(auto &iter : m_attributes)
+    {
+        if((iter.m_location == VAL_Normal) && (iter.m_type == GL_INT_2_10_10_10_REV))
+        {
+            // Same size, lower precision for contexts without 2_10_10_10 support
+            for(size_t i = 0U; i < f_count; i++)
+            {
+                unsigned char *l_target = f_data + i*m_stride + iter.m_offset;
+                unsigned int l_packed;
+                std::memcpy(&l_packed, l_target, sizeof(unsigned int));
+
+                glm::vec3 l_normal;
+                for(int j = 0; j < 3; j++)
+                {
+                    int l_value = static_cast<int>((l_packed >> (j * 10)) & 0x3FFU);
+                    if(l_value & 0x200) l_value -= 0x400;
+                    l_normal[j] = static_cast<float>(l_value) / 511.f;
+                }
+                glm::i8vec4 l_normalByte = MeshUtils::PackNormalSnorm8(l_normal);
+                std::memcpy(l_target, &l_normalByte, sizeof(glm::i8vec4));
+            }
+            iter.m_type = GL_BYTE;
+        }
+    }
+}
+
+bool ROC::VertexFormat::IsPackedNormalSupported()
+{
+    return (GLEW_VERSION_3_3 || GLEW_ARB_vertex_type_2_10_10_10_rev);
+}
+unsigned int ROC::VertexFormat::GetAttributeBytes(unsigned char f_size, GLenum f_type)
+{
+    unsigned int l_bytes = 0U;
+    switch(f_type)
+    {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT:
+            l_bytes = 4U*f_size;
+            break;
+        case GL_HALF_FLOAT: case GL_SHORT: case GL_UNSIGNED_SHORT:
+            l_bytes = 2U*f_size;
+            break;
+        case GL_BYTE: case GL_UNSIGNED_BYTE:
+            l_bytes = f_size;
+            break;
+        case GL_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_2_10_10_10_REV:
+            l_bytes = 4U;
+            break;
+    }
+    return l_bytes;
+}
+
+void ROC::VertexFormat::Pack(const std::vector<glm::vec3> &f_vertices, const std::vector<glm::vec2> &f_uvs, const std::vector<glm::vec3> &f_normals,
+    const std::vector<glm::vec4> &f_weights, const std::vector<glm::ivec4> &f_indices, VertexFormat &f_format, std::vector<unsigned char> &f_data)
+{
+    std::vector<GeometryFileAttribute> l_attributes;
+    unsigned int l_stride;
+    MeshUtils::PackVertices(f_vertices, f_uvs, f_normals, f_weights, f_indices, IsPackedNormalSupported(), l_attributes, l_stride, f_data);
+
+    f_format.Clear();
+    for(const auto &iter : l_attributes) f_format.AddAttribute(iter);
+}
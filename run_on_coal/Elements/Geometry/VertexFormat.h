@@ -0,0 +1,51 @@
+#pragma once
+
+namespace ROC
+{
+
+struct GeometryFileAttribute;
+class VertexFormat final
+{
+public:
+    enum VertexAttributeLocation : unsigned char
+    {
+        VAL_Position = 0U,
+        VAL_UV,
+        VAL_Normal,
+        VAL_Weight,
+        VAL_Index
+    };
+    struct VertexAttribute
+    {
+        unsigned char m_location = 0U;
+        unsigned char m_size = 0U;
+        GLenum m_type = GL_FLOAT;
+        bool m_normalized = false;
+        bool m_integer = false;
+        unsigned int m_offset = 0U;
+    };
+private:
+    std::vector<VertexAttribute> m_attributes;
+    unsigned int m_stride;
+public:
+    VertexFormat();
+    ~VertexFormat();
+
+    void AddAttribute(unsigned char f_location, unsigned char f_size, GLenum f_type, bool f_normalized, bool f_integer);
+    void AddAttribute(const VertexAttribute &f_attribute);
+    void AddAttribute(const GeometryFileAttribute &f_attribute);
+    void Clear();
+
+    inline const std::vector<VertexAttribute>& GetAttributes() const { return m_attributes; }
+    inline unsigned int GetStride() const { return m_stride; }
+
+    void Apply() const;
+    void ConvertPackedNormals(unsigned char *f_data, size_t f_count);
+
+    static bool IsPackedNormalSupported();
+    static unsigned int GetAttributeBytes(unsigned char f_size, GLenum f_type);
+    static void Pack(const std::vector<glm::vec3> &f_vertices, const std::vector<glm::vec2> &f_uvs, const std::vector<glm::vec3> &f_normals,
+        const std::vector<glm::vec4> &f_weights, const std::vector<glm::ivec4> &f_indices, VertexFormat &f_format, std::vector<unsigned char> &f_data);
+};
+
+}
@@ -3,101 +3,248 @@
 #include "Elements/Model/AnimationController.h"
 
 #include "Elements/Animation/Animation.h"
-#include "Elements/Model/Bone.h"
+#include "Elements/Model/Skeleton.h"
 
 #include "Utils/SystemTick.h"
 
 #define ROC_ANIMCONTROL_BLEND_DEFTIME 500U
 
+namespace ROC
+{
+
+extern const glm::quat g_DefaultRotation;
+
+}
+
 ROC::AnimationController::AnimationController()
 {
-    m_animation = nullptr;
-    m_tick = 0U;
-    m_state = AnimationState::None;
-    m_speed = 1.f;
+    m_layers.resize(1U);
+    m_changed = false;
+    m_lodInterval = 1U;
+    m_lodStep = 1U;
     m_blend = true;
     m_blendTime = ROC_ANIMCONTROL_BLEND_DEFTIME;
     m_blendTimeTick = 0U;
 }
 ROC::AnimationController::~AnimationController()
 {
+    m_layers.clear();
+}
+
+ROC::AnimationController::acLayer* ROC::AnimationController::GetLayer(unsigned int f_layer)
+{
+    acLayer *l_layer = nullptr;
+    if((f_layer < m_layers.size()) && m_layers[f_layer].m_animation) l_layer = &m_layers[f_layer];
+    return l_layer;
+}
+const ROC::AnimationController::acLayer* ROC::AnimationController::GetLayer(unsigned int f_layer) const
+{
+    const acLayer *l_layer = nullptr;
+    if((f_layer < m_layers.size()) && m_layers[f_layer].m_animation) l_layer = &m_layers[f_layer];
+    return l_layer;
 }
 
-void ROC::AnimationController::SetAnimation(Animation *f_anim)
+void ROC::AnimationController::SetAnimation(Animation *f_anim, unsigned int f_layer)
 {
-    m_animation = f_anim;
-    if(m_animation)
+    if(f_anim)
     {
-        m_tick = 0U;
+        if(f_layer >= m_layers.size()) m_layers.resize(f_layer + 1U);
+        acLayer &l_layer = m_layers[f_layer];
+        l_layer.m_animation = f_anim;
+        l_layer.m_tick = 0U;
+        l_layer.m_cursors.clear();
+        if(l_layer.m_state == AnimationState::None) l_layer.m_state = AnimationState::Paused;
+        if(l_layer.m_mask.size() != f_anim->GetBonesCount()) l_layer.m_mask.clear();
+        UpdateReference(l_layer);
+
         m_blend = true;
         m_blendTimeTick = 0U;
-        if(m_state == AnimationState::None) m_state = AnimationState::Paused;
     }
-    else m_state = AnimationState::None;
+    else if(f_layer < m_layers.size())
+    {
+        m_layers[f_layer] = acLayer();
+        while((m_layers.size() > 1U) && !m_layers.back().m_animation) m_layers.pop_back();
+    }
+    m_changed = true;
+}
+void ROC::AnimationController::RemoveAnimation(Animation *f_anim)
+{
+    for(size_t i = m_layers.size(); i > 0U; i--)
+    {
+        if(m_layers[i - 1U].m_animation == f_anim) SetAnimation(nullptr, static_cast<unsigned int>(i - 1U));
+    }
+}
+bool ROC::AnimationController::HasAnimation(Animation *f_anim) const
+{
+    bool l_result = false;
+    for(const auto &iter : m_layers)
+    {
+        if(iter.m_animation == f_anim)
+        {
+            l_result = true;
+            break;
+        }
+    }
+    return l_result;
 }
 
-bool ROC::AnimationController::Play()
+void ROC::AnimationController::UpdateReference(acLayer &f_layer)
 {
-    if(m_animation)
+    // Additive layer adds difference between current and first frame
+    if(f_layer.m_additive)
     {
-        if(m_state != AnimationState::Playing) m_state = AnimationState::Playing;
+        std::vector<AnimationCursor> l_cursors;
+        std::vector<float> l_mask;
+        f_layer.m_animation->GetData(0U, l_cursors, l_mask, f_layer.m_reference);
     }
-    return (m_animation != nullptr);
+    else f_layer.m_reference = AnimationPose();
+}
+
+bool ROC::AnimationController::Play(unsigned int f_layer)
+{
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer) l_layer->m_state = AnimationState::Playing;
+    return (l_layer != nullptr);
 }
-bool ROC::AnimationController::Pause()
+bool ROC::AnimationController::Pause(unsigned int f_layer)
 {
-    if(m_animation) m_state = AnimationState::Paused;
-    return (m_animation != nullptr);
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer) l_layer->m_state = AnimationState::Paused;
+    return (l_layer != nullptr);
 }
-bool ROC::AnimationController::Reset()
+bool ROC::AnimationController::Reset(unsigned int f_layer)
 {
-    if(m_animation) m_tick = 0U;
-    return (m_animation != nullptr);
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer)
+    {
+        l_layer->m_tick = 0U;
+        m_changed = true;
+    }
+    return (l_layer != nullptr);
 }
 
-bool ROC::AnimationController::SetSpeed(float f_speed)
+bool ROC::AnimationController::SetSpeed(float f_speed, unsigned int f_layer)
 {
-    if(m_animation)
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer)
     {
-        m_speed = f_speed;
-        btClamp(m_speed, 0.f, std::numeric_limits<float>::max());
+        l_layer->m_speed = f_speed;
+        btClamp(l_layer->m_speed, 0.f, std::numeric_limits<float>::max());
     }
-    return (m_animation != nullptr);
+    return (l_layer != nullptr);
+}
+float ROC::AnimationController::GetSpeed(unsigned int f_layer) const
+{
+    const acLayer *l_layer = GetLayer(f_layer);
+    return (l_layer ? l_layer->m_speed : 0.f);
 }
 
-bool ROC::AnimationController::SetProgress(float f_val)
+bool ROC::AnimationController::SetProgress(float f_val, unsigned int f_layer)
 {
-    if(m_animation)
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer)
     {
         btClamp(f_val, 0.f, 1.f);
-        m_tick = static_cast<unsigned int>(static_cast<float>(m_animation->GetDuration())*f_val);
+        l_layer->m_tick = static_cast<unsigned int>(static_cast<float>(l_layer->m_animation->GetDuration())*f_val);
+        m_changed = true;
     }
-    return (m_animation != nullptr);
+    return (l_layer != nullptr);
 }
-float ROC::AnimationController::GetProgress() const
+float ROC::AnimationController::GetProgress(unsigned int f_layer) const
 {
     float l_result = 0.f;
-    if(m_animation) l_result = (static_cast<float>(m_tick) / static_cast<float>(m_animation->GetDuration()));
+    const acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer) l_result = (static_cast<float>(l_layer->m_tick) / static_cast<float>(l_layer->m_animation->GetDuration()));
+    return l_result;
+}
+
+bool ROC::AnimationController::SetWeight(float f_weight, unsigned int f_layer)
+{
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer)
+    {
+        l_layer->m_weight = f_weight;
+        btClamp(l_layer->m_weight, 0.f, 1.f);
+        m_changed = true;
+    }
+    return (l_layer != nullptr);
+}
+float ROC::AnimationController::GetWeight(unsigned int f_layer) const
+{
+    const acLayer *l_layer = GetLayer(f_layer);
+    return (l_layer ? l_layer->m_weight : 0.f);
+}
+
+bool ROC::AnimationController::SetAdditive(bool f_state, unsigned int f_layer)
+{
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer && (l_layer->m_additive != f_state))
+    {
+        l_layer->m_additive = f_state;
+        UpdateReference(*l_layer);
+        m_changed = true;
+    }
+    return (l_layer != nullptr);
+}
+bool ROC::AnimationController::IsAdditive(unsigned int f_layer) const
+{
+    const acLayer *l_layer = GetLayer(f_layer);
+    return (l_layer ? l_layer->m_additive : false);
+}
+
+bool ROC::AnimationController::SetBoneMask(unsigned int f_bone, float f_weight, unsigned int f_layer)
+{
+    acLayer *l_layer = GetLayer(f_layer);
+    bool l_result = (l_layer && (f_bone < l_layer->m_animation->GetBonesCount()));
+    if(l_result)
+    {
+        if(l_layer->m_mask.empty()) l_layer->m_mask.assign(l_layer->m_animation->GetBonesCount(), 1.f);
+        btClamp(f_weight, 0.f, 1.f);
+        l_layer->m_mask[f_bone] = f_weight;
+        m_changed = true;
+    }
     return l_result;
 }
+bool ROC::AnimationController::ResetBoneMask(unsigned int f_layer)
+{
+    acLayer *l_layer = GetLayer(f_layer);
+    if(l_layer)
+    {
+        l_layer->m_mask.clear();
+        m_changed = true;
+    }
+    return (l_layer != nullptr);
+}
 
 bool ROC::AnimationController::SetBlendTime(unsigned int f_val)
 {
-    if(m_animation)
+    bool l_result = (m_layers[0].m_animation != nullptr);
+    if(l_result)
     {
         m_blendTime = f_val;
         btClamp(m_blendTime, 1U, std::numeric_limits<unsigned int>::max());
     }
-    return (m_animation != nullptr);
+    return l_result;
 }
 
-void ROC::AnimationController::Update(std::vector<Bone*> &f_bones)
+void ROC::AnimationController::Update(Skeleton *f_skeleton, unsigned int f_interval)
 {
-    if(m_animation && (m_state == AnimationState::Playing))
+    bool l_playing = false;
+    for(auto &iter : m_layers)
     {
-        m_tick += static_cast<unsigned int>(static_cast<float>(SystemTick::GetDelta())*m_speed);
-        m_tick %= m_animation->GetDuration();
-        if(m_blend)
+        if(iter.m_animation && (iter.m_state == AnimationState::Playing))
+        {
+            iter.m_tick += static_cast<unsigned int>(static_cast<float>(SystemTick::GetDelta())*iter.m_speed);
+            iter.m_tick %= iter.m_animation->GetDuration();
+            l_playing = true;
+        }
+    }
+
+    bool l_interpolating = (m_lodStep < m_lodInterval);
+    if(l_playing || m_changed || l_interpolating)
+    {
+        float l_blendValue = 1.f;
+        if(m_blend && l_playing)
         {
             m_blendTimeTick += SystemTick::GetDelta();
             if(m_blendTimeTick >= m_blendTime)
@@ -105,9 +252,71 @@ void ROC::AnimationController::Update(std::vector<Bone*> &f_bones)
                 m_blendTimeTick = m_blendTime;
                 m_blend = false;
             }
-            float l_blendValue = static_cast<float>(m_blendTimeTick) / static_cast<float>(m_blendTime);
-            for(auto iter : f_bones) iter->SetBlending(l_blendValue);
+            l_blendValue = static_cast<float>(m_blendTimeTick) / static_cast<float>(m_blendTime);
+        }
+
+        unsigned int l_bonesCount = f_skeleton->GetBonesCount();
+        if(m_changed || !l_interpolating)
+        {
+            // Layers are blended over rest pose, only bones sampled by any layer are passed to skeleton
+            m_resultPose.m_positions.assign(f_skeleton->GetRestPositions().begin(), f_skeleton->GetRestPositions().end());
+            m_resultPose.m_rotations.assign(f_skeleton->GetRestRotations().begin(), f_skeleton->GetRestRotations().end());
+            m_resultPose.m_scales.assign(f_skeleton->GetRestScales().begin(), f_skeleton->GetRestScales().end());
+            m_resultPose.m_sampled.assign(l_bonesCount, 0U);
+            for(auto &iter : m_layers)
+            {
+                if(!iter.m_animation || (iter.m_weight <= 0.f)) continue;
+
+                const std::vector<float> *l_mask = &iter.m_mask;
+                if(f_interval > 1U)
+                {
+                    // Leaf bones keep last pose at reduced update rate
+                    const std::vector<float> &l_branchMask = f_skeleton->GetBranchMask();
+                    m_lodMask.resize(l_bonesCount);
+                    for(unsigned int i = 0U; i < l_bonesCount; i++) m_lodMask[i] = (iter.m_mask.empty() ? l_branchMask[i] : (l_branchMask[i]*iter.m_mask[i]));
+                    l_mask = &m_lodMask;
+                }
+                iter.m_animation->GetData(iter.m_tick, iter.m_cursors, *l_mask, m_layerPose);
+
+                for(unsigned int i = 0U; i < l_bonesCount; i++)
+                {
+                    if(m_layerPose.m_sampled[i] == 0U) continue;
+
+                    float l_weight = (iter.m_mask.empty() ? iter.m_weight : (iter.m_weight*iter.m_mask[i]));
+                    if(iter.m_additive)
+                    {
+                        if(iter.m_reference.m_sampled[i] == 0U) continue;
+                        m_resultPose.m_positions[i] += (m_layerPose.m_positions[i] - iter.m_reference.m_positions[i])*l_weight;
+                        m_resultPose.m_rotations[i] = m_resultPose.m_rotations[i]*glm::slerp(g_DefaultRotation, glm::inverse(iter.m_reference.m_rotations[i])*m_layerPose.m_rotations[i], l_weight);
+                        m_resultPose.m_scales[i] *= glm::lerp(glm::vec3(1.f), m_layerPose.m_scales[i] / iter.m_reference.m_scales[i], l_weight);
+                    }
+                    else if(l_weight >= 1.f)
+                    {
+                        std::memcpy(&m_resultPose.m_positions[i], &m_layerPose.m_positions[i], sizeof(glm::vec3));
+                        std::memcpy(&m_resultPose.m_rotations[i], &m_layerPose.m_rotations[i], sizeof(glm::quat));
+                        std::memcpy(&m_resultPose.m_scales[i], &m_layerPose.m_scales[i], sizeof(glm::vec3));
+                    }
+                    else
+                    {
+                        m_resultPose.m_positions[i] = glm::lerp(m_resultPose.m_positions[i], m_layerPose.m_positions[i], l_weight);
+                        m_resultPose.m_rotations[i] = glm::slerp(m_resultPose.m_rotations[i], m_layerPose.m_rotations[i], l_weight);
+                        m_resultPose.m_scales[i] = glm::lerp(m_resultPose.m_scales[i], m_layerPose.m_scales[i], l_weight);
+                    }
+                    m_resultPose.m_sampled[i] = 1U;
+                }
+            }
+            m_lodInterval = std::max(f_interval, 1U);
+            m_lodStep = 0U;
+            m_changed = false;
+        }
+
+        // Sampled pose is reached in steps at reduced update rate, it's one interval behind animation time
+        m_lodStep++;
+        l_blendValue /= static_cast<float>(m_lodInterval - m_lodStep + 1U);
+        if(l_blendValue < 1.f) f_skeleton->SetBlending(l_blendValue);
+        for(unsigned int i = 0U; i < l_bonesCount; i++)
+        {
+            if(m_resultPose.m_sampled[i] != 0U) f_skeleton->SetBoneTransform(i, m_resultPose.m_positions[i], m_resultPose.m_rotations[i], m_resultPose.m_scales[i]);
         }
-        m_animation->GetData(m_tick, f_bones);
     }
 }
@@ -1,32 +1,69 @@
 #pragma once
+#include "Elements/Animation/Animation.h"
+
+#define ROC_ANIMCONTROL_MAX_LAYERS 8U
 
 namespace ROC
 {
 
-class Animation;
-class Bone;
+class Skeleton;
 class AnimationController final
 {
-    Animation *m_animation;
-    unsigned int m_tick;
-    enum AnimationState { None = 0U, Paused, Playing } m_state;
-    float m_speed;
+    enum AnimationState { None = 0U, Paused, Playing };
+
+    // Layers are applied in order, override layers blend to result by weight, additive layers add difference from first frame
+    struct acLayer
+    {
+        Animation *m_animation = nullptr;
+        unsigned int m_tick = 0U;
+        std::vector<AnimationCursor> m_cursors; // Last sampled interval of every bone
+        AnimationState m_state = None;
+        float m_speed = 1.f;
+        float m_weight = 1.f;
+        bool m_additive = false;
+        std::vector<float> m_mask; // Weights of bones, empty for all bones
+        AnimationPose m_reference;
+    };
+    std::vector<acLayer> m_layers; // [0] - base layer
+    AnimationPose m_layerPose;
+    AnimationPose m_resultPose;
+    bool m_changed;
+
+    // Pose sampled at reduced rate is reached in several frames
+    std::vector<float> m_lodMask;
+    unsigned int m_lodInterval;
+    unsigned int m_lodStep;
 
     bool m_blend;
     unsigned int m_blendTime;
     unsigned int m_blendTimeTick;
+
+    acLayer* GetLayer(unsigned int f_layer);
+    const acLayer* GetLayer(unsigned int f_layer) const;
+    void UpdateReference(acLayer &f_layer);
 public:
-    inline Animation* GetAnimation() { return m_animation; };
+    inline Animation* GetAnimation(unsigned int f_layer = 0U) { return ((f_layer < m_layers.size()) ? m_layers[f_layer].m_animation : nullptr); };
+    inline unsigned int GetLayersCount() const { return static_cast<unsigned int>(m_layers.size()); }
+    bool HasAnimation(Animation *f_anim) const;
+
+    bool Play(unsigned int f_layer = 0U);
+    bool Pause(unsigned int f_layer = 0U);
+    bool Reset(unsigned int f_layer = 0U);
+
+    bool SetSpeed(float f_speed, unsigned int f_layer = 0U);
+    float GetSpeed(unsigned int f_layer = 0U) const;
+
+    bool SetProgress(float f_val, unsigned int f_layer = 0U);
+    float GetProgress(unsigned int f_layer = 0U) const;
 
-    bool Play();
-    bool Pause();
-    bool Reset();
+    bool SetWeight(float f_weight, unsigned int f_layer);
+    float GetWeight(unsigned int f_layer) const;
 
-    bool SetSpeed(float f_speed);
-    inline float GetSpeed() const { return m_speed; }
+    bool SetAdditive(bool f_state, unsigned int f_layer);
+    bool IsAdditive(unsigned int f_layer) const;
 
-    bool SetProgress(float f_val);
-    float GetProgress() const;
+    bool SetBoneMask(unsigned int f_bone, float f_weight, unsigned int f_layer);
+    bool ResetBoneMask(unsigned int f_layer);
 
     bool SetBlendTime(unsigned int f_val);
     inline unsigned int GetBlendTime() const { return m_blendTime; }
@@ -34,9 +71,10 @@ protected:
     AnimationController();
     ~AnimationController();
 
-    void SetAnimation(Animation *f_anim);
+    void SetAnimation(Animation *f_anim, unsigned int f_layer = 0U);
+    void RemoveAnimation(Animation *f_anim);
 
-    void Update(std::vector<Bone*> &f_bones);
+    void Update(Skeleton *f_skeleton, unsigned int f_interval);
 
     friend class Model;
     friend class InheritanceManager;
@@ -5,7 +5,6 @@
 #include "Elements/Collision.h"
 #include "Elements/Geometry/Geometry.h"
 #include "Elements/Model/AnimationController.h"
-#include "Elements/Model/Bone.h"
 #include "Elements/Model/Skeleton.h"
 
 namespace ROC
@@ -29,11 +28,19 @@ ROC::Model::Model(Geometry *f_geometry)
     m_scale = g_DefaultScale;
     m_localMatrix = g_IdentityMatrix;
     m_globalMatrix = g_IdentityMatrix;
-    m_boundSphereRaduis = 0.f;
+    m_cullingIndex = 0U;
+    m_spatialProxy = -1;
+    m_boundsUpdated = false;
+    m_boneOffset = std::numeric_limits<size_t>::max();
     m_useScale = false;
     m_rebuildMatrix = false;
     m_rebuilded = false;
 
+    m_animationLOD = MAL_Auto;
+    m_animationInterval = 1U;
+    m_drawn = false;
+    m_drawDistance = 0.f;
+
     m_geometry = f_geometry;
 
     m_parent = nullptr;
@@ -43,7 +50,6 @@ ROC::Model::Model(Geometry *f_geometry)
     m_skeleton = nullptr;
     if(m_geometry)
     {
-        m_boundSphereRaduis = m_geometry->GetBoundSphereRadius();
         if(m_geometry->HasBonesData())
         {
             m_skeleton = new Skeleton(m_geometry->GetBonesData());
@@ -52,6 +58,8 @@ ROC::Model::Model(Geometry *f_geometry)
         }
     }
     m_collision = nullptr;
+
+    UpdateBounds();
 }
 ROC::Model::~Model()
 {
@@ -83,12 +91,6 @@ void ROC::Model::SetScale(const glm::vec3 &f_scl)
             break;
         }
     }
-    if(m_geometry)
-    {
-        m_boundSphereRaduis = m_geometry->GetBoundSphereRadius();
-        if(m_useScale) m_boundSphereRaduis *= glm::length(m_scale);
-    }
-
     m_rebuildMatrix = true;
 }
 
@@ -128,7 +130,32 @@ void ROC::Model::SetCollision(Collision *f_col)
     m_collision = f_col;
 }
 
-void ROC::Model::Update(ModelUpdateStage f_stage, bool f_arg1)
+void ROC::Model::UpdateBounds()
+{
+    if(m_geometry)
+    {
+        // Box extents are projected on world axes, sphere grows with largest axis scale
+        glm::vec3 l_center = (m_geometry->GetBoundMin() + m_geometry->GetBoundMax())*0.5f;
+        glm::vec3 l_extent = (m_geometry->GetBoundMax() - m_geometry->GetBoundMin())*0.5f;
+        glm::mat3 l_basis(m_globalMatrix);
+        m_boundBoxCenter = glm::vec3(m_globalMatrix*glm::vec4(l_center, 1.f));
+        m_boundBoxExtent = glm::abs(l_basis[0])*l_extent.x + glm::abs(l_basis[1])*l_extent.y + glm::abs(l_basis[2])*l_extent.z;
+
+        m_boundSphereCenter = glm::vec3(m_globalMatrix*glm::vec4(m_geometry->GetBoundSphereCenter(), 1.f));
+        float l_scale = std::max(glm::length(l_basis[0]), std::max(glm::length(l_basis[1]), glm::length(l_basis[2])));
+        m_boundSphereRaduis = m_geometry->GetBoundSphereRadius()*l_scale;
+    }
+    else
+    {
+        m_boundBoxCenter = glm::vec3(m_globalMatrix[3]);
+        m_boundBoxExtent = glm::vec3(0.f);
+        m_boundSphereCenter = m_boundBoxCenter;
+        m_boundSphereRaduis = 0.f;
+    }
+    m_boundsUpdated = true;
+}
+
+void ROC::Model::Update(ModelUpdateStage f_stage, bool f_arg1, float f_arg2)
 {
     switch(f_stage)
     {
@@ -150,9 +177,9 @@ void ROC::Model::Update(ModelUpdateStage f_stage, bool f_arg1)
             {
                 if(m_parentBone != -1)
                 {
-                    if(m_parent->m_skeleton->GetBones()[m_parentBone]->IsRebuilded() || m_parent->m_rebuilded)
+                    if(m_parent->m_skeleton->IsBoneRebuilded(static_cast<unsigned int>(m_parentBone)) || m_parent->m_rebuilded)
                     {
-                        const glm::mat4 &l_boneMatrix = m_parent->m_skeleton->GetBones()[m_parentBone]->GetMatrix();
+                        const glm::mat4 &l_boneMatrix = m_parent->m_skeleton->GetBoneMatrix(static_cast<unsigned int>(m_parentBone));
                         std::memcpy(&m_globalMatrix, &m_parent->m_globalMatrix, sizeof(glm::mat4));
                         m_globalMatrix *= l_boneMatrix;
                         m_globalMatrix *= m_localMatrix;
@@ -173,6 +200,7 @@ void ROC::Model::Update(ModelUpdateStage f_stage, bool f_arg1)
             {
                 if(m_rebuilded) std::memcpy(&m_globalMatrix, &m_localMatrix, sizeof(glm::mat4));
             }
+            if(m_rebuilded) UpdateBounds();
         } break;
 
         case MUS_Collision:
@@ -182,26 +210,33 @@ void ROC::Model::Update(ModelUpdateStage f_stage, bool f_arg1)
                 m_rebuilded = m_collision->IsActive();
                 if(m_rebuilded)
                 {
-                    m_collision->GetTransform(m_localMatrix, m_position, m_rotation);
+                    // Body is drawn between states of two last physics steps
+                    m_collision->GetTransform(m_localMatrix, m_position, m_rotation, f_arg2);
                     if(m_useScale) m_localMatrix *= glm::scale(g_IdentityMatrix, m_scale);
                     std::memcpy(&m_globalMatrix, &m_localMatrix, sizeof(glm::mat4));
+                    UpdateBounds();
                 }
             }
         } break;
 
-        case MUS_SkeletonStatic:
+        case MUS_Skeleton:
         {
+            // No physics calls, models of different hierarchies are updated in parallel
             if(m_skeleton)
             {
-                m_animController->Update(m_skeleton->GetBones());
-                m_skeleton->UpdateCollision(Skeleton::SUS_Static, m_globalMatrix, f_arg1);
+                if(m_animationInterval > 0U) m_animController->Update(m_skeleton, m_animationInterval);
                 m_skeleton->Update();
             }
         } break;
 
+        case MUS_SkeletonStatic:
+        {
+            if(m_skeleton) m_skeleton->UpdateCollision(Skeleton::SUS_Static, m_globalMatrix, f_arg1);
+        } break;
+
         case MUS_SkeletonDynamic:
         {
-            if(m_skeleton) m_skeleton->UpdateCollision(Skeleton::SUS_Dynamic, m_globalMatrix, f_arg1);
+            if(m_skeleton) m_skeleton->UpdateCollision(Skeleton::SUS_Dynamic, m_globalMatrix, f_arg1, f_arg2);
         } break;
     }
 }
@@ -23,18 +23,42 @@ class Model final : public Element
     glm::vec3 m_scale;
     glm::mat4 m_localMatrix;
     glm::mat4 m_globalMatrix;
+    glm::vec3 m_boundSphereCenter;
     float m_boundSphereRaduis;
+    glm::vec3 m_boundBoxCenter;
+    glm::vec3 m_boundBoxExtent;
+    size_t m_cullingIndex;
+    int m_spatialProxy;
+    bool m_boundsUpdated;
+    size_t m_boneOffset;
     bool m_useScale;
     bool m_rebuildMatrix;
     bool m_rebuilded;
 
+    // Visibility and camera distance come from draws of previous frame
+    unsigned char m_animationLOD;
+    unsigned int m_animationInterval; // Frames between animation samples, 0 - frozen
+    bool m_drawn;
+    float m_drawDistance;
+
     Model *m_parent;
     int m_parentBone;
 
     AnimationController *m_animController;
     Skeleton *m_skeleton;
     Collision *m_collision;
+
+    void UpdateBounds();
 public:
+    enum ModelAnimationLOD : unsigned char
+    {
+        MAL_Auto = 0U,
+        MAL_Full,
+        MAL_Half,
+        MAL_Quarter,
+        MAL_Frozen
+    };
+
     inline bool HasGeometry() const { return (m_geometry != nullptr); }
     inline Geometry* GetGeometry() { return m_geometry; }
 
@@ -50,12 +74,18 @@ public:
     inline const glm::mat4& GetLocalMatrix() const { return m_localMatrix; }
     inline const glm::mat4& GetGlobalMatrix() const { return m_globalMatrix; }
 
+    // World space bounds, updated with global matrix
+    inline const glm::vec3& GetBoundSphereCenter() const { return m_boundSphereCenter; }
     float inline GetBoundSphereRadius() const { return m_boundSphereRaduis; }
+    inline const glm::vec3& GetBoundBoxCenter() const { return m_boundBoxCenter; }
+    inline const glm::vec3& GetBoundBoxExtent() const { return m_boundBoxExtent; }
 
     inline bool HasParent() { return (m_parent != nullptr); }
     inline Model* GetParent() { return m_parent; }
 
     inline AnimationController* GetAnimationController() { return m_animController; }
+    inline void SetAnimationLOD(unsigned char f_lod) { m_animationLOD = f_lod; }
+    inline unsigned char GetAnimationLOD() const { return m_animationLOD; }
     inline bool HasSkeleton() const { return (m_skeleton != nullptr); }
 
     inline bool HasCollision() const { return (m_collision != nullptr); }
@@ -65,6 +95,7 @@ protected:
     {
         MUS_Matrix,
         MUS_Collision,
+        MUS_Skeleton,
         MUS_SkeletonStatic,
         MUS_SkeletonDynamic
     };
@@ -72,9 +103,9 @@ protected:
     explicit Model(Geometry *f_geometry);
     ~Model();
 
-    inline void SetGeometry(Geometry *f_geometry) { m_geometry = f_geometry; }
+    inline void SetGeometry(Geometry *f_geometry) { m_geometry = f_geometry; UpdateBounds(); }
 
-    void Update(ModelUpdateStage f_stage, bool f_arg1 = false);
+    void Update(ModelUpdateStage f_stage, bool f_arg1 = false, float f_arg2 = 1.f);
 
     void SetParent(Model *f_model, int f_bone = -1);
 
@@ -83,6 +114,7 @@ protected:
     void SetCollision(Collision *f_col);
 
     friend class ElementManager;
+    friend class FrustumCuller;
     friend class InheritanceManager;
     friend class PhysicsManager;
     friend class PreRenderManager;
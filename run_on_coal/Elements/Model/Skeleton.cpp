@@ -2,17 +2,11 @@
 
 #include "Elements/Model/Skeleton.h"
 
-#include "Elements/Animation/BoneFrameData.h"
 #include "Elements/Geometry/BoneCollisionData.hpp"
 #include "Elements/Geometry/BoneData.hpp"
 #include "Elements/Geometry/BoneJointData.hpp"
-#include "Elements/Model/Bone.h"
+#include "Utils/CollisionShapeCache.h"
 
-#define ROC_BONECOL_TYPE_SPHERE 0U
-#define ROC_BONECOL_TYPE_BOX 1U
-#define ROC_BONECOL_TYPE_CYLINDER 2U
-#define ROC_BONECOL_TYPE_CAPSULE 3U
-#define ROC_BONECOL_TYPE_CONE 4U
 #define ROC_SKELETON_TRANSFORMATION_MAIN 0
 #define ROC_SKELETON_TRANSFORMATION_INVERSE 1
 #define ROC_SKELETON_TRANSFORMATION_BIND 2
@@ -20,57 +14,97 @@
 namespace ROC
 {
 
+extern const glm::vec3 g_DefaultScale;
 extern const glm::mat4 g_IdentityMatrix;
 
 }
 
+unsigned char ROC::Skeleton::ms_palette = ROC::Skeleton::SP_Matrix;
+size_t ROC::Skeleton::ms_paletteVectors = 4U;
+
 ROC::Skeleton::Skeleton(const std::vector<BoneData*> &f_data)
 {
-    for(auto iter : f_data)
-    {
-        Bone *l_bone = new Bone(iter->m_name, iter->m_rotation, iter->m_position, iter->m_scale);
-        m_boneVector.push_back(l_bone);
-    }
-    m_boneVector.shrink_to_fit();
-    m_bonesCount = static_cast<unsigned int>(m_boneVector.size());
+    m_bonesCount = static_cast<unsigned int>(f_data.size());
+    m_parents.resize(m_bonesCount);
+    m_positions.resize(m_bonesCount);
+    m_rotations.resize(m_bonesCount);
+    m_scales.resize(m_bonesCount);
+    m_dirty.assign(m_bonesCount, 0U);
+    m_localMatrices.assign(m_bonesCount, g_IdentityMatrix);
+    m_matrices.assign(m_bonesCount, g_IdentityMatrix);
+    m_bindMatrices.assign(m_bonesCount, g_IdentityMatrix);
+    m_rebuilded.assign(m_bonesCount, 0U);
+    m_poseData.resize(m_bonesCount*ms_paletteVectors);
+
+    std::vector<std::vector<unsigned int>> l_children(m_bonesCount);
     for(unsigned int i = 0; i < m_bonesCount; i++)
     {
-        if(f_data[i]->m_parent != -1)
-        {
-            m_boneVector[i]->SetParent(m_boneVector[f_data[i]->m_parent]);
-            m_boneVector[f_data[i]->m_parent]->AddChild(m_boneVector[i]);
-        }
+        std::memcpy(&m_positions[i], &f_data[i]->m_position, sizeof(glm::vec3));
+        std::memcpy(&m_rotations[i], &f_data[i]->m_rotation, sizeof(glm::quat));
+        std::memcpy(&m_scales[i], &f_data[i]->m_scale, sizeof(glm::vec3));
+        m_parents[i] = f_data[i]->m_parent;
+        if(m_parents[i] != -1) l_children[m_parents[i]].push_back(i);
+        WritePose(i, g_IdentityMatrix);
     }
-    if(!m_boneVector.empty())
+    if(m_bonesCount > 0U)
     {
-        std::vector<Bone*> l_bonesStack;
-        l_bonesStack.push_back(m_boneVector.front());
+        std::vector<unsigned int> l_bonesStack(1U, 0U);
         while(!l_bonesStack.empty())
         {
-            Bone *l_bone = l_bonesStack.back();
+            unsigned int l_bone = l_bonesStack.back();
             l_bonesStack.pop_back();
-            l_bonesStack.insert(l_bonesStack.end(), l_bone->m_childBoneVector.rbegin(), l_bone->m_childBoneVector.rend());
-            m_fastBoneVector.push_back(l_bone);
-            l_bone->GenerateBindPose();
+            l_bonesStack.insert(l_bonesStack.end(), l_children[l_bone].rbegin(), l_children[l_bone].rend());
+            m_order.push_back(l_bone);
+
+            ComposeMatrix(m_positions[l_bone], m_rotations[l_bone], m_scales[l_bone], m_localMatrices[l_bone]);
+            if(m_parents[l_bone] == -1) std::memcpy(&m_matrices[l_bone], &m_localMatrices[l_bone], sizeof(glm::mat4));
+            else m_matrices[l_bone] = m_matrices[m_parents[l_bone]]*m_localMatrices[l_bone];
+            m_bindMatrices[l_bone] = glm::inverse(m_matrices[l_bone]);
         }
     }
-    m_poseMatrices.resize(m_bonesCount);
-    m_poseMatrices.shrink_to_fit();
+    m_order.shrink_to_fit();
+    m_restPositions.assign(m_positions.begin(), m_positions.end());
+    m_restRotations.assign(m_rotations.begin(), m_rotations.end());
+    m_restScales.assign(m_scales.begin(), m_scales.end());
+    m_branchMask.resize(m_bonesCount);
+    for(unsigned int i = 0; i < m_bonesCount; i++) m_branchMask[i] = (l_children[i].empty() ? 0.f : 1.f);
+
+    m_blend = false;
+    m_blendValue = 0.f;
 
     m_hasStaticBoneCollision = false;
     m_hasDynamicBoneCollision = false;
+
+    m_collisionModel = g_IdentityMatrix;
+    m_collisionEnabled = false;
+    m_collisionReset = true;
+    m_collisionSleeping = false;
+    m_collisionUpdates = 0U;
 }
 ROC::Skeleton::~Skeleton()
 {
-    for(auto iter : m_boneVector) delete iter;
-    m_boneVector.clear();
-    m_poseMatrices.clear();
+    m_parents.clear();
+    m_order.clear();
+    m_positions.clear();
+    m_rotations.clear();
+    m_scales.clear();
+    m_dirty.clear();
+    m_restPositions.clear();
+    m_restRotations.clear();
+    m_restScales.clear();
+    m_branchMask.clear();
+    m_localMatrices.clear();
+    m_matrices.clear();
+    m_bindMatrices.clear();
+    m_rebuilded.clear();
+    m_poseData.clear();
 
     if(m_hasStaticBoneCollision)
     {
         for(auto iter : m_collisionVector)
         {
             iter->m_offset.clear();
+            CollisionShapeCache::ReleaseShape(iter->m_rigidBody->getCollisionShape());
             delete iter->m_rigidBody->getMotionState();
             delete iter->m_rigidBody;
             delete iter;
@@ -89,25 +123,129 @@ ROC::Skeleton::~Skeleton()
                 l_jointPart->m_constraint->getRigidBodyA().removeConstraintRef(l_jointPart->m_constraint);
                 l_jointPart->m_constraint->getRigidBodyB().removeConstraintRef(l_jointPart->m_constraint);
                 delete l_jointPart->m_constraint;
+                CollisionShapeCache::ReleaseShape(l_jointPart->m_rigidBody->getCollisionShape());
                 delete l_jointPart->m_rigidBody->getMotionState();
                 delete l_jointPart->m_rigidBody;
                 delete l_jointPart;
             }
             iter->m_offsetMatrix.clear();
             iter->m_partsVector.clear();
+            CollisionShapeCache::ReleaseShape(iter->m_emptyBody->getCollisionShape());
             delete iter->m_emptyBody->getMotionState();
             delete iter->m_emptyBody;
             delete iter;
         }
         m_jointVector.clear();
     }
-    m_fastBoneVector.clear();
 }
 
 void ROC::Skeleton::Update()
 {
-    for(auto iter : m_fastBoneVector) iter->Update();
-    for(unsigned int i = 0; i < m_bonesCount; i++) std::memcpy(&m_poseMatrices[i], &m_boneVector[i]->GetPoseMatrix(), sizeof(glm::mat4));
+    for(auto l_bone : m_order)
+    {
+        int l_parent = m_parents[l_bone];
+        bool l_rebuild = (m_dirty[l_bone] != 0U);
+        if(l_rebuild) ComposeMatrix(m_positions[l_bone], m_rotations[l_bone], m_scales[l_bone], m_localMatrices[l_bone]);
+        if(l_parent != -1)
+        {
+            if(l_rebuild || (m_rebuilded[l_parent] != 0U))
+            {
+                m_matrices[l_bone] = m_matrices[l_parent]*m_localMatrices[l_bone];
+                l_rebuild = true;
+            }
+        }
+        else if(l_rebuild) std::memcpy(&m_matrices[l_bone], &m_localMatrices[l_bone], sizeof(glm::mat4));
+
+        if(l_rebuild) WritePose(l_bone, m_matrices[l_bone]*m_bindMatrices[l_bone]);
+        m_rebuilded[l_bone] = l_rebuild ? 1U : 0U;
+        m_dirty[l_bone] = 0U;
+    }
+    m_blend = false;
+}
+void ROC::Skeleton::WritePose(unsigned int f_bone, const glm::mat4 &f_pose)
+{
+    glm::vec4 *l_data = m_poseData.data() + f_bone*ms_paletteVectors;
+    switch(ms_palette)
+    {
+        case SP_Affine:
+        {
+            // Rows of upper 3x4 part, last row is always (0,0,0,1)
+            l_data[0] = glm::row(f_pose, 0);
+            l_data[1] = glm::row(f_pose, 1);
+            l_data[2] = glm::row(f_pose, 2);
+        } break;
+        case SP_DualQuat:
+        {
+            // Skinning transforms are rigid with uniform scale, scale is taken out before quaternion conversion
+            float l_scale = glm::length(glm::vec3(f_pose[0]));
+            glm::quat l_rotation = glm::quat_cast(glm::mat3(f_pose) / ((l_scale > 0.f) ? l_scale : 1.f));
+            l_data[0] = glm::vec4(l_rotation.x, l_rotation.y, l_rotation.z, l_rotation.w);
+            l_data[1] = glm::vec4(glm::vec3(f_pose[3]), l_scale);
+        } break;
+        default:
+            std::memcpy(l_data, &f_pose, sizeof(glm::mat4));
+            break;
+    }
+}
+void ROC::Skeleton::ComposeMatrix(const glm::vec3 &f_pos, const glm::quat &f_rot, const glm::vec3 &f_scl, glm::mat4 &f_mat)
+{
+    // Translation * Rotation * Scale without intermediate matrices
+    glm::mat3 l_rotation = glm::mat3_cast(f_rot);
+    f_mat[0] = glm::vec4(l_rotation[0]*f_scl.x, 0.f);
+    f_mat[1] = glm::vec4(l_rotation[1]*f_scl.y, 0.f);
+    f_mat[2] = glm::vec4(l_rotation[2]*f_scl.z, 0.f);
+    f_mat[3] = glm::vec4(f_pos, 1.f);
+}
+
+void ROC::Skeleton::SetBlending(float f_blend)
+{
+    m_blend = true;
+    m_blendValue = f_blend;
+}
+void ROC::Skeleton::SetBoneTransform(unsigned int f_bone, const glm::vec3 &f_pos, const glm::quat &f_rot, const glm::vec3 &f_scl)
+{
+    if(m_blend)
+    {
+        m_positions[f_bone] = glm::lerp(m_positions[f_bone], f_pos, m_blendValue);
+        m_rotations[f_bone] = glm::slerp(m_rotations[f_bone], f_rot, m_blendValue);
+        m_scales[f_bone] = glm::lerp(m_scales[f_bone], f_scl, m_blendValue);
+        m_dirty[f_bone] = 1U;
+    }
+    else
+    {
+        if(m_positions[f_bone] != f_pos)
+        {
+            std::memcpy(&m_positions[f_bone], &f_pos, sizeof(glm::vec3));
+            m_dirty[f_bone] = 1U;
+        }
+        if(m_rotations[f_bone] != f_rot)
+        {
+            std::memcpy(&m_rotations[f_bone], &f_rot, sizeof(glm::quat));
+            m_dirty[f_bone] = 1U;
+        }
+        if(m_scales[f_bone] != f_scl)
+        {
+            std::memcpy(&m_scales[f_bone], &f_scl, sizeof(glm::vec3));
+            m_dirty[f_bone] = 1U;
+        }
+    }
+}
+
+void ROC::Skeleton::SetPalette(unsigned char f_palette)
+{
+    ms_palette = f_palette;
+    switch(ms_palette)
+    {
+        case SP_Affine:
+            ms_paletteVectors = 3U;
+            break;
+        case SP_DualQuat:
+            ms_paletteVectors = 2U;
+            break;
+        default:
+            ms_paletteVectors = 4U;
+            break;
+    }
 }
 
 void ROC::Skeleton::InitStaticBoneCollision(const std::vector<BoneCollisionData*> &f_vec, void *f_model)
@@ -118,30 +256,10 @@ void ROC::Skeleton::InitStaticBoneCollision(const std::vector<BoneCollisionData*
         {
             skCollision *l_colData = new skCollision();
 
-            btCollisionShape *l_shape = nullptr;
-            switch(iter->m_type)
-            {
-                case ROC_BONECOL_TYPE_SPHERE:
-                    l_shape = new btSphereShape(iter->m_size.x);
-                    break;
-                case ROC_BONECOL_TYPE_BOX:
-                    l_shape = new btBoxShape(btVector3(iter->m_size.x, iter->m_size.y, iter->m_size.z));
-                    break;
-                case ROC_BONECOL_TYPE_CYLINDER:
-                    l_shape = new btCylinderShape(btVector3(iter->m_size.x, iter->m_size.y, iter->m_size.z));
-                    break;
-                case ROC_BONECOL_TYPE_CAPSULE:
-                    l_shape = new btCapsuleShape(iter->m_size.x, iter->m_size.y);
-                    break;
-                case ROC_BONECOL_TYPE_CONE:
-                    l_shape = new btConeShape(iter->m_size.x, iter->m_size.y);
-                    break;
-                default:
-                    l_shape = new btEmptyShape();
-            }
+            btCollisionShape *l_shape = CollisionShapeCache::AcquireShape(iter->m_type, iter->m_size, g_DefaultScale);
 
             btTransform l_boneTransform, l_bodyOffset = btTransform::getIdentity(), l_bodyTransform;
-            l_boneTransform.setFromOpenGLMatrix(glm::value_ptr(m_boneVector[iter->m_boneID]->GetMatrix()));
+            l_boneTransform.setFromOpenGLMatrix(glm::value_ptr(m_matrices[iter->m_boneID]));
 
             l_bodyOffset.setOrigin(btVector3(iter->m_offset.x, iter->m_offset.y, iter->m_offset.z));
             l_bodyOffset.setRotation(btQuaternion(iter->m_offsetRotation.x, iter->m_offsetRotation.y, iter->m_offsetRotation.z, iter->m_offsetRotation.w));
@@ -176,12 +294,12 @@ void ROC::Skeleton::InitDynamicBoneCollision(const std::vector<BoneJointData*> &
             skJoint *l_joint = new skJoint();
             l_joint->m_boneID = static_cast<int>(iter->m_boneID);
             l_joint->m_offsetMatrix.push_back(btTransform());
-            l_joint->m_offsetMatrix[ROC_SKELETON_TRANSFORMATION_MAIN].setFromOpenGLMatrix(glm::value_ptr(m_boneVector[l_joint->m_boneID]->GetLocalMatrix()));
+            l_joint->m_offsetMatrix[ROC_SKELETON_TRANSFORMATION_MAIN].setFromOpenGLMatrix(glm::value_ptr(m_localMatrices[l_joint->m_boneID]));
 
             btTransform l_boneTransform;
-            l_boneTransform.setFromOpenGLMatrix(glm::value_ptr(m_boneVector[l_joint->m_boneID]->GetMatrix()));
+            l_boneTransform.setFromOpenGLMatrix(glm::value_ptr(m_matrices[l_joint->m_boneID]));
 
-            btCollisionShape *l_jointShape = new btEmptyShape();
+            btCollisionShape *l_jointShape = CollisionShapeCache::AcquireShape(CollisionShapeCache::ST_Empty, glm::vec3(0.f), g_DefaultScale);
             btDefaultMotionState *l_jointFallMotionState = new btDefaultMotionState(l_boneTransform);
             btRigidBody::btRigidBodyConstructionInfo l_jointFallRigidBodyCI(0.f, l_jointFallMotionState, l_jointShape);
             l_joint->m_emptyBody = new btRigidBody(l_jointFallRigidBodyCI);
@@ -198,39 +316,19 @@ void ROC::Skeleton::InitDynamicBoneCollision(const std::vector<BoneJointData*> &
 
                 btTransform l_jointPartTransform = btTransform::getIdentity(), l_jointPartResultTransform;
 
-                l_boneTransform.setFromOpenGLMatrix(glm::value_ptr(m_boneVector[l_jointPart->m_boneID]->GetMatrix()));
+                l_boneTransform.setFromOpenGLMatrix(glm::value_ptr(m_matrices[l_jointPart->m_boneID]));
                 l_jointPartTransform.setOrigin(btVector3(l_partData.m_offset.x, l_partData.m_offset.y, l_partData.m_offset.z));
                 l_jointPartTransform.setRotation(btQuaternion(l_partData.m_rotation.x, l_partData.m_rotation.y, l_partData.m_rotation.z, l_partData.m_rotation.w));
 
                 l_jointPart->m_offset.push_back(l_jointPartTransform);
                 l_jointPart->m_offset.push_back(l_jointPartTransform.inverse());
                 l_jointPart->m_offset.push_back(btTransform());
-                l_jointPart->m_offset[ROC_SKELETON_TRANSFORMATION_BIND].setFromOpenGLMatrix(glm::value_ptr(m_boneVector[l_jointPart->m_boneID]->GetBindMatrix()));
+                l_jointPart->m_offset[ROC_SKELETON_TRANSFORMATION_BIND].setFromOpenGLMatrix(glm::value_ptr(m_bindMatrices[l_jointPart->m_boneID]));
 
                 l_jointPartResultTransform.mult(l_boneTransform, l_jointPartTransform);
 
-                btCollisionShape *l_jointPartShape = nullptr;
+                btCollisionShape *l_jointPartShape = CollisionShapeCache::AcquireShape(l_partData.m_type, l_partData.m_size, g_DefaultScale);
                 btVector3 l_jointPartInertia;
-                switch(l_partData.m_type)
-                {
-                    case ROC_BONECOL_TYPE_SPHERE:
-                        l_jointPartShape = new btSphereShape(l_partData.m_size.x);
-                        break;
-                    case ROC_BONECOL_TYPE_BOX:
-                        l_jointPartShape = new btBoxShape(btVector3(l_partData.m_size.x, l_partData.m_size.y, l_partData.m_size.z));
-                        break;
-                    case ROC_BONECOL_TYPE_CYLINDER:
-                        l_jointPartShape = new btCylinderShape(btVector3(l_partData.m_size.x, l_partData.m_size.y, l_partData.m_size.z));
-                        break;
-                    case ROC_BONECOL_TYPE_CAPSULE:
-                        l_jointPartShape = new btCapsuleShape(l_partData.m_size.x, l_partData.m_size.y);
-                        break;
-                    case ROC_BONECOL_TYPE_CONE:
-                        l_jointPartShape = new btConeShape(l_partData.m_size.x, l_partData.m_size.y);
-                        break;
-                    default:
-                        l_jointPartShape = new btEmptyShape();
-                }
                 l_jointPartShape->calculateLocalInertia(l_partData.m_mass, l_jointPartInertia);
                 btDefaultMotionState *l_jointPartFallMotionState = new btDefaultMotionState(l_jointPartResultTransform);
                 btRigidBody::btRigidBodyConstructionInfo l_jointPartFallRigidBodyCI(l_partData.m_mass, l_jointPartFallMotionState, l_jointPartShape, l_jointPartInertia);
@@ -289,14 +387,46 @@ void ROC::Skeleton::InitDynamicBoneCollision(const std::vector<BoneJointData*> &
     }
 }
 
-void ROC::Skeleton::UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4 &f_model, bool f_enabled)
+void ROC::Skeleton::SetCollisionSleeping(bool f_state)
+{
+    if(m_collisionSleeping != f_state)
+    {
+        // Sleeping kinematic bodies keep last transform and don't take part in narrowphase with other inactive objects
+        m_collisionSleeping = f_state;
+        int l_state = (f_state ? ISLAND_SLEEPING : DISABLE_DEACTIVATION);
+        for(auto iter : m_collisionVector)
+        {
+            iter->m_rigidBody->forceActivationState(l_state);
+            iter->m_rigidBody->setLinearVelocity(btVector3(0.f, 0.f, 0.f));
+            iter->m_rigidBody->setAngularVelocity(btVector3(0.f, 0.f, 0.f));
+        }
+        for(auto iter : m_jointVector)
+        {
+            iter->m_emptyBody->forceActivationState(l_state);
+            iter->m_emptyBody->setLinearVelocity(btVector3(0.f, 0.f, 0.f));
+            iter->m_emptyBody->setAngularVelocity(btVector3(0.f, 0.f, 0.f));
+        }
+        if(!f_state) m_collisionReset = true;
+    }
+}
+void ROC::Skeleton::UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4 &f_model, bool f_enabled, float f_interpolation)
 {
     switch(f_stage)
     {
         case SUS_Static:
         {
-            if(m_hasStaticBoneCollision || m_hasDynamicBoneCollision)
+            m_collisionUpdates = 0U;
+            if((m_hasStaticBoneCollision || m_hasDynamicBoneCollision) && !m_collisionSleeping)
             {
+                // Motion states aren't written without physics, bodies are placed directly on next switch
+                if(m_collisionEnabled != f_enabled)
+                {
+                    m_collisionEnabled = f_enabled;
+                    m_collisionReset = true;
+                }
+                bool l_modelChanged = (m_collisionReset || (std::memcmp(&m_collisionModel, &f_model, sizeof(glm::mat4)) != 0));
+                if(l_modelChanged) std::memcpy(&m_collisionModel, &f_model, sizeof(glm::mat4));
+
                 btTransform l_model;
                 btTransform l_transform1, l_transform2;
                 l_model.setFromOpenGLMatrix(glm::value_ptr(f_model));
@@ -305,11 +435,15 @@ void ROC::Skeleton::UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4
                 {
                     for(auto iter : m_collisionVector)
                     {
+                        if(!l_modelChanged && (m_rebuilded[iter->m_boneID] == 0U)) continue;
+
                         // BodyGlobal = Model * (Bone * BodyBoneOffset)
-                        l_transform1.setFromOpenGLMatrix(glm::value_ptr(m_boneVector[iter->m_boneID]->GetMatrix()));
+                        l_transform1.setFromOpenGLMatrix(glm::value_ptr(m_matrices[iter->m_boneID]));
                         l_transform2.mult(l_transform1, iter->m_offset[ROC_SKELETON_TRANSFORMATION_MAIN]);
                         l_transform1.mult(l_model, l_transform2);
-                        f_enabled ? iter->m_rigidBody->getMotionState()->setWorldTransform(l_transform1) : iter->m_rigidBody->setCenterOfMassTransform(l_transform1);
+                        if(f_enabled) iter->m_rigidBody->getMotionState()->setWorldTransform(l_transform1);
+                        if(!f_enabled || m_collisionReset) iter->m_rigidBody->setCenterOfMassTransform(l_transform1);
+                        m_collisionUpdates++;
                     }
                 }
 
@@ -317,24 +451,27 @@ void ROC::Skeleton::UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4
                 {
                     for(auto iter : m_jointVector)
                     {
-                        if(m_boneVector[iter->m_boneID]->HasParent())
+                        int l_parent = m_parents[iter->m_boneID];
+                        if(!l_modelChanged && ((l_parent == -1) || (m_rebuilded[l_parent] == 0U))) continue;
+
+                        if(l_parent != -1)
                         {
                             // BodyGlobal = Model * (ParentBone * BodyBoneOffset)
-                            l_transform1.setFromOpenGLMatrix(glm::value_ptr(m_boneVector[iter->m_boneID]->GetParent()->GetMatrix()));
+                            l_transform1.setFromOpenGLMatrix(glm::value_ptr(m_matrices[l_parent]));
                             l_transform2.mult(l_transform1, iter->m_offsetMatrix[ROC_SKELETON_TRANSFORMATION_MAIN]);
                             l_transform1.mult(l_model, l_transform2);
-
-                            f_enabled ? iter->m_emptyBody->getMotionState()->setWorldTransform(l_transform1) : iter->m_emptyBody->setCenterOfMassTransform(l_transform1);
                         }
                         else
                         {
                             // BodyGlobal = Model * BodyBoneOffset
                             l_transform1.mult(l_model, iter->m_offsetMatrix[ROC_SKELETON_TRANSFORMATION_MAIN]);
-
-                            f_enabled ? iter->m_emptyBody->getMotionState()->setWorldTransform(l_transform1) : iter->m_emptyBody->setCenterOfMassTransform(l_transform1);
                         }
+                        if(f_enabled) iter->m_emptyBody->getMotionState()->setWorldTransform(l_transform1);
+                        if(!f_enabled || m_collisionReset) iter->m_emptyBody->setCenterOfMassTransform(l_transform1);
+                        m_collisionUpdates++;
                     }
                 }
+                m_collisionReset = false;
             }
         } break;
 
@@ -348,19 +485,29 @@ void ROC::Skeleton::UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4
                 if(f_enabled)
                 {
                     btTransform l_modelInv = l_model.inverse();
+                    btTransform l_body;
+                    glm::mat4 l_pose;
                     for(auto iter : m_jointVector)
                     {
                         for(auto iter1 : iter->m_partsVector)
                         {
+                            // Body is drawn between states of two last physics steps
+                            l_body = iter1->m_rigidBody->getCenterOfMassTransform();
+                            if(f_interpolation < 1.f)
+                            {
+                                btQuaternion l_previousRotation(iter1->m_previousRotation.x, iter1->m_previousRotation.y, iter1->m_previousRotation.z, iter1->m_previousRotation.w);
+                                l_body.setOrigin(btVector3(iter1->m_previousPosition.x, iter1->m_previousPosition.y, iter1->m_previousPosition.z).lerp(l_body.getOrigin(), f_interpolation));
+                                l_body.setRotation(l_previousRotation.slerp(l_body.getRotation(), f_interpolation));
+                            }
+
                             // Pose = (ModelInverse * (BodyGlobal * BodyBoneOffsetInverse)) * BoneBind
-                            Bone *l_bone = m_boneVector[iter1->m_boneID];
-                            l_transform1.mult(iter1->m_rigidBody->getCenterOfMassTransform(), iter1->m_offset[ROC_SKELETON_TRANSFORMATION_INVERSE]);
+                            l_transform1.mult(l_body, iter1->m_offset[ROC_SKELETON_TRANSFORMATION_INVERSE]);
                             l_transform2.mult(l_modelInv, l_transform1);
-                            l_bone->SetMatrix(l_transform2);
+                            l_transform2.getOpenGLMatrix(glm::value_ptr(m_matrices[iter1->m_boneID]));
                             l_transform1.mult(l_transform2, iter1->m_offset[ROC_SKELETON_TRANSFORMATION_BIND]);
 
-                            l_bone->SetPoseMatrix(l_transform1);
-                            std::memcpy(&m_poseMatrices[iter1->m_boneID], &l_bone->GetPoseMatrix(), sizeof(glm::mat4));
+                            l_transform1.getOpenGLMatrix(glm::value_ptr(l_pose));
+                            WritePose(static_cast<unsigned int>(iter1->m_boneID), l_pose);
                         }
                     }
                 }
@@ -371,15 +518,29 @@ void ROC::Skeleton::UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4
                         for(auto iter1 : iter->m_partsVector)
                         {
                             // BodyGlobal = Model * (BoneMatrix * BodyBoneOffset)
-                            l_transform1.setFromOpenGLMatrix(glm::value_ptr(m_boneVector[iter1->m_boneID]->GetMatrix()));
+                            l_transform1.setFromOpenGLMatrix(glm::value_ptr(m_matrices[iter1->m_boneID]));
                             l_transform2.mult(l_transform1, iter1->m_offset[ROC_SKELETON_TRANSFORMATION_MAIN]);
                             l_transform1.mult(l_model, l_transform2);
 
                             iter1->m_rigidBody->setCenterOfMassTransform(l_transform1);
                         }
                     }
+                    SaveCollisionTransforms();
                 }
             }
         } break;
     }
 }
+void ROC::Skeleton::SaveCollisionTransforms()
+{
+    for(auto iter : m_jointVector)
+    {
+        for(auto iter1 : iter->m_partsVector)
+        {
+            const btTransform &l_transform = iter1->m_rigidBody->getCenterOfMassTransform();
+            std::memcpy(&iter1->m_previousPosition, l_transform.getOrigin().m_floats, sizeof(glm::vec3));
+            btQuaternion l_rotation = l_transform.getRotation();
+            for(int i = 0; i < 4; i++) iter1->m_previousRotation[i] = l_rotation[i];
+        }
+    }
+}
@@ -3,18 +3,40 @@
 namespace ROC
 {
 
-class Bone;
 struct BoneCollisionData;
 struct BoneData;
-class BoneFrameData;
 struct BoneJointData;
 
+// Bones are kept in flat arrays indexed by bone ID, hierarchy is evaluated in one pass over m_order
 class Skeleton final
 {
     unsigned int m_bonesCount;
-    std::vector<Bone*> m_boneVector;
-    std::vector<Bone*> m_fastBoneVector;
-    std::vector<glm::mat4> m_poseMatrices;
+    std::vector<int> m_parents;
+    std::vector<unsigned int> m_order; // Parents go before children
+
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::quat> m_rotations;
+    std::vector<glm::vec3> m_scales;
+    std::vector<unsigned char> m_dirty;
+    std::vector<glm::vec3> m_restPositions;
+    std::vector<glm::quat> m_restRotations;
+    std::vector<glm::vec3> m_restScales;
+    std::vector<float> m_branchMask; // 0 for leaf bones, they aren't animated at reduced update rate
+
+    std::vector<glm::mat4> m_localMatrices;
+    std::vector<glm::mat4> m_matrices;
+    std::vector<glm::mat4> m_bindMatrices;
+    std::vector<unsigned char> m_rebuilded;
+    std::vector<glm::vec4> m_poseData;
+
+    bool m_blend;
+    float m_blendValue;
+
+    static unsigned char ms_palette;
+    static size_t ms_paletteVectors;
+    void WritePose(unsigned int f_bone, const glm::mat4 &f_pose);
+
+    static void ComposeMatrix(const glm::vec3 &f_pos, const glm::quat &f_rot, const glm::vec3 &f_scl, glm::mat4 &f_mat);
 
     struct skCollision
     {
@@ -36,16 +58,38 @@ class Skeleton final
             btRigidBody *m_rigidBody;
             btGeneric6DofSpringConstraint *m_constraint;
             int m_boneID;
+            glm::vec3 m_previousPosition; // Body state before last physics step
+            glm::quat m_previousRotation;
         };
         std::vector<jtPart*> m_partsVector;
     };
     std::vector<skJoint*> m_jointVector;
     bool m_hasDynamicBoneCollision;
+
+    // Kinematic bodies are moved only if their bone or model matrix changed, sleeping bodies aren't moved at all
+    glm::mat4 m_collisionModel;
+    bool m_collisionEnabled; // Physics state of last update
+    bool m_collisionReset; // Next update moves all bodies without velocity
+    bool m_collisionSleeping;
+    unsigned int m_collisionUpdates; // Bodies moved in last update
 public:
+    // Skinning data layout of bone: mat4, transposed 3x4 affine matrix or rotation quaternion with vec4(translation, scale)
+    enum SkeletonPalette : unsigned char
+    {
+        SP_Matrix = 0U,
+        SP_Affine,
+        SP_DualQuat
+    };
+
     inline unsigned int GetBonesCount() const { return m_bonesCount; }
+    static inline unsigned char GetPalette() { return ms_palette; }
+    static inline size_t GetPaletteVectors() { return ms_paletteVectors; }
 
     inline bool HasStaticBoneCollision() const { return m_hasStaticBoneCollision; }
     inline bool HasDynamicBoneCollision() const { return m_hasDynamicBoneCollision; }
+    inline bool IsCollisionSleeping() const { return m_collisionSleeping; }
+    inline unsigned int GetCollisionUpdates() const { return m_collisionUpdates; }
+    inline unsigned int GetCollisionBodiesCount() const { return static_cast<unsigned int>(m_collisionVector.size() + m_jointVector.size()); }
 protected:
     enum SkeletonUpdateStage : unsigned char
     {
@@ -58,8 +102,17 @@ protected:
 
     void Update();
 
-    inline std::vector<Bone*>& GetBones() { return m_boneVector; }
-    inline const std::vector<glm::mat4>& GetPoseMatrices() const { return m_poseMatrices; }
+    void SetBlending(float f_blend);
+    void SetBoneTransform(unsigned int f_bone, const glm::vec3 &f_pos, const glm::quat &f_rot, const glm::vec3 &f_scl);
+    inline const std::vector<glm::vec3>& GetRestPositions() const { return m_restPositions; }
+    inline const std::vector<glm::quat>& GetRestRotations() const { return m_restRotations; }
+    inline const std::vector<glm::vec3>& GetRestScales() const { return m_restScales; }
+    inline const std::vector<float>& GetBranchMask() const { return m_branchMask; }
+    inline bool IsBoneRebuilded(unsigned int f_bone) const { return (m_rebuilded[f_bone] != 0U); }
+    inline const glm::mat4& GetBoneMatrix(unsigned int f_bone) const { return m_matrices[f_bone]; }
+    inline const std::vector<glm::vec4>& GetPoseData() const { return m_poseData; }
+
+    static void SetPalette(unsigned char f_palette);
 
     void InitStaticBoneCollision(const std::vector<BoneCollisionData*> &f_vec, void *f_model);
     inline const std::vector<skCollision*>& GetCollision() const { return m_collisionVector; }
@@ -67,11 +120,15 @@ protected:
     void InitDynamicBoneCollision(const std::vector<BoneJointData*> &f_vec, void *f_model);
     inline const std::vector<skJoint*>& GetJoints() const { return m_jointVector; }
 
-    void UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4 &f_model, bool f_enabled);
+    void UpdateCollision(SkeletonUpdateStage f_stage, const glm::mat4 &f_model, bool f_enabled, float f_interpolation = 1.f);
+    void SaveCollisionTransforms();
+    void SetCollisionSleeping(bool f_state);
 
     friend class Model;
+    friend class AnimationController;
     friend class RenderManager;
     friend class PhysicsManager;
+    friend class PreRenderManager;
 };
 
 }
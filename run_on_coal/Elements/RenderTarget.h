@@ -40,11 +40,13 @@ protected:
     inline const std::string& GetError() const { return m_error; }
 
     inline GLuint GetTextureID() const { return m_texture; }
+    inline GLuint GetFramebufferID() const { return m_frameBuffer; }
 
     void Bind();
     void Enable();
 
     friend class ElementManager;
+    friend class OcclusionCuller;
     friend class RenderManager;
     friend class Shader;
 };
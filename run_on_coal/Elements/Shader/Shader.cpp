@@ -3,19 +3,20 @@
 #include "Elements/Shader/Shader.h"
 #include "Elements/Shader/ShaderUniform.h"
 #include "Elements/Drawable.h"
+#include "Elements/Model/Skeleton.h"
 #include "Utils/Pool.h"
 
 #include "Utils/EnumUtils.h"
 #include "Utils/GLUtils.hpp"
 
 #define ROC_SHADER_BONES_BINDPOINT 0
-#define ROC_SHADER_BONES_COUNT 227U
+#define ROC_SHADER_BONES_BLOCK_SIZE 14528U // 227 mat4
 
 namespace ROC
 {
 
 const std::vector<std::string> g_DefaultUniformsTable = {
-    "gProjectionMatrix", "gViewMatrix", "gViewProjectionMatrix", "gModelMatrix", "gAnimated", "gBonesUniform", "gBoneMatrix", "gBoneMatrix[0]",
+    "gProjectionMatrix", "gViewMatrix", "gViewProjectionMatrix", "gModelMatrix", "gAnimated", "gInstanced", "gBonesUniform", "gBoneMatrix", "gBoneMatrix[0]",
     "gLightColor", "gLightDirection", "gLightParam",
     "gCameraPosition", "gCameraDirection",
     "gMaterialType", "gMaterialParam",
@@ -26,9 +27,37 @@ extern const glm::vec3 g_EmptyVec3;
 extern const glm::vec4 g_EmptyVec4;
 extern const glm::mat4 g_EmptyMat4;
 
+// Defines are placed after #version line of vertex and geometry shaders:
+// gBonesUniform block is declared as 'vec4 gBoneData[ROC_BONES_VECTORS]', ROC_BONE_MATRIX gives skinning matrix of bone for any palette
+const std::string g_BonesMatrixDefines =
+    "#define ROC_BONES_PALETTE_MATRIX\n"
+    "#define ROC_BONE_MATRIX(d, i) mat4(d[(i)*4], d[(i)*4 + 1], d[(i)*4 + 2], d[(i)*4 + 3])\n";
+const std::string g_BonesAffineDefines =
+    "#define ROC_BONES_PALETTE_AFFINE\n"
+    "#define ROC_BONE_MATRIX(d, i) transpose(mat4(d[(i)*3], d[(i)*3 + 1], d[(i)*3 + 2], vec4(0.0, 0.0, 0.0, 1.0)))\n";
+// Bone is rotation quaternion and vec4(translation, uniform scale), rocDualQuat* functions blend them as dual quaternions
+const std::string g_BonesDualQuatDefines =
+    "#define ROC_BONES_PALETTE_DUALQUAT\n"
+    "mat4 rocBoneMatrix(vec4 q, vec4 ts)\n"
+    "{\n"
+    "    vec3 q2 = q.xyz*2.0; vec3 qq = q.xyz*q2;\n"
+    "    float xy = q.x*q2.y; float xz = q.x*q2.z; float yz = q.y*q2.z; float wx = q.w*q2.x; float wy = q.w*q2.y; float wz = q.w*q2.z;\n"
+    "    return mat4(vec4(1.0 - qq.y - qq.z, xy + wz, xz - wy, 0.0)*ts.w, vec4(xy - wz, 1.0 - qq.x - qq.z, yz + wx, 0.0)*ts.w, vec4(xz + wy, yz - wx, 1.0 - qq.x - qq.y, 0.0)*ts.w, vec4(ts.xyz, 1.0));\n"
+    "}\n"
+    "vec4 rocDualQuatDual(vec4 q, vec3 t) { return vec4(q.w*t + cross(t, q.xyz), -dot(t, q.xyz))*0.5; }\n"
+    "vec3 rocDualQuatRotate(vec4 r, vec3 v) { return v + 2.0*cross(r.xyz, cross(r.xyz, v) + r.w*v); }\n"
+    "vec3 rocDualQuatTransform(vec4 r, vec4 d, vec3 p) { return rocDualQuatRotate(r, p) + 2.0*(r.w*d.xyz - d.w*r.xyz + cross(r.xyz, d.xyz)); }\n"
+    "#define ROC_BONE_MATRIX(d, i) rocBoneMatrix(d[(i)*2], d[(i)*2 + 1])\n"
+    "#define ROC_BONE_ROTATION(d, i) d[(i)*2]\n"
+    "#define ROC_BONE_TRANSLATION(d, i) d[(i)*2 + 1].xyz\n"
+    "#define ROC_BONE_SCALE(d, i) d[(i)*2 + 1].w\n";
+
 }
 
 GLuint ROC::Shader::ms_bonesUBO = GL_INVALID_INDEX;
+GLsizeiptr ROC::Shader::ms_bonesUBOSize = 0;
+GLint ROC::Shader::ms_bonesAlignment = 256;
+GLintptr ROC::Shader::ms_bonesBoundOffset = -1;
 bool ROC::Shader::ms_uboFix = false;
 
 ROC::Shader::Shader()
@@ -50,6 +79,7 @@ ROC::Shader::Shader()
     m_materialParamUniform = -1;
     m_materialTypeUniform = -1;
     m_animatedUniform = -1;
+    m_instancedUniform = -1;
     m_texture0Uniform = -1;
     m_timeUniform = -1;
     m_colorUniform = -1;
@@ -67,6 +97,7 @@ ROC::Shader::Shader()
     m_materialParamUniformValue = g_EmptyVec4;
     m_materialTypeUniformValue = 0;
     m_animatedUniformValue = 0U;
+    m_instancedUniformValue = 0U;
     m_timeUniformValue = 0.f;
     m_colorUniformValue = g_EmptyVec4;
 
@@ -99,6 +130,7 @@ bool ROC::Shader::Load(const std::string &f_vpath, const std::string &f_fpath, c
 
             if(!l_shaderData.empty())
             {
+                InjectBonesDefines(l_shaderData);
                 l_vertexShader = glCreateShader(GL_VERTEX_SHADER);
                 if(l_vertexShader)
                 {
@@ -171,6 +203,7 @@ bool ROC::Shader::Load(const std::string &f_vpath, const std::string &f_fpath, c
 
                 if(!l_shaderData.empty())
                 {
+                    InjectBonesDefines(l_shaderData);
                     l_geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
                     if(l_geometryShader)
                     {
@@ -206,6 +239,8 @@ bool ROC::Shader::Load(const std::string &f_vpath, const std::string &f_fpath, c
                 if(l_fragmentShader) glAttachShader(m_program, l_fragmentShader);
                 if(l_geometryShader) glAttachShader(m_program, l_geometryShader);
 
+                SetupDefaultAttributesLocations();
+
                 GLint l_link = 0;
                 glLinkProgram(m_program);
                 glGetProgramiv(m_program, GL_LINK_STATUS, &l_link);
@@ -234,14 +269,50 @@ bool ROC::Shader::Load(const std::string &f_vpath, const std::string &f_fpath, c
     }
     return (m_program != 0U);
 }
-void ROC::Shader::SetupDefaultUniformsAndLocations()
+void ROC::Shader::InjectBonesDefines(std::string &f_source)
+{
+    size_t l_position = 0U;
+    size_t l_version = f_source.find("#version");
+    if(l_version != std::string::npos)
+    {
+        l_position = f_source.find('\n', l_version);
+        l_position = (l_position == std::string::npos) ? f_source.size() : (l_position + 1U);
+    }
+
+    std::string l_defines("#define ROC_BONES_VECTORS ");
+    l_defines.append(std::to_string(ROC_SHADER_BONES_BLOCK_SIZE / sizeof(glm::vec4)));
+    l_defines.append("\n#define ROC_BONES_COUNT ");
+    l_defines.append(std::to_string(ROC_SHADER_BONES_BLOCK_SIZE / (Skeleton::GetPaletteVectors()*sizeof(glm::vec4))));
+    l_defines.push_back('\n');
+    switch(Skeleton::GetPalette())
+    {
+        case Skeleton::SP_Affine:
+            l_defines.append(g_BonesAffineDefines);
+            break;
+        case Skeleton::SP_DualQuat:
+            l_defines.append(g_BonesDualQuatDefines);
+            break;
+        default:
+            l_defines.append(g_BonesMatrixDefines);
+            break;
+    }
+    // Keep compiler messages pointing to lines of original file
+    l_defines.append("#line ");
+    l_defines.append(std::to_string(std::count(f_source.begin(), f_source.begin() + l_position, '\n') + 1));
+    l_defines.push_back('\n');
+    f_source.insert(l_position, l_defines);
+}
+void ROC::Shader::SetupDefaultAttributesLocations()
 {
     glBindAttribLocation(m_program, 0, "gVertexPosition");
     glBindAttribLocation(m_program, 1, "gVertexUV");
     glBindAttribLocation(m_program, 2, "gVertexNormal");
     glBindAttribLocation(m_program, 3, "gVertexWeight");
     glBindAttribLocation(m_program, 4, "gVertexIndex");
-
+    glBindAttribLocation(m_program, 5, "gInstanceMatrix"); // mat4, locations 5-8
+}
+void ROC::Shader::SetupDefaultUniformsAndLocations()
+{
     glUseProgram(m_program);
 
     //Matrices
@@ -261,6 +332,7 @@ void ROC::Shader::SetupDefaultUniformsAndLocations()
     m_materialTypeUniform = glGetUniformLocation(m_program, "gMaterialType");
     //Animation
     m_animatedUniform = glGetUniformLocation(m_program, "gAnimated");
+    m_instancedUniform = glGetUniformLocation(m_program, "gInstanced");
     unsigned int l_boneUniform = glGetUniformBlockIndex(m_program, "gBonesUniform");
     if(l_boneUniform != GL_INVALID_INDEX) glUniformBlockBinding(m_program, l_boneUniform, ROC_SHADER_BONES_BINDPOINT);
     //Samplers
@@ -432,13 +504,62 @@ void ROC::Shader::SetAnimated(unsigned int f_value)
         }
     }
 }
-void ROC::Shader::SetBoneMatrices(const std::vector<glm::mat4> &f_value)
+void ROC::Shader::SetInstanced(unsigned int f_value)
 {
+    if(m_instancedUniform != -1)
+    {
+        if(m_instancedUniformValue != f_value)
+        {
+            m_instancedUniformValue = f_value;
+            glUniform1ui(m_instancedUniform, m_instancedUniformValue);
+        }
+    }
+}
+size_t ROC::Shader::GetBonesDataStride(size_t f_count)
+{
+    size_t l_alignment = static_cast<size_t>(ms_bonesAlignment);
+    size_t l_size = std::min(f_count*sizeof(glm::vec4), static_cast<size_t>(ROC_SHADER_BONES_BLOCK_SIZE));
+    return ((l_size + l_alignment - 1U) / l_alignment)*l_alignment;
+}
+size_t ROC::Shader::GetBonesBlockSize()
+{
+    return ROC_SHADER_BONES_BLOCK_SIZE;
+}
+void* ROC::Shader::MapBonesData(size_t f_size)
+{
+    void *l_data = nullptr;
     if(ms_bonesUBO != GL_INVALID_INDEX)
     {
         if(ms_uboFix) glFinish();
-        unsigned int l_matrixCount = std::min(f_value.size(), ROC_SHADER_BONES_COUNT);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, l_matrixCount*sizeof(glm::mat4), f_value.data());
+
+        // Storage is orphaned every frame, draws of previous frames keep reading old one
+        GLsizeiptr l_size = static_cast<GLsizeiptr>(std::max(f_size, GetBonesBlockSize()));
+        if(l_size > ms_bonesUBOSize) ms_bonesUBOSize = std::max(l_size, ms_bonesUBOSize*2);
+        glBindBuffer(GL_UNIFORM_BUFFER, ms_bonesUBO);
+        glBufferData(GL_UNIFORM_BUFFER, ms_bonesUBOSize, NULL, GL_STREAM_DRAW);
+        l_data = glMapBufferRange(GL_UNIFORM_BUFFER, 0, l_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    }
+    return l_data;
+}
+void ROC::Shader::UnmapBonesData()
+{
+    if(ms_bonesUBO != GL_INVALID_INDEX)
+    {
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        ms_bonesBoundOffset = -1;
+    }
+}
+void ROC::Shader::BindBonesData(size_t f_offset)
+{
+    if(ms_bonesUBO != GL_INVALID_INDEX)
+    {
+        GLintptr l_offset = static_cast<GLintptr>(f_offset);
+        if(ms_bonesBoundOffset != l_offset)
+        {
+            // Range covers whole uniform block, buffer has tail space for last skeleton
+            glBindBufferRange(GL_UNIFORM_BUFFER, ROC_SHADER_BONES_BINDPOINT, ms_bonesUBO, l_offset, static_cast<GLsizeiptr>(GetBonesBlockSize()));
+            ms_bonesBoundOffset = l_offset;
+        }
     }
 }
 void ROC::Shader::SetTime(float f_value)
@@ -534,9 +655,14 @@ void ROC::Shader::CreateBonesUBO()
 {
     if(ms_bonesUBO == GL_INVALID_INDEX)
     {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ms_bonesAlignment);
+        if(ms_bonesAlignment <= 0) ms_bonesAlignment = 256;
+
+        ms_bonesUBOSize = static_cast<GLsizeiptr>(GetBonesBlockSize());
         glGenBuffers(1, &ms_bonesUBO);
         glBindBufferBase(GL_UNIFORM_BUFFER, ROC_SHADER_BONES_BINDPOINT, ms_bonesUBO);
-        glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) * ROC_SHADER_BONES_COUNT, NULL, GL_DYNAMIC_DRAW);
+        glBufferData(GL_UNIFORM_BUFFER, ms_bonesUBOSize, NULL, GL_STREAM_DRAW);
+        ms_bonesBoundOffset = 0;
     }
 }
 void ROC::Shader::DestroyBonesUBO()
@@ -545,6 +671,8 @@ void ROC::Shader::DestroyBonesUBO()
     {
         glDeleteBuffers(1, &ms_bonesUBO);
         ms_bonesUBO = GL_INVALID_INDEX;
+        ms_bonesUBOSize = 0;
+        ms_bonesBoundOffset = -1;
     }
 }
 void ROC::Shader::EnableUBOFix()
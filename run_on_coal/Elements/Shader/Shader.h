@@ -24,6 +24,7 @@ class Shader final : public Element
     GLint m_materialParamUniform;
     GLint m_materialTypeUniform;
     GLint m_animatedUniform;
+    GLint m_instancedUniform;
     GLint m_texture0Uniform;
     GLint m_timeUniform;
     GLint m_colorUniform;
@@ -41,6 +42,7 @@ class Shader final : public Element
     glm::vec4 m_materialParamUniformValue;
     int m_materialTypeUniformValue;
     unsigned int m_animatedUniformValue;
+    unsigned int m_instancedUniformValue;
     float m_timeUniformValue;
     glm::vec4 m_colorUniformValue;
 
@@ -58,10 +60,15 @@ class Shader final : public Element
     unsigned int m_drawableCount;
 
     static GLuint ms_bonesUBO;
+    static GLsizeiptr ms_bonesUBOSize;
+    static GLint ms_bonesAlignment;
+    static GLintptr ms_bonesBoundOffset;
     static bool ms_uboFix;
 
     std::string m_error;
 
+    static void InjectBonesDefines(std::string &f_source);
+    void SetupDefaultAttributesLocations();
     void SetupDefaultUniformsAndLocations();
 public:
     ShaderUniform* GetUniform(const std::string &f_uniform);
@@ -83,7 +90,13 @@ protected:
     void SetMaterialParam(const glm::vec4 &f_value);
     void SetMaterialType(int f_value);
     void SetAnimated(unsigned int f_value);
-    static void SetBoneMatrices(const std::vector<glm::mat4> &f_value);
+    void SetInstanced(unsigned int f_value);
+    inline bool IsInstancingSupported() const { return (m_instancedUniform != -1); }
+    static size_t GetBonesDataStride(size_t f_count);
+    static size_t GetBonesBlockSize();
+    static void* MapBonesData(size_t f_size);
+    static void UnmapBonesData();
+    static void BindBonesData(size_t f_offset);
     void SetTime(float f_value);
     void SetColor(const glm::vec4 &f_value);
 
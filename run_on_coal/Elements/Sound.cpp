@@ -9,7 +9,7 @@ extern const glm::vec3 g_DefaultPosition;
 
 }
 
-ROC::Sound::Sound(bool f_loop)
+ROC::Sound::Sound(bool f_loop, bool f_async)
 {
     m_elementType = ET_Sound;
     m_elementTypeName.assign("Sound");
@@ -18,6 +18,8 @@ ROC::Sound::Sound(bool f_loop)
     m_relative = false;
     m_looped = f_loop;
     m_mono = false;
+    m_async = f_async;
+    m_released = !m_async;
     m_v3DPosition = glm::vec3(0.f);
     m_v3DDistance = glm::vec2(0.f);
 }
@@ -47,39 +49,49 @@ bool ROC::Sound::Load(const std::string &f_path)
 
 void ROC::Sound::Play()
 {
-    m_handle->play();
+    if(IsLoaded()) m_handle->play();
 }
 void ROC::Sound::Pause()
 {
-    m_handle->pause();
+    if(IsLoaded()) m_handle->pause();
 }
 void ROC::Sound::Stop()
 {
-    m_handle->stop();
+    if(IsLoaded()) m_handle->stop();
 }
 
 void ROC::Sound::SetSpeed(float f_speed)
 {
-    btClamp(f_speed, 0.f, std::numeric_limits<float>::max());
-    m_handle->setPitch(f_speed);
+    if(IsLoaded())
+    {
+        btClamp(f_speed, 0.f, std::numeric_limits<float>::max());
+        m_handle->setPitch(f_speed);
+    }
 }
 
 void ROC::Sound::SetVolume(float f_volume)
 {
-    btClamp(f_volume, 0.f, 100.f);
-    m_handle->setVolume(f_volume);
+    if(IsLoaded())
+    {
+        btClamp(f_volume, 0.f, 100.f);
+        m_handle->setVolume(f_volume);
+    }
 }
 
 void ROC::Sound::SetTime(float f_time)
 {
-    btClamp(f_time, 0.f, std::numeric_limits<float>::max());
-    sf::Time l_time = sf::seconds(f_time);
-    m_handle->setPlayingOffset(l_time);
+    if(IsLoaded())
+    {
+        btClamp(f_time, 0.f, std::numeric_limits<float>::max());
+        sf::Time l_time = sf::seconds(f_time);
+        m_handle->setPlayingOffset(l_time);
+    }
 }
 
 bool ROC::Sound::Set3DPositionEnabled(bool f_state)
 {
-    if(m_mono)
+    bool l_result = (IsLoaded() && m_mono);
+    if(l_result)
     {
         if(m_relative != f_state)
         {
@@ -98,7 +110,7 @@ bool ROC::Sound::Set3DPositionEnabled(bool f_state)
             }
         }
     }
-    return m_mono;
+    return l_result;
 }
 
 bool ROC::Sound::Set3DPosition(const glm::vec3 &f_pos)
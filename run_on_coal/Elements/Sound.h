@@ -11,25 +11,28 @@ class Sound final : public Element
     bool m_relative;
     bool m_looped;
     bool m_mono;
+    bool m_async;
+    bool m_released;
 
     glm::vec3 m_v3DPosition;
     glm::vec2 m_v3DDistance;
 public:
+    inline bool IsLoaded() const { return (m_released && m_handle); }
     inline bool IsLooped() const { return m_looped; }
-    inline float GetDuration() const { return (m_handle ? m_handle->getDuration().asSeconds() : -1.f); }
+    inline float GetDuration() const { return (IsLoaded() ? m_handle->getDuration().asSeconds() : -1.f); }
 
     void Play();
     void Pause();
     void Stop();
 
     void SetSpeed(float f_speed);
-    inline float GetSpeed() const { return (m_handle ? m_handle->getPitch() : -1.f); }
+    inline float GetSpeed() const { return (IsLoaded() ? m_handle->getPitch() : -1.f); }
 
     void SetVolume(float f_volume);
-    inline float GetVolume() const { return (m_handle ? m_handle->getVolume() : -1.f); }
+    inline float GetVolume() const { return (IsLoaded() ? m_handle->getVolume() : -1.f); }
 
     void SetTime(float f_time);
-    inline float GetTime() const { return (m_handle ? m_handle->getPlayingOffset().asSeconds() : -1.f); }
+    inline float GetTime() const { return (IsLoaded() ? m_handle->getPlayingOffset().asSeconds() : -1.f); }
 
     bool Set3DPositionEnabled(bool f_state);
     inline bool Get3DPositionEnabled() const { return m_relative; }
@@ -40,12 +43,17 @@ public:
     bool Set3DDistance(const glm::vec2 &f_dist);
     inline const glm::vec2& Get3DDistance(glm::vec2 &f_dist) const { return m_v3DDistance; }
 
-    inline int GetState() const { return (m_handle ? m_handle->getStatus() : -1); }
+    inline int GetState() const { return (IsLoaded() ? m_handle->getStatus() : -1); }
 protected:
-    explicit Sound(bool f_loop);
+    Sound(bool f_loop, bool f_async);
     ~Sound();
     bool Load(const std::string &f_path);
 
+    inline bool IsAsyncLoad() const { return m_async; }
+    inline bool IsReleased() const { return m_released; }
+    inline void SetReleased() { m_released = true; }
+
+    friend class AsyncManager;
     friend class ElementManager;
 };
 
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 
 #include "Elements/Texture.h"
+#include "Utils/TextureUtils.h"
 
 namespace ROC
 {
@@ -15,7 +16,11 @@ const glm::ivec2 g_TextureDummySize(2, 2);
 
 }
 
-ROC::Texture::Texture()
+GLuint ROC::Texture::ms_dummyTexture = 0U;
+bool ROC::Texture::ms_mipmaps = true;
+float ROC::Texture::ms_anisotropy = 1.f;
+
+ROC::Texture::Texture(bool f_async)
 {
     m_elementType = ET_Texture;
     m_elementTypeName.assign("Texture");
@@ -23,52 +28,244 @@ ROC::Texture::Texture()
     m_type = TT_None;
     m_filtering = DFT_None;
     m_texture = 0U;
+    m_compress = false;
+
+    m_image = nullptr;
+    m_pixelBuffer = 0U;
+    m_streamedRows = 0;
+    m_async = f_async;
+    m_released = !m_async;
+
+    m_compressedImage = nullptr;
+    m_streamedLevels = 0U;
+    m_memorySize = 0U;
+    m_cached = false;
 }
 ROC::Texture::~Texture()
 {
-    if(m_texture) glDeleteTextures(1, &m_texture);
+    if(m_texture)
+    {
+        if(m_texture == ms_dummyTexture) ms_dummyTexture = 0U;
+        glDeleteTextures(1, &m_texture);
+    }
+    if(m_pixelBuffer != 0U) glDeleteBuffers(1, &m_pixelBuffer);
+    delete m_image;
+    delete m_compressedImage;
 }
 
 bool ROC::Texture::Load(const std::string &f_path, int f_type, int f_filter, bool f_compress)
 {
-    if(m_texture == 0U)
+    return (Decode(f_path, f_type, f_filter, f_compress) && Upload());
+}
+bool ROC::Texture::Decode(const std::string &f_path, int f_type, int f_filter, bool f_compress)
+{
+    bool l_result = false;
+    if((m_texture == 0U) && !m_image && !m_compressedImage)
     {
-        sf::Image l_image;
-        if(l_image.loadFromFile(f_path))
+        // No GL calls here, safe to run on loader threads
+        if(TextureUtils::IsCompressedContainer(f_path))
         {
-            sf::Vector2u l_imageSize = l_image.getSize();
-            m_size.x = static_cast<int>(l_imageSize.x);
-            m_size.y = static_cast<int>(l_imageSize.y);
+            m_compressedImage = new TextureUtils::CompressedImage();
+            if(TextureUtils::LoadCompressedImage(f_path, *m_compressedImage))
+            {
+                if(!ms_mipmaps)
+                {
+                    // Only base level is uploaded, first level always starts at data beginning
+                    m_compressedImage->m_levels.resize(1U);
+                    m_compressedImage->m_data.resize(m_compressedImage->m_levels.front().m_size);
+                }
+                m_size.x = m_compressedImage->m_width;
+                m_size.y = m_compressedImage->m_height;
 
-            m_type = f_type;
-            btClamp(m_type, static_cast<int>(TT_RGB), static_cast<int>(TT_RGBA));
-            m_filtering = f_filter;
-            btClamp(m_filtering, static_cast<int>(DFT_Nearest), static_cast<int>(DFT_Linear));
+                m_type = f_type;
+                btClamp(m_type, static_cast<int>(TT_RGB), static_cast<int>(TT_RGBA));
+                m_filtering = f_filter;
+                btClamp(m_filtering, static_cast<int>(DFT_Nearest), static_cast<int>(DFT_Linear));
+                m_compress = true;
+                l_result = true;
+            }
+            else
+            {
+                delete m_compressedImage;
+                m_compressedImage = nullptr;
+            }
+        }
+        else
+        {
+            m_image = new sf::Image();
+            if(m_image->loadFromFile(f_path))
+            {
+                sf::Vector2u l_imageSize = m_image->getSize();
+                m_size.x = static_cast<int>(l_imageSize.x);
+                m_size.y = static_cast<int>(l_imageSize.y);
 
+                m_type = f_type;
+                btClamp(m_type, static_cast<int>(TT_RGB), static_cast<int>(TT_RGBA));
+                m_filtering = f_filter;
+                btClamp(m_filtering, static_cast<int>(DFT_Nearest), static_cast<int>(DFT_Linear));
+                m_compress = f_compress;
+                l_result = true;
+            }
+            else
+            {
+                delete m_image;
+                m_image = nullptr;
+            }
+        }
+    }
+    return l_result;
+}
+bool ROC::Texture::Upload()
+{
+    if(m_texture == 0U)
+    {
+        if(m_compressedImage)
+        {
+            size_t l_budget = std::numeric_limits<size_t>::max();
+            StreamCompressed(l_budget);
+        }
+        else if(m_image)
+        {
+            // Driver side compression doesn't support mipmaps generation
+            bool l_mipmaps = (ms_mipmaps && !m_compress);
             glGenTextures(1, &m_texture);
             glBindTexture(GL_TEXTURE_2D, m_texture);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST + m_filtering);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST + m_filtering);
-            glTexImage2D(GL_TEXTURE_2D, 0, (f_type == TT_RGB) ? (f_compress ? GL_COMPRESSED_RGB : GL_RGB) : (f_compress ? GL_COMPRESSED_RGBA : GL_RGBA), m_size.x, m_size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, l_image.getPixelsPtr());
+            SetupSampling(GL_TEXTURE_2D, l_mipmaps);
+            glTexImage2D(GL_TEXTURE_2D, 0, (m_type == TT_RGB) ? (m_compress ? GL_COMPRESSED_RGB : GL_RGB) : (m_compress ? GL_COMPRESSED_RGBA : GL_RGBA), m_size.x, m_size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_image->getPixelsPtr());
+            if(l_mipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+            m_memorySize = EstimateMemorySize(l_mipmaps);
+
+            delete m_image;
+            m_image = nullptr;
         }
     }
     return (m_texture != 0U);
 }
+bool ROC::Texture::Stream(size_t &f_budget)
+{
+    if(m_compressedImage) StreamCompressed(f_budget);
+    else if(m_image)
+    {
+        GLenum l_format = (m_type == TT_RGB) ? (m_compress ? GL_COMPRESSED_RGB : GL_RGB) : (m_compress ? GL_COMPRESSED_RGBA : GL_RGBA);
+        size_t l_rowSize = static_cast<size_t>(m_size.x)*4U;
+        bool l_mipmaps = (ms_mipmaps && !m_compress);
+        if(m_texture == 0U)
+        {
+            glGenTextures(1, &m_texture);
+            glBindTexture(GL_TEXTURE_2D, m_texture);
+            SetupSampling(GL_TEXTURE_2D, l_mipmaps);
+            m_memorySize = EstimateMemorySize(l_mipmaps);
+            if(m_compress)
+            {
+                // Generic compressed formats can't be updated partially
+                glTexImage2D(GL_TEXTURE_2D, 0, l_format, m_size.x, m_size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_image->getPixelsPtr());
+                m_streamedRows = m_size.y;
+                f_budget -= std::min(f_budget, l_rowSize*static_cast<size_t>(m_size.y));
+            }
+            else
+            {
+                glTexImage2D(GL_TEXTURE_2D, 0, l_format, m_size.x, m_size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+                glGenBuffers(1, &m_pixelBuffer);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+                glBufferData(GL_PIXEL_UNPACK_BUFFER, l_rowSize*static_cast<size_t>(m_size.y), NULL, GL_STREAM_DRAW);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0U);
+            }
+        }
+
+        if(m_streamedRows < m_size.y)
+        {
+            // At least one row per call, budget only limits band height
+            int l_rows = static_cast<int>(std::max(f_budget / std::max(l_rowSize, static_cast<size_t>(1U)), static_cast<size_t>(1U)));
+            l_rows = std::min(l_rows, m_size.y - m_streamedRows);
+            size_t l_offset = static_cast<size_t>(m_streamedRows)*l_rowSize;
+            size_t l_size = static_cast<size_t>(l_rows)*l_rowSize;
+
+            glBindTexture(GL_TEXTURE_2D, m_texture);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+            void *l_target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, l_offset, l_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if(l_target)
+            {
+                std::memcpy(l_target, m_image->getPixelsPtr() + l_offset, l_size);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_streamedRows, m_size.x, l_rows, GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(l_offset));
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0U);
+            }
+            else
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0U);
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, m_streamedRows, m_size.x, l_rows, GL_RGBA, GL_UNSIGNED_BYTE, m_image->getPixelsPtr() + l_offset);
+            }
+            m_streamedRows += l_rows;
+            f_budget -= std::min(f_budget, l_size);
+        }
+
+        if(m_streamedRows >= m_size.y)
+        {
+            if(l_mipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+            if(m_pixelBuffer != 0U)
+            {
+                glDeleteBuffers(1, &m_pixelBuffer);
+                m_pixelBuffer = 0U;
+            }
+            delete m_image;
+            m_image = nullptr;
+        }
+    }
+    bool l_finished = (!m_image && !m_compressedImage);
+    if(l_finished) m_released = true;
+    return l_finished;
+}
+bool ROC::Texture::StreamCompressed(size_t &f_budget)
+{
+    const std::vector<TextureUtils::CompressedLevel> &l_levels = m_compressedImage->m_levels;
+    if(l_levels.empty())
+    {
+        // Nothing to upload, texture is left unloaded
+        delete m_compressedImage;
+        m_compressedImage = nullptr;
+        return false;
+    }
+
+    if(m_texture == 0U)
+    {
+        glGenTextures(1, &m_texture);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        SetupSampling(GL_TEXTURE_2D, (l_levels.size() > 1U));
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(l_levels.size() - 1U));
+        m_streamedLevels = 0U;
+        m_memorySize = m_compressedImage->m_data.size();
+    }
+    else glBindTexture(GL_TEXTURE_2D, m_texture);
+
+    // Levels can't be split, at least one is uploaded per call
+    do
+    {
+        const TextureUtils::CompressedLevel &l_level = l_levels[m_streamedLevels];
+        glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(m_streamedLevels), m_compressedImage->m_format, l_level.m_width, l_level.m_height, 0, static_cast<GLsizei>(l_level.m_size), m_compressedImage->m_data.data() + l_level.m_offset);
+        f_budget -= std::min(f_budget, l_level.m_size);
+        m_streamedLevels++;
+    } while((m_streamedLevels < l_levels.size()) && (f_budget > 0U));
+
+    if(m_streamedLevels >= l_levels.size())
+    {
+        delete m_compressedImage;
+        m_compressedImage = nullptr;
+    }
+    return !m_compressedImage;
+}
 bool ROC::Texture::LoadCubemap(const std::vector<std::string> &f_path, int f_filter, bool f_compress)
 {
     if(m_texture == 0U)
     {
         m_type = TT_Cubemap;
+        m_filtering = f_filter;
         btClamp(m_filtering, static_cast<int>(DFT_Nearest), static_cast<int>(DFT_Linear));
+        m_compress = f_compress;
+        bool l_mipmaps = (ms_mipmaps && !m_compress);
 
         glGenTextures(1, &m_texture);
         glBindTexture(GL_TEXTURE_CUBE_MAP, m_texture);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST + m_filtering);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST + m_filtering);
+        SetupSampling(GL_TEXTURE_CUBE_MAP, l_mipmaps);
 
         for(size_t i = 0, j = std::min(6U, f_path.size()); i < j; i++)
         {
@@ -76,6 +273,8 @@ bool ROC::Texture::LoadCubemap(const std::vector<std::string> &f_path, int f_fil
             if(l_image.loadFromFile(f_path[i]))
             {
                 sf::Vector2u l_imageSize = l_image.getSize();
+                m_size.x = static_cast<int>(l_imageSize.x);
+                m_size.y = static_cast<int>(l_imageSize.y);
                 glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, f_compress ? GL_COMPRESSED_RGB : GL_RGB, l_imageSize.x, l_imageSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, l_image.getPixelsPtr());
             }
             else
@@ -87,6 +286,11 @@ bool ROC::Texture::LoadCubemap(const std::vector<std::string> &f_path, int f_fil
                 break;
             }
         }
+        if(m_texture != 0U)
+        {
+            if(l_mipmaps) glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+            m_memorySize = EstimateMemorySize(l_mipmaps);
+        }
     }
     return (m_texture != 0U);
 }
@@ -105,13 +309,55 @@ bool ROC::Texture::LoadDummy()
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB, g_TextureDummySize.x, g_TextureDummySize.y, 0, GL_RGB, GL_UNSIGNED_BYTE, g_TextureDummyPattern);
+
+        // Shown by textures that are still loading
+        if(ms_dummyTexture == 0U) ms_dummyTexture = m_texture;
     }
     return (m_texture != 0U);
 }
 
+void ROC::Texture::SetupSampling(GLenum f_target, bool f_mipmaps)
+{
+    glTexParameteri(f_target, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(f_target, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(f_target, GL_TEXTURE_MAG_FILTER, GL_NEAREST + m_filtering);
+    if(f_mipmaps)
+    {
+        glTexParameteri(f_target, GL_TEXTURE_MIN_FILTER, (m_filtering == DFT_Linear) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST);
+        if(ms_anisotropy > 1.f) glTexParameterf(f_target, GL_TEXTURE_MAX_ANISOTROPY_EXT, ms_anisotropy);
+    }
+    else
+    {
+        glTexParameteri(f_target, GL_TEXTURE_MIN_FILTER, GL_NEAREST + m_filtering);
+        glTexParameteri(f_target, GL_TEXTURE_MAX_LEVEL, 0);
+    }
+}
+size_t ROC::Texture::EstimateMemorySize(bool f_mipmaps) const
+{
+    // Generic compressed formats take about a quarter of RGBA, mip chain adds a third
+    size_t l_size = static_cast<size_t>(m_size.x)*static_cast<size_t>(m_size.y)*4U;
+    if(m_compress) l_size /= 4U;
+    if(f_mipmaps) l_size += l_size / 3U;
+    if(IsCubic()) l_size *= 6U;
+    return l_size;
+}
+
+void ROC::Texture::SetSampling(bool f_mipmaps, float f_anisotropy)
+{
+    ms_mipmaps = f_mipmaps;
+    ms_anisotropy = 1.f;
+    if(GLEW_EXT_texture_filter_anisotropic)
+    {
+        float l_maxAnisotropy = 1.f;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &l_maxAnisotropy);
+        ms_anisotropy = glm::clamp(f_anisotropy, 1.f, l_maxAnisotropy);
+    }
+}
+
 void ROC::Texture::Bind()
 {
-    if(m_texture != 0U)
+    if(!IsLoaded()) glBindTexture(GL_TEXTURE_2D, ms_dummyTexture);
+    else
     {
         switch(m_type)
         {
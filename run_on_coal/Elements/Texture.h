@@ -1,6 +1,11 @@
 #pragma once
 #include "Elements/Drawable.h"
 
+namespace TextureUtils
+{
+struct CompressedImage;
+}
+
 namespace ROC
 {
 
@@ -9,6 +14,30 @@ class Texture final : public Drawable
     int m_type;
     glm::ivec2 m_size;
     GLuint m_texture;
+    bool m_compress;
+
+    // Async textures are decoded on loader threads and streamed in row bands through pixel buffer
+    sf::Image *m_image;
+    GLuint m_pixelBuffer;
+    int m_streamedRows;
+    bool m_async;
+    bool m_released;
+
+    // Precompressed DDS/KTX levels are uploaded as is, one level at least per stream call
+    TextureUtils::CompressedImage *m_compressedImage;
+    size_t m_streamedLevels;
+    size_t m_memorySize;
+
+    // Shared through element manager texture cache
+    bool m_cached;
+
+    static GLuint ms_dummyTexture;
+    static bool ms_mipmaps;
+    static float ms_anisotropy;
+
+    void SetupSampling(GLenum f_target, bool f_mipmaps);
+    bool StreamCompressed(size_t &f_budget);
+    size_t EstimateMemorySize(bool f_mipmaps) const;
 public:
     enum TextureType
     {
@@ -20,19 +49,33 @@ public:
 
     inline bool IsTransparent() const { return (m_type == TT_RGBA); }
     inline bool IsCubic() const { return (m_type == TT_Cubemap); }
+    inline bool IsLoaded() const { return ((m_texture != 0U) && !m_image && !m_compressedImage); }
 
     inline const glm::ivec2& GetSize() const { return m_size; }
 protected:
-    Texture();
+    explicit Texture(bool f_async = false);
     ~Texture();
     bool Load(const std::string &f_path, int f_type, int f_filter = DFT_Nearest, bool f_compress = false);
+    bool Decode(const std::string &f_path, int f_type, int f_filter = DFT_Nearest, bool f_compress = false);
+    bool Upload();
+    bool Stream(size_t &f_budget);
     bool LoadCubemap(const std::vector<std::string> &f_path, int f_filter = DFT_Nearest, bool f_compress = false);
     bool LoadDummy();
 
-    inline GLuint GetTextureID() const { return m_texture; }
+    inline bool IsAsyncLoad() const { return m_async; }
+    inline bool IsReleased() const { return m_released; }
+
+    inline bool IsCached() const { return m_cached; }
+    inline void SetCached(bool f_cached) { m_cached = f_cached; }
+    inline size_t GetMemorySize() const { return ((m_texture != 0U) ? m_memorySize : 0U); }
+
+    inline GLuint GetTextureID() const { return (IsLoaded() ? m_texture : ms_dummyTexture); }
 
     void Bind();
 
+    static void SetSampling(bool f_mipmaps, float f_anisotropy);
+
+    friend class AsyncManager;
     friend class ElementManager;
     friend class Material;
     friend class RenderManager;
@@ -206,6 +206,12 @@ bool ROC::ArgReader::IsNextUserdata()
     if(!m_hasErrors && (m_argCurrent <= m_argCount)) l_result = (lua_isuserdata(m_vm, m_argCurrent) == 1);
     return l_result;
 }
+bool ROC::ArgReader::IsNextTable()
+{
+    bool l_result = false;
+    if(!m_hasErrors && (m_argCurrent <= m_argCount)) l_result = lua_istable(m_vm, m_argCurrent);
+    return l_result;
+}
 
 void ROC::ArgReader::ReadNextBoolean(bool &f_val)
 {
@@ -359,6 +365,16 @@ void ROC::ArgReader::RemoveReference(const LuaFunction &f_func)
     if(f_func.m_removeRef && (f_func.m_ref != 0)) luaL_unref(m_vm, LUA_REGISTRYINDEX, f_func.m_ref);
 }
 
+void ROC::ArgReader::SetError(const std::string &f_error)
+{
+    // Last read argument has valid type, but its content is rejected by caller
+    if(!m_hasErrors)
+    {
+        m_error.assign(f_error);
+        m_hasErrors = true;
+        if(m_argCurrent > 1) m_argCurrent--;
+    }
+}
 bool ROC::ArgReader::HasErrors()
 {
     if(m_hasErrors)
@@ -33,6 +33,7 @@ public:
     template<class T> void ReadElement(T *&f_element);
     void ReadCustomData(CustomData &f_data);
     void ReadQuat(Quat *&f_quat);
+    template<typename T> void ReadNumberTable(std::vector<T> &f_vec);
 
     bool IsNextBoolean();
     bool IsNextNumber();
@@ -40,6 +41,7 @@ public:
     bool IsNextText();
     bool IsNextFunction();
     bool IsNextUserdata();
+    bool IsNextTable();
 
     void ReadNextBoolean(bool &f_val);
     template<typename T> void ReadNextNumber(T &f_val);
@@ -56,9 +58,12 @@ public:
     void PushElement(void *f_ptr, const std::string &f_name);
     void PushCustomData(const CustomData &f_data);
     void PushQuat(const Quat &f_quat);
+    template<class T> void PushElementTable(const std::vector<T*> &f_elements);
 
     void RemoveReference(const LuaFunction &f_func);
 
+    void SetError(const std::string &f_error);
+
     bool HasErrors();
     inline int GetReturnValue() const { return m_returnCount; }
 };
@@ -152,6 +157,52 @@ template<class T> void ROC::ArgReader::ReadElement(T *&f_element)
     }
 }
 
+template<typename T> void ROC::ArgReader::ReadNumberTable(std::vector<T> &f_vec)
+{
+    if(!m_hasErrors)
+    {
+        if(m_argCurrent <= m_argCount)
+        {
+            if(lua_istable(m_vm, m_argCurrent))
+            {
+                size_t l_length = lua_rawlen(m_vm, m_argCurrent);
+                f_vec.reserve(f_vec.size() + l_length);
+                for(size_t i = 1U; (i <= l_length) && !m_hasErrors; i++)
+                {
+                    lua_rawgeti(m_vm, m_argCurrent, static_cast<lua_Integer>(i));
+                    if(lua_isnumber(m_vm, -1))
+                    {
+                        lua_Number l_number = lua_tonumber(m_vm, -1);
+                        if(std::isnan(l_number) || std::isinf(l_number))
+                        {
+                            m_error.assign("Got NaN/Inf in table");
+                            m_hasErrors = true;
+                        }
+                        else f_vec.push_back(static_cast<T>(l_number));
+                    }
+                    else
+                    {
+                        m_error.assign("Expected number in table");
+                        m_hasErrors = true;
+                    }
+                    lua_pop(m_vm, 1);
+                }
+                if(!m_hasErrors) m_argCurrent++;
+            }
+            else
+            {
+                m_error.assign("Expected table");
+                m_hasErrors = true;
+            }
+        }
+        else
+        {
+            m_error.assign("Not enough arguments");
+            m_hasErrors = true;
+        }
+    }
+}
+
 template<typename T> void ROC::ArgReader::ReadNextNumber(T &f_val)
 {
     if(!m_hasErrors && (m_argCurrent <= m_argCount))
@@ -180,3 +231,14 @@ template<class T> void ROC::ArgReader::ReadNextElement(T *&f_element)
         }
     }
 }
+template<class T> void ROC::ArgReader::PushElementTable(const std::vector<T*> &f_elements)
+{
+    lua_createtable(m_vm, static_cast<int>(f_elements.size()), 0);
+    for(size_t i = 0U, j = f_elements.size(); i < j; i++)
+    {
+        f_elements[i] ? PushElement(f_elements[i]) : PushBoolean(false);
+        lua_rawseti(m_vm, -2, static_cast<lua_Integer>(i + 1U));
+        m_returnCount--;
+    }
+    m_returnCount++;
+}
@@ -22,13 +22,17 @@ void ROC::LuaAnimationDef::Init(lua_State *f_vm)
 
 int ROC::LuaAnimationDef::Create(lua_State *f_vm)
 {
-    // element Animation(str path)
+    // element Animation(str path [, bool async = false, float priority = 0])
     std::string l_path;
+    bool l_async = false;
+    float l_priority = 0.f;
     ArgReader argStream(f_vm);
     argStream.ReadText(l_path);
+    argStream.ReadNextBoolean(l_async);
+    argStream.ReadNextNumber(l_priority);
     if(!argStream.HasErrors() && !l_path.empty())
     {
-        Animation *l_anim = ROC::LuaManager::GetCore()->GetElementManager()->CreateAnimation(l_path);
+        Animation *l_anim = ROC::LuaManager::GetCore()->GetElementManager()->CreateAnimation(l_path, l_async, l_priority);
         l_anim ? argStream.PushElement(l_anim) : argStream.PushBoolean(false);
     }
     else argStream.PushBoolean(false);
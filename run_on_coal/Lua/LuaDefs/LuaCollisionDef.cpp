@@ -18,10 +18,7 @@
 namespace ROC
 {
 
-const std::vector<std::string> g_CollisionTypesTable
-{
-    "sphere", "box", "cylinder", "capsule", "cone"
-};
+extern const std::vector<std::string> g_CollisionTypesTable;
 const std::vector<std::string> g_CollisionMotionTypesTable
 {
     "default", "static", "kinematic"
@@ -30,21 +30,25 @@ void ROC::LuaFontDef::Init(lua_State *f_vm)
 
 int ROC::LuaFontDef::Create(lua_State *f_vm)
 {
-    // element Font(str path, int size [, int atlasX = 256, int atlasY = 256, str filtering = "nearest"])
+    // element Font(str path, int size [, int atlasX = 256, int atlasY = 256, str filtering = "nearest", bool async = false, float priority = 0])
     std::string l_path;
     int l_size;
     glm::ivec2 l_atlasSize(ROC_FONT_ATLAS_SIZE);
     std::string l_filter;
+    bool l_async = false;
+    float l_priority = 0.f;
     ArgReader argStream(f_vm);
     argStream.ReadText(l_path);
     argStream.ReadInteger(l_size);
     argStream.ReadNextInteger(l_atlasSize.x);
     argStream.ReadNextInteger(l_atlasSize.y);
     argStream.ReadNextText(l_filter);
+    argStream.ReadNextBoolean(l_async);
+    argStream.ReadNextNumber(l_priority);
     if(!argStream.HasErrors() && !l_path.empty() && l_size > 0)
     {
         int l_filteringType = EnumUtils::ReadEnumVector(l_filter, g_FilteringTypesTable);
-        Font *l_font = LuaManager::GetCore()->GetElementManager()->CreateFont_(l_path, l_size, l_atlasSize, l_filteringType);
+        Font *l_font = LuaManager::GetCore()->GetElementManager()->CreateFont_(l_path, l_size, l_atlasSize, l_filteringType, l_async, l_priority);
         l_font ? argStream.PushElement(l_font) : argStream.PushBoolean(false);
     }
     else argStream.PushBoolean(false);
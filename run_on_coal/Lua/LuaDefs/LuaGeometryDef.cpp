@@ -15,6 +15,8 @@ void ROC::LuaGeometryDef::Init(lua_State *f_vm)
 {
     LuaUtils::AddClass(f_vm, "Geometry", Create);
     LuaUtils::AddClassMethod(f_vm, "getBoundSphereRadius", GetBoundSphereRadius);
+    LuaUtils::AddClassMethod(f_vm, "getBoundSphereCenter", GetBoundSphereCenter);
+    LuaUtils::AddClassMethod(f_vm, "getBoundBox", GetBoundBox);
     LuaUtils::AddClassMethod(f_vm, "isLoaded", IsLoaded);
     LuaElementDef::AddHierarchyMethods(f_vm);
     LuaUtils::AddClassFinish(f_vm);
@@ -22,15 +24,17 @@ void ROC::LuaGeometryDef::Init(lua_State *f_vm)
 
 int ROC::LuaGeometryDef::Create(lua_State *f_vm)
 {
-    // element Geometry(bool path [, bool async = false])
+    // element Geometry(str path [, bool async = false, float priority = 0])
     std::string l_path;
     bool l_async = false;
+    float l_priority = 0.f;
     ArgReader argStream(f_vm);
     argStream.ReadText(l_path);
     argStream.ReadNextBoolean(l_async);
+    argStream.ReadNextNumber(l_priority);
     if(!argStream.HasErrors() && !l_path.empty())
     {
-        Geometry *l_geometry = LuaManager::GetCore()->GetElementManager()->CreateGeometry(l_path,l_async);
+        Geometry *l_geometry = LuaManager::GetCore()->GetElementManager()->CreateGeometry(l_path, l_async, l_priority);
         l_geometry ? argStream.PushElement(l_geometry) : argStream.PushBoolean(false);
     }
     else argStream.PushBoolean(false);
@@ -56,3 +60,33 @@ int ROC::LuaGeometryDef::GetBoundSphereRadius(lua_State *f_vm)
     !argStream.HasErrors() ? argStream.PushNumber(l_geometry->GetBoundSphereRadius()) : argStream.PushBoolean(false);
     return argStream.GetReturnValue();
 }
+int ROC::LuaGeometryDef::GetBoundSphereCenter(lua_State *f_vm)
+{
+    // float float float Geometry:getBoundSphereCenter()
+    Geometry *l_geometry;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_geometry);
+    if(!argStream.HasErrors())
+    {
+        const glm::vec3 &l_center = l_geometry->GetBoundSphereCenter();
+        for(int i = 0; i < 3; i++) argStream.PushNumber(l_center[i]);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaGeometryDef::GetBoundBox(lua_State *f_vm)
+{
+    // float float float float float float Geometry:getBoundBox()
+    Geometry *l_geometry;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_geometry);
+    if(!argStream.HasErrors())
+    {
+        const glm::vec3 &l_min = l_geometry->GetBoundMin();
+        const glm::vec3 &l_max = l_geometry->GetBoundMax();
+        for(int i = 0; i < 3; i++) argStream.PushNumber(l_min[i]);
+        for(int i = 0; i < 3; i++) argStream.PushNumber(l_max[i]);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
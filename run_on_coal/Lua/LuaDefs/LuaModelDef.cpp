@@ -12,6 +12,7 @@
 #include "Managers/PreRenderManager.h"
 #include "Managers/RenderManager/RenderManager.h"
 #include "Elements/Animation/Animation.h"
+#include "Elements/Camera.h"
 #include "Elements/Collision.h"
 #include "Elements/Geometry/Geometry.h"
 #include "Elements/Model/AnimationController.h"
@@ -24,13 +25,19 @@
 #define ROC_MODEL_ANIMPROPERTY_SPEED 0
 #define ROC_MODEL_ANIMPROPERTY_PROGRESS 1
 #define ROC_MODEL_ANIMPROPERTY_BLENDTIME 2
+#define ROC_MODEL_ANIMPROPERTY_WEIGHT 3
+#define ROC_MODEL_ANIMPROPERTY_ADDITIVE 4
 
 namespace ROC
 {
 
 const std::vector<std::string> g_AnimationPropertiesTable
 {
-    "speed", "progress", "blendTime"
+    "speed", "progress", "blendTime", "weight", "additive"
+};
+const std::vector<std::string> g_AnimationLODTable
+{
+    "auto", "full", "half", "quarter", "frozen"
 };
 
 }
@@ -58,10 +65,18 @@ void ROC::LuaModelDef::Init(lua_State *f_vm)
     LuaUtils::AddClassMethod(f_vm, "resetAnimation", ResetAnimation);
     LuaUtils::AddClassMethod(f_vm, "setAnimationProperty", SetAnimationProperty);
     LuaUtils::AddClassMethod(f_vm, "getAnimationProperty", GetAnimationProperty);
+    LuaUtils::AddClassMethod(f_vm, "setAnimationBoneMask", SetAnimationBoneMask);
+    LuaUtils::AddClassMethod(f_vm, "resetAnimationBoneMask", ResetAnimationBoneMask);
+    LuaUtils::AddClassMethod(f_vm, "setAnimationLOD", SetAnimationLOD);
+    LuaUtils::AddClassMethod(f_vm, "getAnimationLOD", GetAnimationLOD);
     LuaUtils::AddClassMethod(f_vm, "getCollision", GetCollision);
     LuaUtils::AddClassMethod(f_vm, "setCollidable", SetCollidable);
     LuaElementDef::AddHierarchyMethods(f_vm);
     LuaUtils::AddClassFinish(f_vm);
+
+    lua_register(f_vm, "getModelsInFrustum", GetModelsInFrustum);
+    lua_register(f_vm, "getModelsInRadius", GetModelsInRadius);
+    lua_register(f_vm, "getModelsInBox", GetModelsInBox);
 }
 
 int ROC::LuaModelDef::Create(lua_State *f_vm)
@@ -304,15 +319,17 @@ int ROC::LuaModelDef::GetParent(lua_State *f_vm)
 
 int ROC::LuaModelDef::SetAnimation(lua_State *f_vm)
 {
-    // bool Model:setAnimation(element animation)
+    // bool Model:setAnimation(element animation [, int layer = 0])
     Model *l_model;
     Animation *l_anim;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
     argStream.ReadElement(l_anim);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors())
     {
-        bool l_result = LuaManager::GetCore()->GetInheritManager()->SetModelAnimation(l_model, l_anim);
+        bool l_result = LuaManager::GetCore()->GetInheritManager()->SetModelAnimation(l_model, l_anim, l_layer);
         argStream.PushBoolean(l_result);
     }
     else argStream.PushBoolean(false);
@@ -320,13 +337,15 @@ int ROC::LuaModelDef::SetAnimation(lua_State *f_vm)
 }
 int ROC::LuaModelDef::GetAnimation(lua_State *f_vm)
 {
-    // element Model:getAnimation()
+    // element Model:getAnimation([int layer = 0])
     Model *l_model;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors())
     {
-        Animation *l_anim = l_model->GetAnimationController()->GetAnimation();
+        Animation *l_anim = l_model->GetAnimationController()->GetAnimation(l_layer);
         l_anim ? argStream.PushElement(l_anim) : argStream.PushBoolean(false);
     }
     else argStream.PushBoolean(false);
@@ -334,13 +353,15 @@ int ROC::LuaModelDef::GetAnimation(lua_State *f_vm)
 }
 int ROC::LuaModelDef::RemoveAnimation(lua_State *f_vm)
 {
-    // bool Model:removeAnimation()
+    // bool Model:removeAnimation([int layer = 0])
     Model *l_model;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors())
     {
-        bool l_result = LuaManager::GetCore()->GetInheritManager()->RemoveModelAnimation(l_model);
+        bool l_result = LuaManager::GetCore()->GetInheritManager()->RemoveModelAnimation(l_model, l_layer);
         argStream.PushBoolean(l_result);
     }
     else argStream.PushBoolean(false);
@@ -348,13 +369,15 @@ int ROC::LuaModelDef::RemoveAnimation(lua_State *f_vm)
 }
 int ROC::LuaModelDef::PlayAnimation(lua_State *f_vm)
 {
-    // bool Model:playAnimation()
+    // bool Model:playAnimation([int layer = 0])
     Model *l_model;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors())
     {
-        bool l_result = l_model->GetAnimationController()->Play();
+        bool l_result = l_model->GetAnimationController()->Play(l_layer);
         argStream.PushBoolean(l_result);
     }
     else argStream.PushBoolean(false);
@@ -362,13 +385,15 @@ int ROC::LuaModelDef::PlayAnimation(lua_State *f_vm)
 }
 int ROC::LuaModelDef::PauseAnimation(lua_State *f_vm)
 {
-    // bool Model:pauseAnimation()
+    // bool Model:pauseAnimation([int layer = 0])
     Model *l_model;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors())
     {
-        bool l_result = l_model->GetAnimationController()->Pause();
+        bool l_result = l_model->GetAnimationController()->Pause(l_layer);
         argStream.PushBoolean(l_result);
     }
     else argStream.PushBoolean(false);
@@ -376,13 +401,15 @@ int ROC::LuaModelDef::PauseAnimation(lua_State *f_vm)
 }
 int ROC::LuaModelDef::ResetAnimation(lua_State *f_vm)
 {
-    // bool Model:resetAnimation()
+    // bool Model:resetAnimation([int layer = 0])
     Model *l_model;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors())
     {
-        bool l_result = l_model->GetAnimationController()->Reset();
+        bool l_result = l_model->GetAnimationController()->Reset(l_layer);
         argStream.PushBoolean(l_result);
     }
     else argStream.PushBoolean(false);
@@ -390,28 +417,36 @@ int ROC::LuaModelDef::ResetAnimation(lua_State *f_vm)
 }
 int ROC::LuaModelDef::SetAnimationProperty(lua_State *f_vm)
 {
-    // bool Model:setAnimationProperty(str property, float value)
+    // bool Model:setAnimationProperty(str property, float value [, int layer = 0])
     Model *l_model;
     std::string l_property;
     float l_value;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
     argStream.ReadText(l_property);
     argStream.ReadNumber(l_value);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors() && !l_property.empty())
     {
         bool l_result = false;
         switch(EnumUtils::ReadEnumVector(l_property, g_AnimationPropertiesTable))
         {
             case ROC_MODEL_ANIMPROPERTY_SPEED:
-                l_result = l_model->GetAnimationController()->SetSpeed(l_value);
+                l_result = l_model->GetAnimationController()->SetSpeed(l_value, l_layer);
                 break;
             case ROC_MODEL_ANIMPROPERTY_PROGRESS:
-                l_result = l_model->GetAnimationController()->SetProgress(l_value);
+                l_result = l_model->GetAnimationController()->SetProgress(l_value, l_layer);
                 break;
             case ROC_MODEL_ANIMPROPERTY_BLENDTIME:
                 l_model->GetAnimationController()->SetBlendTime(static_cast<unsigned int>(l_value));
                 break;
+            case ROC_MODEL_ANIMPROPERTY_WEIGHT:
+                l_result = l_model->GetAnimationController()->SetWeight(l_value, l_layer);
+                break;
+            case ROC_MODEL_ANIMPROPERTY_ADDITIVE:
+                l_result = l_model->GetAnimationController()->SetAdditive(l_value != 0.f, l_layer);
+                break;
         }
         argStream.PushBoolean(l_result);
     }
@@ -420,32 +455,107 @@ int ROC::LuaModelDef::SetAnimationProperty(lua_State *f_vm)
 }
 int ROC::LuaModelDef::GetAnimationProperty(lua_State *f_vm)
 {
-    // float Model:getAnimationProperty(str property)
+    // float Model:getAnimationProperty(str property [, int layer = 0])
     Model *l_model;
     std::string l_property;
+    unsigned int l_layer = 0U;
     ArgReader argStream(f_vm);
     argStream.ReadElement(l_model);
     argStream.ReadText(l_property);
+    argStream.ReadNextInteger(l_layer);
     if(!argStream.HasErrors() && !l_property.empty())
     {
         float l_value = -1.f;
         switch(EnumUtils::ReadEnumVector(l_property, g_AnimationPropertiesTable))
         {
             case ROC_MODEL_ANIMPROPERTY_SPEED:
-                l_value = l_model->GetAnimationController()->GetSpeed();
+                l_value = l_model->GetAnimationController()->GetSpeed(l_layer);
                 break;
             case ROC_MODEL_ANIMPROPERTY_PROGRESS:
-                l_value = l_model->GetAnimationController()->GetProgress();
+                l_value = l_model->GetAnimationController()->GetProgress(l_layer);
                 break;
             case ROC_MODEL_ANIMPROPERTY_BLENDTIME:
                 l_value = static_cast<float>(l_model->GetAnimationController()->GetBlendTime());
                 break;
+            case ROC_MODEL_ANIMPROPERTY_WEIGHT:
+                l_value = l_model->GetAnimationController()->GetWeight(l_layer);
+                break;
+            case ROC_MODEL_ANIMPROPERTY_ADDITIVE:
+                l_value = (l_model->GetAnimationController()->IsAdditive(l_layer) ? 1.f : 0.f);
+                break;
         }
         argStream.PushNumber(l_value);
     }
     else argStream.PushBoolean(false);
     return argStream.GetReturnValue();
 }
+int ROC::LuaModelDef::SetAnimationBoneMask(lua_State *f_vm)
+{
+    // bool Model:setAnimationBoneMask(int layer, int bone, float weight)
+    Model *l_model;
+    unsigned int l_layer;
+    unsigned int l_bone;
+    float l_weight;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_model);
+    argStream.ReadInteger(l_layer);
+    argStream.ReadInteger(l_bone);
+    argStream.ReadNumber(l_weight);
+    if(!argStream.HasErrors())
+    {
+        bool l_result = l_model->GetAnimationController()->SetBoneMask(l_bone, l_weight, l_layer);
+        argStream.PushBoolean(l_result);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaModelDef::ResetAnimationBoneMask(lua_State *f_vm)
+{
+    // bool Model:resetAnimationBoneMask(int layer)
+    Model *l_model;
+    unsigned int l_layer;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_model);
+    argStream.ReadInteger(l_layer);
+    if(!argStream.HasErrors())
+    {
+        bool l_result = l_model->GetAnimationController()->ResetBoneMask(l_layer);
+        argStream.PushBoolean(l_result);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+
+int ROC::LuaModelDef::SetAnimationLOD(lua_State *f_vm)
+{
+    // bool Model:setAnimationLOD(str lod)
+    Model *l_model;
+    std::string l_lod;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_model);
+    argStream.ReadText(l_lod);
+    if(!argStream.HasErrors() && !l_lod.empty())
+    {
+        int l_idx = EnumUtils::ReadEnumVector(l_lod, g_AnimationLODTable);
+        if(l_idx != -1)
+        {
+            l_model->SetAnimationLOD(static_cast<unsigned char>(l_idx));
+            argStream.PushBoolean(true);
+        }
+        else argStream.PushBoolean(false);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaModelDef::GetAnimationLOD(lua_State *f_vm)
+{
+    // str Model:getAnimationLOD()
+    Model *l_model;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_model);
+    !argStream.HasErrors() ? argStream.PushText(g_AnimationLODTable[l_model->GetAnimationLOD()]) : argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
 
 int ROC::LuaModelDef::GetCollision(lua_State *f_vm)
 {
@@ -479,3 +589,51 @@ int ROC::LuaModelDef::SetCollidable(lua_State *f_vm)
     else argStream.PushBoolean(false);
     return argStream.GetReturnValue();
 }
+int ROC::LuaModelDef::GetModelsInFrustum(lua_State *f_vm)
+{
+    // table getModelsInFrustum(element camera)
+    Camera *l_camera;
+    ArgReader argStream(f_vm);
+    argStream.ReadElement(l_camera);
+    if(!argStream.HasErrors())
+    {
+        std::vector<Model*> l_models;
+        LuaManager::GetCore()->GetPreRenderManager()->GetModelsInFrustum(l_camera, l_models);
+        argStream.PushElementTable(l_models);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaModelDef::GetModelsInRadius(lua_State *f_vm)
+{
+    // table getModelsInRadius(float x, float y, float z, float radius)
+    glm::vec3 l_pos;
+    float l_radius;
+    ArgReader argStream(f_vm);
+    for(int i = 0; i < 3; i++) argStream.ReadNumber(l_pos[i]);
+    argStream.ReadNumber(l_radius);
+    if(!argStream.HasErrors() && (l_radius >= 0.f))
+    {
+        std::vector<Model*> l_models;
+        LuaManager::GetCore()->GetPreRenderManager()->GetModelsInRadius(l_pos, l_radius, l_models);
+        argStream.PushElementTable(l_models);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaModelDef::GetModelsInBox(lua_State *f_vm)
+{
+    // table getModelsInBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ)
+    glm::vec3 l_min, l_max;
+    ArgReader argStream(f_vm);
+    for(int i = 0; i < 3; i++) argStream.ReadNumber(l_min[i]);
+    for(int i = 0; i < 3; i++) argStream.ReadNumber(l_max[i]);
+    if(!argStream.HasErrors())
+    {
+        std::vector<Model*> l_models;
+        LuaManager::GetCore()->GetPreRenderManager()->GetModelsInBox(glm::min(l_min, l_max), glm::max(l_min, l_max), l_models);
+        argStream.PushElementTable(l_models);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
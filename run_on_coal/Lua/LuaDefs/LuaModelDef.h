@@ -26,8 +26,15 @@ class LuaModelDef final
     static int ResetAnimation(lua_State *f_vm);
     static int SetAnimationProperty(lua_State *f_vm);
     static int GetAnimationProperty(lua_State *f_vm);
+    static int SetAnimationBoneMask(lua_State *f_vm);
+    static int ResetAnimationBoneMask(lua_State *f_vm);
+    static int SetAnimationLOD(lua_State *f_vm);
+    static int GetAnimationLOD(lua_State *f_vm);
     static int GetCollision(lua_State *f_vm);
     static int SetCollidable(lua_State *f_vm);
+    static int GetModelsInFrustum(lua_State *f_vm);
+    static int GetModelsInRadius(lua_State *f_vm);
+    static int GetModelsInBox(lua_State *f_vm);
 protected:
     static void Init(lua_State *f_vm);
 
@@ -7,8 +7,20 @@
 #include "Managers/LuaManager.h"
 #include "Managers/MemoryManager.h"
 #include "Managers/PhysicsManager.h"
+#include "Managers/PreRenderManager.h"
 #include "Elements/Model/Model.h"
 #include "Lua/ArgReader.h"
+#include "Utils/EnumUtils.h"
+
+namespace ROC
+{
+
+extern const std::vector<std::string> g_CollisionTypesTable;
+
+}
+
+#define ROC_PHYSICS_QUERY_FLOATS 6U
+#define ROC_PHYSICS_HIT_SIZE 32U
 
 void ROC::LuaPhysicsDef::Init(lua_State *f_vm)
 {
@@ -18,7 +30,14 @@ void ROC::LuaPhysicsDef::Init(lua_State *f_vm)
     lua_register(f_vm, "physicsGetFloorEnabled", GetFloorEnabled);
     lua_register(f_vm, "physicsSetGravity", SetGravity);
     lua_register(f_vm, "physicsGetGravity", GetGravity);
+    lua_register(f_vm, "physicsSetStepRate", SetStepRate);
+    lua_register(f_vm, "physicsGetStepRate", GetStepRate);
+    lua_register(f_vm, "physicsSetSleepDistance", SetSleepDistance);
+    lua_register(f_vm, "physicsGetSleepDistance", GetSleepDistance);
+    lua_register(f_vm, "physicsGetBoneBodiesStats", GetBoneBodiesStats);
     lua_register(f_vm, "physicsRayCast", RayCast);
+    lua_register(f_vm, "physicsRayCastBatch", RayCastBatch);
+    lua_register(f_vm, "physicsSweepBatch", SweepBatch);
 }
 
 int ROC::LuaPhysicsDef::SetEnabled(lua_State *f_vm)
@@ -91,6 +110,66 @@ int ROC::LuaPhysicsDef::GetGravity(lua_State *f_vm)
     return argStream.GetReturnValue();
 }
 
+int ROC::LuaPhysicsDef::SetStepRate(lua_State *f_vm)
+{
+    // bool physicsSetStepRate(int rate [, int substeps = 10])
+    unsigned int l_rate;
+    unsigned int l_substeps = 10U;
+    ArgReader argStream(f_vm);
+    argStream.ReadInteger(l_rate);
+    argStream.ReadNextInteger(l_substeps);
+    if(!argStream.HasErrors() && (l_rate > 0U))
+    {
+        LuaManager::GetCore()->GetPhysicsManager()->SetStepRate(l_rate, l_substeps);
+        argStream.PushBoolean(true);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaPhysicsDef::GetStepRate(lua_State *f_vm)
+{
+    // int int physicsGetStepRate()
+    unsigned int l_rate, l_substeps;
+    ArgReader argStream(f_vm);
+    LuaManager::GetCore()->GetPhysicsManager()->GetStepRate(l_rate, l_substeps);
+    argStream.PushInteger(l_rate);
+    argStream.PushInteger(l_substeps);
+    return argStream.GetReturnValue();
+}
+
+int ROC::LuaPhysicsDef::SetSleepDistance(lua_State *f_vm)
+{
+    // bool physicsSetSleepDistance(float distance)
+    float l_distance;
+    ArgReader argStream(f_vm);
+    argStream.ReadNumber(l_distance);
+    if(!argStream.HasErrors())
+    {
+        LuaManager::GetCore()->GetPreRenderManager()->SetCollisionSleepDistance(l_distance);
+        argStream.PushBoolean(true);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaPhysicsDef::GetSleepDistance(lua_State *f_vm)
+{
+    // float physicsGetSleepDistance()
+    ArgReader argStream(f_vm);
+    argStream.PushNumber(LuaManager::GetCore()->GetPreRenderManager()->GetCollisionSleepDistance());
+    return argStream.GetReturnValue();
+}
+int ROC::LuaPhysicsDef::GetBoneBodiesStats(lua_State *f_vm)
+{
+    // int int int physicsGetBoneBodiesStats()
+    unsigned int l_updated, l_unchanged, l_sleeping;
+    ArgReader argStream(f_vm);
+    LuaManager::GetCore()->GetPreRenderManager()->GetCollisionStats(l_updated, l_unchanged, l_sleeping);
+    argStream.PushInteger(l_updated);
+    argStream.PushInteger(l_unchanged);
+    argStream.PushInteger(l_sleeping);
+    return argStream.GetReturnValue();
+}
+
 int ROC::LuaPhysicsDef::RayCast(lua_State *f_vm)
 {
     // float float float float float float element physicsRayCast(float startX, float startY, float startZ, float endX, float endY, float endZ)
@@ -117,3 +196,98 @@ int ROC::LuaPhysicsDef::RayCast(lua_State *f_vm)
     else argStream.PushBoolean(false);
     return argStream.GetReturnValue();
 }
+
+int ROC::LuaPhysicsDef::RayCastBatch(lua_State *f_vm)
+{
+    // str table physicsRayCastBatch(table|str rays [, bool allHits = false, bool parallel = false])
+    std::vector<glm::vec3> l_points;
+    bool l_allHits = false;
+    bool l_parallel = false;
+    ArgReader argStream(f_vm);
+    ReadQueryPoints(argStream, l_points);
+    argStream.ReadNextBoolean(l_allHits);
+    argStream.ReadNextBoolean(l_parallel);
+    if(!argStream.HasErrors())
+    {
+        std::vector<PhysicsQueryHit> l_hits;
+        LuaManager::GetCore()->GetPhysicsManager()->RayCastBatch(l_points, l_allHits, l_parallel, l_hits);
+        PushQueryHits(argStream, l_hits);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaPhysicsDef::SweepBatch(lua_State *f_vm)
+{
+    // str table physicsSweepBatch(str shape, float sizeX, float sizeY, float sizeZ, table|str sweeps [, bool parallel = false])
+    std::string l_text;
+    glm::vec3 l_size;
+    std::vector<glm::vec3> l_points;
+    bool l_parallel = false;
+    ArgReader argStream(f_vm);
+    argStream.ReadText(l_text);
+    for(int i = 0; i < 3; i++) argStream.ReadNumber(l_size[i]);
+    ReadQueryPoints(argStream, l_points);
+    argStream.ReadNextBoolean(l_parallel);
+    if(!argStream.HasErrors() && !l_text.empty())
+    {
+        int l_type = EnumUtils::ReadEnumVector(l_text, g_CollisionTypesTable);
+        std::vector<PhysicsQueryHit> l_hits;
+        if((l_type != -1) && LuaManager::GetCore()->GetPhysicsManager()->SweepBatch(l_type, l_size, l_points, l_parallel, l_hits)) PushQueryHits(argStream, l_hits);
+        else argStream.PushBoolean(false);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+
+void ROC::LuaPhysicsDef::ReadQueryPoints(ArgReader &f_argStream, std::vector<glm::vec3> &f_points)
+{
+    // Every query is start and end, packed string holds same floats as 32-bit values
+    std::vector<float> l_floats;
+    if(f_argStream.IsNextTable())
+    {
+        f_argStream.ReadNumberTable(l_floats);
+        if((l_floats.size() % ROC_PHYSICS_QUERY_FLOATS) != 0U) f_argStream.SetError("Expected 6 numbers per query in table");
+    }
+    else
+    {
+        std::string l_data;
+        f_argStream.ReadText(l_data);
+        if((l_data.size() % (ROC_PHYSICS_QUERY_FLOATS*sizeof(float))) == 0U)
+        {
+            l_floats.resize(l_data.size() / sizeof(float));
+            if(!l_data.empty()) std::memcpy(l_floats.data(), l_data.data(), l_data.size());
+            for(auto iter : l_floats)
+            {
+                if(!std::isfinite(iter))
+                {
+                    f_argStream.SetError("Got NaN/Inf in packed data");
+                    break;
+                }
+            }
+        }
+        else f_argStream.SetError("Expected 6 floats per query in packed data");
+    }
+
+    f_points.resize(l_floats.size() / 3U);
+    for(size_t i = 0U, j = f_points.size()*3U; i < j; i++) f_points[i / 3U][i % 3U] = l_floats[i];
+}
+void ROC::LuaPhysicsDef::PushQueryHits(ArgReader &f_argStream, const std::vector<PhysicsQueryHit> &f_hits)
+{
+    // Record is 1-based query index, hit fraction, position and normal, elements table goes in same order
+    std::string l_data(f_hits.size()*ROC_PHYSICS_HIT_SIZE, '\0');
+    std::vector<Element*> l_elements;
+    l_elements.reserve(f_hits.size());
+    for(size_t i = 0U, j = f_hits.size(); i < j; i++)
+    {
+        const PhysicsQueryHit &l_hit = f_hits[i];
+        char *l_record = &l_data[i*ROC_PHYSICS_HIT_SIZE];
+        unsigned int l_query = l_hit.m_query + 1U;
+        std::memcpy(l_record, &l_query, sizeof(unsigned int));
+        std::memcpy(l_record + 4U, &l_hit.m_fraction, sizeof(float));
+        std::memcpy(l_record + 8U, &l_hit.m_position, sizeof(glm::vec3));
+        std::memcpy(l_record + 20U, &l_hit.m_normal, sizeof(glm::vec3));
+        l_elements.push_back(l_hit.m_element);
+    }
+    f_argStream.PushText(l_data);
+    f_argStream.PushElementTable(l_elements);
+}
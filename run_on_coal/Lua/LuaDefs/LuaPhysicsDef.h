@@ -3,6 +3,8 @@
 namespace ROC
 {
 
+class ArgReader;
+struct PhysicsQueryHit;
 class LuaPhysicsDef final
 {
     static int SetEnabled(lua_State *f_vm);
@@ -11,7 +13,17 @@ class LuaPhysicsDef final
     static int GetFloorEnabled(lua_State *f_vm);
     static int SetGravity(lua_State *f_vm);
     static int GetGravity(lua_State *f_vm);
+    static int SetStepRate(lua_State *f_vm);
+    static int GetStepRate(lua_State *f_vm);
+    static int SetSleepDistance(lua_State *f_vm);
+    static int GetSleepDistance(lua_State *f_vm);
+    static int GetBoneBodiesStats(lua_State *f_vm);
     static int RayCast(lua_State *f_vm);
+    static int RayCastBatch(lua_State *f_vm);
+    static int SweepBatch(lua_State *f_vm);
+
+    static void ReadQueryPoints(ArgReader &f_argStream, std::vector<glm::vec3> &f_points);
+    static void PushQueryHits(ArgReader &f_argStream, const std::vector<PhysicsQueryHit> &f_hits);
 protected:
     static void Init(lua_State *f_vm);
 
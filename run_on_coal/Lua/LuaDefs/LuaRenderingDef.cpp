@@ -6,7 +6,9 @@
 #include "Managers/ElementManager.h"
 #include "Managers/LuaManager.h"
 #include "Managers/MemoryManager.h"
+#include "Managers/PreRenderManager.h"
 #include "Managers/RenderManager/RenderManager.h"
+#include "Elements/Camera.h"
 #include "Elements/RenderTarget.h"
 #include "Elements/Scene.h"
 #include "Elements/Shader/Shader.h"
@@ -32,6 +34,12 @@ void ROC::LuaRenderingDef::Init(lua_State *f_vm)
     lua_register(f_vm, "setClearColor", SetClearColor);
     lua_register(f_vm, "setRenderArea", SetRenderArea);
     lua_register(f_vm, "setPolygonMode", SetPolygonMode);
+    lua_register(f_vm, "setRenderQueueEnabled", SetRenderQueueEnabled);
+    lua_register(f_vm, "getRenderQueueEnabled", GetRenderQueueEnabled);
+    lua_register(f_vm, "setOcclusionCulling", SetOcclusionCulling);
+    lua_register(f_vm, "getOcclusionStats", GetOcclusionStats);
+    lua_register(f_vm, "setAnimationLOD", SetAnimationLOD);
+    lua_register(f_vm, "getAnimationLODStats", GetAnimationLODStats);
 }
 
 int ROC::LuaRenderingDef::SetActiveScene(lua_State *f_vm)
@@ -129,7 +137,7 @@ int ROC::LuaRenderingDef::SetPolygonMode(lua_State *f_vm)
         int l_type = EnumUtils::ReadEnumVector(l_mode, g_PolygonFillTable);
         if(l_type != -1)
         {
-            RenderManager::SetPolygonMode(l_type);
+            LuaManager::GetCore()->GetRenderManager()->SetPolygonMode(l_type);
             argStream.PushBoolean(true);
         }
         else argStream.PushBoolean(false);
@@ -137,3 +145,84 @@ int ROC::LuaRenderingDef::SetPolygonMode(lua_State *f_vm)
     else argStream.PushBoolean(false);
     return argStream.GetReturnValue();
 }
+
+int ROC::LuaRenderingDef::SetRenderQueueEnabled(lua_State *f_vm)
+{
+    // bool setRenderQueueEnabled(bool state)
+    bool l_state;
+    ArgReader argStream(f_vm);
+    argStream.ReadBoolean(l_state);
+    if(!argStream.HasErrors())
+    {
+        LuaManager::GetCore()->GetRenderManager()->SetRenderQueueEnabled(l_state);
+        argStream.PushBoolean(true);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaRenderingDef::GetRenderQueueEnabled(lua_State *f_vm)
+{
+    // bool getRenderQueueEnabled()
+    ArgReader argStream(f_vm);
+    argStream.PushBoolean(LuaManager::GetCore()->GetRenderManager()->GetRenderQueueEnabled());
+    return argStream.GetReturnValue();
+}
+
+int ROC::LuaRenderingDef::SetOcclusionCulling(lua_State *f_vm)
+{
+    // bool setOcclusionCulling(bool state [, element camera, element target])
+    bool l_state;
+    Camera *l_camera = nullptr;
+    RenderTarget *l_target = nullptr;
+    ArgReader argStream(f_vm);
+    argStream.ReadBoolean(l_state);
+    if(l_state)
+    {
+        argStream.ReadElement(l_camera);
+        argStream.ReadNextElement(l_target);
+    }
+    if(!argStream.HasErrors())
+    {
+        LuaManager::GetCore()->GetRenderManager()->SetOcclusionCulling(l_state, l_camera, l_target);
+        argStream.PushBoolean(true);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaRenderingDef::GetOcclusionStats(lua_State *f_vm)
+{
+    // int int getOcclusionStats()
+    unsigned int l_culled, l_visible;
+    ArgReader argStream(f_vm);
+    LuaManager::GetCore()->GetRenderManager()->GetOcclusionStats(l_culled, l_visible);
+    argStream.PushInteger(l_culled);
+    argStream.PushInteger(l_visible);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaRenderingDef::SetAnimationLOD(lua_State *f_vm)
+{
+    // bool setAnimationLOD(float distance [, bool freeze = false])
+    float l_distance;
+    bool l_freeze = false;
+    ArgReader argStream(f_vm);
+    argStream.ReadNumber(l_distance);
+    argStream.ReadNextBoolean(l_freeze);
+    if(!argStream.HasErrors())
+    {
+        LuaManager::GetCore()->GetPreRenderManager()->SetAnimationLOD(l_distance, l_freeze);
+        argStream.PushBoolean(true);
+    }
+    else argStream.PushBoolean(false);
+    return argStream.GetReturnValue();
+}
+int ROC::LuaRenderingDef::GetAnimationLODStats(lua_State *f_vm)
+{
+    // int int int getAnimationLODStats()
+    unsigned int l_full, l_throttled, l_skipped;
+    ArgReader argStream(f_vm);
+    LuaManager::GetCore()->GetPreRenderManager()->GetAnimationLODStats(l_full, l_throttled, l_skipped);
+    argStream.PushInteger(l_full);
+    argStream.PushInteger(l_throttled);
+    argStream.PushInteger(l_skipped);
+    return argStream.GetReturnValue();
+}
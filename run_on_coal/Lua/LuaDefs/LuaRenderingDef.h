@@ -12,6 +12,12 @@ class LuaRenderingDef final
     static int SetClearColor(lua_State *f_vm);
     static int SetRenderArea(lua_State *f_vm);
     static int SetPolygonMode(lua_State *f_vm);
+    static int SetRenderQueueEnabled(lua_State *f_vm);
+    static int GetRenderQueueEnabled(lua_State *f_vm);
+    static int SetOcclusionCulling(lua_State *f_vm);
+    static int GetOcclusionStats(lua_State *f_vm);
+    static int SetAnimationLOD(lua_State *f_vm);
+    static int GetAnimationLODStats(lua_State *f_vm);
 protected:
     static void Init(lua_State *f_vm);
 
@@ -56,6 +56,7 @@ int ROC::LuaShaderDef::SetUniformValue(lua_State *f_vm)
         ShaderUniform *l_shaderUniform = l_shader->GetUniform(l_uniform);
         if(l_shaderUniform)
         {
+            LuaManager::GetCore()->GetRenderManager()->FlushRenderQueue();
             switch(l_shaderUniform->GetType())
             {
                 case ShaderUniform::SUT_Bool:
@@ -249,6 +250,7 @@ int ROC::LuaShaderDef::Attach(lua_State *f_vm)
     argStream.ReadText(l_uniform);
     if(!argStream.HasErrors() && !l_uniform.empty())
     {
+        LuaManager::GetCore()->GetRenderManager()->FlushRenderQueue();
         bool l_result = LuaManager::GetCore()->GetInheritManager()->AttachDrawableToShader(l_shader, l_drawable, l_uniform);
         argStream.PushBoolean(l_result);
     }
@@ -265,6 +267,7 @@ int ROC::LuaShaderDef::Detach(lua_State *f_vm)
     argStream.ReadElement(l_drawable);
     if(!argStream.HasErrors())
     {
+        LuaManager::GetCore()->GetRenderManager()->FlushRenderQueue();
         bool l_result = LuaManager::GetCore()->GetInheritManager()->DetachDrawableFromShader(l_shader, l_drawable);
         argStream.PushBoolean(l_result);
     }
@@ -54,15 +54,19 @@ void ROC::LuaSoundDef::Init(lua_State *f_vm)
 
 int ROC::LuaSoundDef::Create(lua_State *f_vm)
 {
-    // element Sound(str path [, bool loop = false])
+    // element Sound(str path [, bool loop = false, bool async = false, float priority = 0])
     std::string l_path;
     bool l_loop = false;
+    bool l_async = false;
+    float l_priority = 0.f;
     ArgReader argStream(f_vm);
     argStream.ReadText(l_path);
     argStream.ReadNextBoolean(l_loop);
+    argStream.ReadNextBoolean(l_async);
+    argStream.ReadNextNumber(l_priority);
     if(!argStream.HasErrors() && !l_path.empty())
     {
-        Sound *l_sound = LuaManager::GetCore()->GetElementManager()->CreateSound(l_path, l_loop);
+        Sound *l_sound = LuaManager::GetCore()->GetElementManager()->CreateSound(l_path, l_loop, l_async, l_priority);
         l_sound ? argStream.PushElement(l_sound) : argStream.PushBoolean(false);
     }
     else argStream.PushBoolean(false);
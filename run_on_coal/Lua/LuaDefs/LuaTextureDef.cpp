@@ -30,12 +30,14 @@ void ROC::LuaTextureDef::Init(lua_State *f_vm)
     LuaDrawableDef::AddHierarchyMethods(f_vm);
     LuaElementDef::AddHierarchyMethods(f_vm);
     LuaUtils::AddClassFinish(f_vm);
+
+    lua_register(f_vm, "getTextureCacheStats", GetCacheStats);
 }
 
 int ROC::LuaTextureDef::Create(lua_State *f_vm)
 {
-    // element Texture(str type, str path, str filtering)
-    // element Texture(str type = "cube", str path1, ... , str path6, str filtering)
+    // element Texture(str type, str path [, str filtering = "nearest", bool compress = false, bool async = false, float priority = 0])
+    // element Texture(str type = "cube", str path1, ... , str path6 [, str filtering = "nearest", bool compress = false])
     std::string l_type;
     bool l_compress = false;
     ArgReader argStream(f_vm);
@@ -68,8 +70,13 @@ int ROC::LuaTextureDef::Create(lua_State *f_vm)
             bool l_compress = false;
             argStream.ReadNextBoolean(l_compress);
 
+            bool l_async = false;
+            float l_priority = 0.f;
+            argStream.ReadNextBoolean(l_async);
+            argStream.ReadNextNumber(l_priority);
+
             Texture *l_texture = nullptr;
-            if(l_path.size() == 1U) l_texture = LuaManager::GetCore()->GetElementManager()->CreateTexture(l_path[0], l_textureType, l_filteringType, l_compress);
+            if(l_path.size() == 1U) l_texture = LuaManager::GetCore()->GetElementManager()->CreateTexture(l_path[0], l_textureType, l_filteringType, l_compress, l_async, l_priority);
             else if(l_path.size() == 6U)  l_texture = LuaManager::GetCore()->GetElementManager()->CreateTexture(l_path, l_filteringType, l_compress);
             l_texture ? argStream.PushElement(l_texture) : argStream.PushBoolean(false);
         }
@@ -78,3 +85,13 @@ int ROC::LuaTextureDef::Create(lua_State *f_vm)
     else argStream.PushBoolean(false);
     return argStream.GetReturnValue();
 }
+int ROC::LuaTextureDef::GetCacheStats(lua_State *f_vm)
+{
+    // int int int getTextureCacheStats()
+    ArgReader argStream(f_vm);
+    ElementManager *l_elementManager = LuaManager::GetCore()->GetElementManager();
+    argStream.PushInteger(static_cast<lua_Integer>(l_elementManager->GetTextureCacheHits()));
+    argStream.PushInteger(static_cast<lua_Integer>(l_elementManager->GetTextureCacheMisses()));
+    argStream.PushInteger(static_cast<lua_Integer>(l_elementManager->GetTextureCacheMemory()));
+    return argStream.GetReturnValue();
+}
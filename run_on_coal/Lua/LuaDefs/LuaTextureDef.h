@@ -6,6 +6,7 @@ namespace ROC
 class LuaTextureDef final
 {
     static int Create(lua_State *f_vm);
+    static int GetCacheStats(lua_State *f_vm);
 protected:
     static void Init(lua_State *f_vm);
 
@@ -1,10 +1,15 @@
 #include "stdafx.h"
 
 #include "Managers/AsyncManager.h"
+#include "Elements/Animation/Animation.h"
 #include "Elements/Geometry/Geometry.h"
+#include "Elements/Font.h"
+#include "Elements/Sound.h"
+#include "Elements/Texture.h"
 #include "Lua/LuaArguments.h"
 
 #include "Core/Core.h"
+#include "Managers/ConfigManager.h"
 #include "Managers/ElementManager.h"
 #include "Managers/EventManager.h"
 #include "Managers/LuaManager.h"
@@ -14,82 +19,251 @@ ROC::AsyncManager::AsyncManager(Core *f_core)
 {
     m_core = f_core;
 
+    m_loadingOrder = 0U;
+    m_loadedStack = nullptr;
+    m_uploadBudget = std::chrono::microseconds(static_cast<long long>(m_core->GetConfigManager()->GetUploadBudget()*1000.f));
+    m_textureBudget = static_cast<size_t>(m_core->GetConfigManager()->GetTextureBudget())*1024U;
+
+    unsigned int l_threadsCount = m_core->GetConfigManager()->GetLoadThreads();
+    if(l_threadsCount == 0U)
+    {
+        // One core is left for main thread
+        l_threadsCount = std::thread::hardware_concurrency();
+        l_threadsCount = (l_threadsCount > 1U) ? (l_threadsCount - 1U) : 1U;
+    }
+    l_threadsCount = std::min(l_threadsCount, ROC_ASYNC_MAX_THREADS);
+
     m_threadSwitch = true;
-    m_loadThread = new std::thread(&ROC::AsyncManager::LoadThread, this);
+    for(unsigned int i = 0U; i < l_threadsCount; i++) m_loadThreads.push_back(new std::thread(&ROC::AsyncManager::LoadThread, this));
 
     m_argument = new LuaArguments();
     m_callback = nullptr;
 }
 ROC::AsyncManager::~AsyncManager()
 {
+    m_loadingMutex.lock();
     m_threadSwitch = false;
-    m_loadThread->join();
+    m_loadingMutex.unlock();
+    m_loadingCondition.notify_all();
+    for(auto iter : m_loadThreads)
+    {
+        iter->join();
+        delete iter;
+    }
+    m_loadThreads.clear();
 
-    m_loadedQueue.clear();
+    // Elements of unfinished queries are registered and released by memory manager
+    while(!m_loadingQueue.empty()) m_loadingQueue.pop();
+    for(amLoadNode *l_node = m_loadedStack.exchange(nullptr); l_node;)
+    {
+        amLoadNode *l_next = l_node->m_next;
+        delete l_node;
+        l_node = l_next;
+    }
+    while(!m_uploadQueue.empty()) m_uploadQueue.pop();
 
     delete m_argument;
 }
 
-void ROC::AsyncManager::AddGeometryToQueue(Geometry *f_geometry, const std::string &f_path)
+void ROC::AsyncManager::AddGeometryToQueue(Geometry *f_geometry, const std::string &f_path, float f_priority)
 {
     amLoadQuery l_query;
-    l_query.m_geometry = f_geometry;
+    l_query.m_element = f_geometry;
     l_query.m_path.assign(f_path);
-
+    l_query.m_priority = f_priority;
+    AddQuery(l_query);
+}
+void ROC::AsyncManager::AddAnimationToQueue(Animation *f_anim, const std::string &f_path, float f_priority)
+{
+    amLoadQuery l_query;
+    l_query.m_element = f_anim;
+    l_query.m_path.assign(f_path);
+    l_query.m_priority = f_priority;
+    AddQuery(l_query);
+}
+void ROC::AsyncManager::AddSoundToQueue(Sound *f_sound, const std::string &f_path, float f_priority)
+{
+    amLoadQuery l_query;
+    l_query.m_element = f_sound;
+    l_query.m_path.assign(f_path);
+    l_query.m_priority = f_priority;
+    AddQuery(l_query);
+}
+void ROC::AsyncManager::AddFontToQueue(Font *f_font, const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter, float f_priority)
+{
+    amLoadQuery l_query;
+    l_query.m_element = f_font;
+    l_query.m_path.assign(f_path);
+    l_query.m_priority = f_priority;
+    l_query.m_type = f_size;
+    l_query.m_filter = f_filter;
+    std::memcpy(&l_query.m_size, &f_atlas, sizeof(glm::ivec2));
+    AddQuery(l_query);
+}
+void ROC::AsyncManager::AddTextureToQueue(Texture *f_texture, const std::string &f_path, int f_type, int f_filter, bool f_compress, float f_priority)
+{
+    amLoadQuery l_query;
+    l_query.m_element = f_texture;
+    l_query.m_path.assign(f_path);
+    l_query.m_priority = f_priority;
+    l_query.m_type = f_type;
+    l_query.m_filter = f_filter;
+    l_query.m_compress = f_compress;
+    AddQuery(l_query);
+}
+void ROC::AsyncManager::AddQuery(amLoadQuery &f_query)
+{
     m_loadingMutex.lock();
-    m_loadingQueue.push_back(l_query);
+    f_query.m_order = m_loadingOrder++;
+    m_loadingQueue.push(f_query);
     m_loadingMutex.unlock();
+    m_loadingCondition.notify_one();
 }
 
 void ROC::AsyncManager::LoadThread()
 {
-    sf::Context l_context;
-    l_context.setActive(true);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    std::unique_lock<std::mutex> l_lock(m_loadingMutex);
+    while(true)
+    {
+        while(m_threadSwitch && m_loadingQueue.empty()) m_loadingCondition.wait(l_lock);
+        if(!m_threadSwitch) break;
+
+        amLoadNode *l_node = new amLoadNode();
+        l_node->m_query = m_loadingQueue.top();
+        m_loadingQueue.pop();
+        l_lock.unlock();
+
+        ProcessQuery(l_node->m_query);
 
-    std::chrono::milliseconds l_sleepTime(10U);
-    std::vector<amLoadQuery> l_tempQueue;
-    while(m_threadSwitch)
+        l_node->m_next = m_loadedStack.load(std::memory_order_relaxed);
+        while(!m_loadedStack.compare_exchange_weak(l_node->m_next, l_node, std::memory_order_release, std::memory_order_relaxed));
+
+        l_lock.lock();
+    }
+}
+
+void ROC::AsyncManager::ProcessQuery(amLoadQuery &f_query)
+{
+    // File reading, decoding and vertex processing only, GL objects are made in FinishQuery
+    switch(f_query.m_element->GetElementType())
     {
-        if(m_loadingMutex.try_lock())
+        case Element::ET_Geometry:
         {
-            m_loadingQueue.swap(l_tempQueue);
-            m_loadingMutex.unlock();
-        }
-        if(!l_tempQueue.empty())
+            Geometry *l_geometry = reinterpret_cast<Geometry*>(f_query.m_element);
+            f_query.m_result = l_geometry->Load(f_query.m_path);
+            if(f_query.m_result) m_core->GetElementManager()->AcquireGeometryTextures(l_geometry, true);
+        } break;
+        case Element::ET_Animation:
+            f_query.m_result = reinterpret_cast<Animation*>(f_query.m_element)->Load(f_query.m_path);
+            break;
+        case Element::ET_Sound:
+            f_query.m_result = reinterpret_cast<Sound*>(f_query.m_element)->Load(f_query.m_path);
+            break;
+        case Element::ET_Font:
+            f_query.m_result = reinterpret_cast<Font*>(f_query.m_element)->LoadFace(f_query.m_path, f_query.m_type, f_query.m_size, f_query.m_filter);
+            break;
+        case Element::ET_Texture:
+            f_query.m_result = reinterpret_cast<Texture*>(f_query.m_element)->Decode(f_query.m_path, f_query.m_type, f_query.m_filter, f_query.m_compress);
+            break;
+    }
+}
+
+void ROC::AsyncManager::FinishQuery(amLoadQuery &f_query)
+{
+    const char *l_event = nullptr;
+    switch(f_query.m_element->GetElementType())
+    {
+        case Element::ET_Geometry:
+        {
+            Geometry *l_geometry = reinterpret_cast<Geometry*>(f_query.m_element);
+            if(f_query.m_result) l_geometry->GenerateVAOs();
+            if(m_callback) (*m_callback)(l_geometry, f_query.m_result);
+            l_event = "onGeometryLoad";
+        } break;
+        case Element::ET_Animation:
         {
-            for(auto &iter : l_tempQueue) iter.m_result = iter.m_geometry->Load(iter.m_path);
-            glFinish();
+            reinterpret_cast<Animation*>(f_query.m_element)->SetReleased();
+            l_event = "onAnimationLoad";
+        } break;
+        case Element::ET_Sound:
+        {
+            reinterpret_cast<Sound*>(f_query.m_element)->SetReleased();
+            l_event = "onSoundLoad";
+        } break;
+        case Element::ET_Font:
+        {
+            Font *l_font = reinterpret_cast<Font*>(f_query.m_element);
+            if(f_query.m_result) f_query.m_result = l_font->GenerateAtlas();
+            l_font->SetReleased();
+            l_event = "onFontLoad";
+        } break;
+        case Element::ET_Texture:
+        {
+            if(f_query.m_result) f_query.m_result = reinterpret_cast<Texture*>(f_query.m_element)->IsLoaded();
+            l_event = "onTextureLoad";
+        } break;
+    }
 
-            m_loadedMutex.lock();
-            l_tempQueue.swap(m_loadedQueue);
-            m_loadedMutex.unlock();
-        }
-        std::this_thread::sleep_for(l_sleepTime);
+    if(l_event)
+    {
+        m_argument->PushArgument(f_query.m_element, f_query.m_element->GetElementTypeName());
+        m_argument->PushArgument(f_query.m_result);
+        m_core->GetLuaManager()->GetEventManager()->CallEvent(l_event, m_argument);
+        m_argument->Clear();
+    }
+
+    if(!f_query.m_result)
+    {
+        if(f_query.m_element->GetElementType() == Element::ET_Texture) m_core->GetElementManager()->UncacheTexture(reinterpret_cast<Texture*>(f_query.m_element));
+        m_core->GetElementManager()->DestroyElement(f_query.m_element);
     }
 }
 
 void ROC::AsyncManager::DoPulse()
 {
-    if(m_loadedMutex.try_lock())
+    amLoadNode *l_node = m_loadedStack.exchange(nullptr, std::memory_order_acquire);
+    if(l_node)
     {
-        if(!m_loadedQueue.empty())
+        // Stack holds latest first, restore completion order
+        amLoadNode *l_ordered = nullptr;
+        while(l_node)
         {
-            for(auto &iter : m_loadedQueue)
-            {
-                if(iter.m_result) iter.m_geometry->GenerateVAOs();
-
-                if(m_callback) (*m_callback)(iter.m_geometry, iter.m_result);
-
-                m_argument->PushArgument(iter.m_geometry, "Geometry");
-                m_argument->PushArgument(iter.m_result);
-                m_core->GetLuaManager()->GetEventManager()->CallEvent("onGeometryLoad", m_argument);
-                m_argument->Clear();
+            amLoadNode *l_next = l_node->m_next;
+            l_node->m_next = l_ordered;
+            l_ordered = l_node;
+            l_node = l_next;
+        }
+        while(l_ordered)
+        {
+            amLoadNode *l_next = l_ordered->m_next;
+            m_uploadQueue.push(l_ordered->m_query);
+            delete l_ordered;
+            l_ordered = l_next;
+        }
+    }
 
-                if(!iter.m_result) m_core->GetElementManager()->DestroyElement(iter.m_geometry);
+    // GL uploads are spread across frames, at least one query is processed per frame
+    // Partly streamed texture goes to back of queue, queries behind it don't wait for it
+    std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+    size_t l_textureBudget = m_textureBudget;
+    bool l_textureStreamed = false;
+    for(size_t i = 0U, j = m_uploadQueue.size(); i < j; i++)
+    {
+        amLoadQuery &l_query = m_uploadQueue.front();
+        bool l_finished = true;
+        if(l_query.m_element->GetElementType() == Element::ET_Texture)
+        {
+            // Pixels are streamed in row bands, first texture of frame streams even without budget
+            if(!l_textureStreamed || (l_textureBudget > 0U))
+            {
+                l_finished = reinterpret_cast<Texture*>(l_query.m_element)->Stream(l_textureBudget);
+                l_textureStreamed = true;
             }
-            m_loadedQueue.clear();
+            else l_finished = false;
         }
-        m_loadedMutex.unlock();
+        if(l_finished) FinishQuery(l_query);
+        else m_uploadQueue.push(l_query);
+        m_uploadQueue.pop();
+        if((std::chrono::steady_clock::now() - l_start) >= m_uploadBudget) break;
     }
 }
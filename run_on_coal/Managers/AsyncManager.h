@@ -1,10 +1,17 @@
 #pragma once
 
+#define ROC_ASYNC_MAX_THREADS 8U
+
 namespace ROC
 {
 
 class Core;
+class Element;
 class Geometry;
+class Animation;
+class Sound;
+class Font;
+class Texture;
 class LuaArguments;
 typedef void(*OnGeometryLoadCallback)(Geometry*, bool);
 
@@ -14,25 +21,55 @@ class AsyncManager final
 
     struct amLoadQuery
     {
-        Geometry *m_geometry = nullptr;
+        Element *m_element = nullptr;
         std::string m_path;
+        float m_priority = 0.f;
+        unsigned long long m_order = 0U;
+
+        // Texture type or font size, filtering, font atlas size and texture compression
+        int m_type = 0;
+        int m_filter = 0;
+        glm::ivec2 m_size;
+        bool m_compress = false;
+
         bool m_result = false;
     };
+    struct amQueryCompare
+    {
+        bool operator()(const amLoadQuery &f_queryA, const amLoadQuery &f_queryB) const
+        {
+            // Higher priority first, then in order of addition
+            return ((f_queryA.m_priority < f_queryB.m_priority) || ((f_queryA.m_priority == f_queryB.m_priority) && (f_queryA.m_order > f_queryB.m_order)));
+        }
+    };
+    struct amLoadNode
+    {
+        amLoadQuery m_query;
+        amLoadNode *m_next = nullptr;
+    };
 
     std::atomic<bool> m_threadSwitch;
-    std::thread *m_loadThread;
+    std::vector<std::thread*> m_loadThreads;
 
-    std::vector<amLoadQuery> m_loadingQueue;
+    std::priority_queue<amLoadQuery, std::vector<amLoadQuery>, amQueryCompare> m_loadingQueue;
     std::mutex m_loadingMutex;
+    std::condition_variable m_loadingCondition;
+    unsigned long long m_loadingOrder;
 
-    std::vector<amLoadQuery> m_loadedQueue;
-    std::mutex m_loadedMutex;
+    // Loader threads push finished queries, main thread takes whole list at once
+    std::atomic<amLoadNode*> m_loadedStack;
+    std::queue<amLoadQuery> m_uploadQueue;
+    std::chrono::microseconds m_uploadBudget;
+    size_t m_textureBudget;
 
     LuaArguments *m_argument;
 
     OnGeometryLoadCallback m_callback;
 
+    void AddQuery(amLoadQuery &f_query);
     void LoadThread();
+    void ProcessQuery(amLoadQuery &f_query);
+    void FinishQuery(amLoadQuery &f_query);
 
     AsyncManager(const AsyncManager& that);
     AsyncManager &operator =(const AsyncManager &that);
@@ -42,7 +79,11 @@ protected:
     explicit AsyncManager(Core *f_core);
     ~AsyncManager();
 
-    void AddGeometryToQueue(Geometry *f_geometry, const std::string &f_path);
+    void AddGeometryToQueue(Geometry *f_geometry, const std::string &f_path, float f_priority);
+    void AddAnimationToQueue(Animation *f_anim, const std::string &f_path, float f_priority);
+    void AddSoundToQueue(Sound *f_sound, const std::string &f_path, float f_priority);
+    void AddFontToQueue(Font *f_font, const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter, float f_priority);
+    void AddTextureToQueue(Texture *f_texture, const std::string &f_path, int f_type, int f_filter, bool f_compress, float f_priority);
 
     void DoPulse();
 
@@ -3,6 +3,7 @@
 #include "Managers/ConfigManager.h"
 
 #include "Core/Core.h"
+#include "Elements/Model/Skeleton.h"
 #include "Utils/EnumUtils.h"
 
 #define ROC_CONFIG_ATTRIB_ANTIALIASING 0
@@ -11,13 +12,29 @@
 #define ROC_CONFIG_ATTRIB_LOGGING 3
 #define ROC_CONFIG_ATTRIB_FPSLIMIT 4
 #define ROC_CONFIG_ATTRIB_VSYNC 5
+#define ROC_CONFIG_ATTRIB_LOADTHREADS 6
+#define ROC_CONFIG_ATTRIB_UPLOADBUDGET 7
+#define ROC_CONFIG_ATTRIB_TEXTUREBUDGET 8
+#define ROC_CONFIG_ATTRIB_MIPMAPS 9
+#define ROC_CONFIG_ATTRIB_ANISOTROPY 10
+#define ROC_CONFIG_ATTRIB_UPDATETHREADS 11
+#define ROC_CONFIG_ATTRIB_BONESPALETTE 12
+#define ROC_CONFIG_ATTRIB_ANIMATIONLOD 13
+#define ROC_CONFIG_ATTRIB_ANIMATIONFREEZE 14
+#define ROC_CONFIG_ATTRIB_PHYSICSRATE 15
+#define ROC_CONFIG_ATTRIB_PHYSICSSUBSTEPS 16
+#define ROC_CONFIG_ATTRIB_PHYSICSSLEEP 17
 
 namespace ROC
 {
 
 const std::vector<std::string> g_configAttributeTable
 {
-    "antialiasing", "dimension", "fullscreen", "logging", "fpslimit", "vsync"
+    "antialiasing", "dimension", "fullscreen", "logging", "fpslimit", "vsync", "loadthreads", "uploadbudget", "texturebudget", "mipmaps", "anisotropy", "updatethreads", "bonespalette", "animationlod", "animationfreeze", "physicsrate", "physicssubsteps", "physicssleep"
+};
+const std::vector<std::string> g_configBonesPaletteTable
+{
+    "matrix", "affine", "dualquat"
 };
 
 }
@@ -30,6 +47,18 @@ ROC::ConfigManager::ConfigManager()
     m_windowSize = glm::ivec2(854, 480);
     m_fpsLimit = 60U;
     m_vsync = false;
+    m_loadThreads = 0U;
+    m_uploadBudget = 2.f;
+    m_textureBudget = 4096U;
+    m_mipmaps = true;
+    m_anisotropy = 4.f;
+    m_updateThreads = 0U;
+    m_bonesPalette = Skeleton::SP_Matrix;
+    m_animationLODDistance = 0.f;
+    m_animationFreeze = false;
+    m_physicsRate = 60U;
+    m_physicsSubSteps = 10U;
+    m_physicsSleepDistance = 0.f;
 
     pugi::xml_document *l_settings = new pugi::xml_document();
     if(l_settings->load_file("settings.xml"))
@@ -73,6 +102,55 @@ ROC::ConfigManager::ConfigManager()
                             } break;
                             case ROC_CONFIG_ATTRIB_VSYNC:
                                 m_vsync = l_attrib.as_bool(false);
+                                break;
+                            case ROC_CONFIG_ATTRIB_LOADTHREADS:
+                                m_loadThreads = l_attrib.as_uint(0U);
+                                break;
+                            case ROC_CONFIG_ATTRIB_UPLOADBUDGET:
+                            {
+                                m_uploadBudget = l_attrib.as_float(2.f);
+                                if(m_uploadBudget < 0.f) m_uploadBudget = 0.f;
+                            } break;
+                            case ROC_CONFIG_ATTRIB_TEXTUREBUDGET:
+                                m_textureBudget = l_attrib.as_uint(4096U);
+                                break;
+                            case ROC_CONFIG_ATTRIB_MIPMAPS:
+                                m_mipmaps = l_attrib.as_bool(true);
+                                break;
+                            case ROC_CONFIG_ATTRIB_ANISOTROPY:
+                                m_anisotropy = l_attrib.as_float(4.f);
+                                break;
+                            case ROC_CONFIG_ATTRIB_UPDATETHREADS:
+                                m_updateThreads = l_attrib.as_uint(0U);
+                                break;
+                            case ROC_CONFIG_ATTRIB_BONESPALETTE:
+                            {
+                                int l_palette = EnumUtils::ReadEnumVector(l_attrib.as_string("matrix"), g_configBonesPaletteTable);
+                                if(l_palette != -1) m_bonesPalette = static_cast<unsigned char>(l_palette);
+                            } break;
+                            case ROC_CONFIG_ATTRIB_ANIMATIONLOD:
+                            {
+                                m_animationLODDistance = l_attrib.as_float(0.f);
+                                if(m_animationLODDistance < 0.f) m_animationLODDistance = 0.f;
+                            } break;
+                            case ROC_CONFIG_ATTRIB_ANIMATIONFREEZE:
+                                m_animationFreeze = l_attrib.as_bool(false);
+                                break;
+                            case ROC_CONFIG_ATTRIB_PHYSICSRATE:
+                            {
+                                m_physicsRate = l_attrib.as_uint(60U);
+                                if(m_physicsRate == 0U) m_physicsRate = 60U;
+                            } break;
+                            case ROC_CONFIG_ATTRIB_PHYSICSSUBSTEPS:
+                            {
+                                m_physicsSubSteps = l_attrib.as_uint(10U);
+                                if(m_physicsSubSteps == 0U) m_physicsSubSteps = 1U;
+                            } break;
+                            case ROC_CONFIG_ATTRIB_PHYSICSSLEEP:
+                            {
+                                m_physicsSleepDistance = l_attrib.as_float(0.f);
+                                if(m_physicsSleepDistance < 0.f) m_physicsSleepDistance = 0.f;
+                            } break;
                         }
                     }
                 }
@@ -11,6 +11,18 @@ class ConfigManager final
     glm::ivec2 m_windowSize;
     unsigned int m_fpsLimit;
     bool m_vsync;
+    unsigned int m_loadThreads;
+    float m_uploadBudget;
+    unsigned int m_textureBudget;
+    bool m_mipmaps;
+    float m_anisotropy;
+    unsigned int m_updateThreads;
+    unsigned char m_bonesPalette;
+    float m_animationLODDistance;
+    bool m_animationFreeze;
+    unsigned int m_physicsRate;
+    unsigned int m_physicsSubSteps;
+    float m_physicsSleepDistance;
 public:
     inline bool IsLogEnabled() const { return m_logging; }
     inline bool IsFullscreenEnabled() const { return m_fullscreen; }
@@ -18,6 +30,18 @@ public:
     inline void GetWindowSize(glm::ivec2 &f_vec) { std::memcpy(&f_vec, &m_windowSize, sizeof(glm::ivec2)); }
     inline unsigned int GetFPSLimit() const { return m_fpsLimit; }
     inline bool GetVSync() const { return m_vsync; }
+    inline unsigned int GetLoadThreads() const { return m_loadThreads; }
+    inline float GetUploadBudget() const { return m_uploadBudget; }
+    inline unsigned int GetTextureBudget() const { return m_textureBudget; }
+    inline bool IsMipmapsEnabled() const { return m_mipmaps; }
+    inline float GetAnisotropy() const { return m_anisotropy; }
+    inline unsigned int GetUpdateThreads() const { return m_updateThreads; }
+    inline unsigned char GetBonesPalette() const { return m_bonesPalette; }
+    inline float GetAnimationLODDistance() const { return m_animationLODDistance; }
+    inline bool IsAnimationFreezeEnabled() const { return m_animationFreeze; }
+    inline unsigned int GetPhysicsRate() const { return m_physicsRate; }
+    inline unsigned int GetPhysicsSubSteps() const { return m_physicsSubSteps; }
+    inline float GetPhysicsSleepDistance() const { return m_physicsSleepDistance; }
 protected:
     ConfigManager();
     ~ConfigManager();
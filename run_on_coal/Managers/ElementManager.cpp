@@ -8,6 +8,7 @@
 #include "Elements/File.h"
 #include "Elements/Font.h"
 #include "Elements/Geometry/Geometry.h"
+#include "Elements/Geometry/Material.h"
 #include "Elements/Light.h"
 #include "Elements/Model/Model.h"
 #include "Elements/Movie.h"
@@ -26,13 +27,37 @@
 #include "Managers/RenderManager/RenderManager.h"
 #include "Utils/PathUtils.h"
 
+namespace ROC
+{
+
+std::string GetTextureCacheKey(const std::string &f_path, int f_type, int f_filter, bool f_compress)
+{
+    std::string l_key(f_path);
+    l_key.push_back('|');
+    l_key.append(std::to_string(f_type));
+    l_key.push_back('|');
+    l_key.append(std::to_string(f_filter));
+    l_key.push_back(f_compress ? 'c' : 'u');
+    return l_key;
+}
+
+}
+
 ROC::ElementManager::ElementManager(Core *f_core)
 {
     m_core = f_core;
     m_locked = false;
+
+    m_textureCacheHits = 0U;
+    m_textureCacheMisses = 0U;
 }
 ROC::ElementManager::~ElementManager()
-{}
+{
+    // Cached textures are skipped by memory manager and released here
+    for(auto &iter : m_textureCacheEntries) delete iter.first;
+    m_textureCache.clear();
+    m_textureCacheEntries.clear();
+}
 
 ROC::Scene* ROC::ElementManager::CreateScene()
 {
@@ -56,15 +81,20 @@ ROC::Light* ROC::ElementManager::CreateLight()
     return l_light;
 }
 
-ROC::Animation* ROC::ElementManager::CreateAnimation(const std::string &f_path)
+ROC::Animation* ROC::ElementManager::CreateAnimation(const std::string &f_path, bool f_async, float f_priority)
 {
-    Animation *l_anim = new Animation();
+    Animation *l_anim = new Animation(f_async);
 
     std::string l_path(f_path);
     PathUtils::EscapePath(l_path);
     l_path.insert(0U, m_core->GetWorkingDirectory());
 
-    if(l_anim->Load(l_path)) m_core->GetMemoryManager()->AddMemoryPointer(l_anim);
+    if(f_async)
+    {
+        m_core->GetMemoryManager()->AddMemoryPointer(l_anim);
+        m_core->GetAsyncManager()->AddAnimationToQueue(l_anim, l_path, f_priority);
+    }
+    else if(l_anim->Load(l_path)) m_core->GetMemoryManager()->AddMemoryPointer(l_anim);
     else
     {
         delete l_anim;
@@ -73,7 +103,7 @@ ROC::Animation* ROC::ElementManager::CreateAnimation(const std::string &f_path)
     return l_anim;
 }
 
-ROC::Geometry* ROC::ElementManager::CreateGeometry(const std::string &f_path, bool f_async)
+ROC::Geometry* ROC::ElementManager::CreateGeometry(const std::string &f_path, bool f_async, float f_priority)
 {
     Geometry *l_geometry = new Geometry(f_async);
 
@@ -85,11 +115,15 @@ ROC::Geometry* ROC::ElementManager::CreateGeometry(const std::string &f_path, bo
     if(f_async)
     {
         m_core->GetMemoryManager()->AddMemoryPointer(l_geometry);
-        m_core->GetAsyncManager()->AddGeometryToQueue(l_geometry, l_path);
+        m_core->GetAsyncManager()->AddGeometryToQueue(l_geometry, l_path, f_priority);
     }
     else
     {
-        if(l_geometry->Load(l_path)) m_core->GetMemoryManager()->AddMemoryPointer(l_geometry);
+        if(l_geometry->Load(l_path))
+        {
+            AcquireGeometryTextures(l_geometry, false);
+            m_core->GetMemoryManager()->AddMemoryPointer(l_geometry);
+        }
         else
         {
             delete l_geometry;
@@ -116,6 +150,7 @@ ROC::Model* ROC::ElementManager::CreateModel(Geometry *f_geometry)
         m_core->GetMemoryManager()->AddMemoryPointer(l_model);
         m_core->GetPreRenderManager()->AddModel(l_model);
         m_core->GetPhysicsManager()->AddModel(l_model);
+        m_core->GetRenderManager()->AddModel(l_model);
     }
     return l_model;
 }
@@ -165,15 +200,20 @@ ROC::Shader* ROC::ElementManager::CreateShader(const std::string &f_vpath, const
     return l_shader;
 }
 
-ROC::Sound* ROC::ElementManager::CreateSound(const std::string &f_path, bool f_loop)
+ROC::Sound* ROC::ElementManager::CreateSound(const std::string &f_path, bool f_loop, bool f_async, float f_priority)
 {
-    Sound *l_sound = new Sound(f_loop);
+    Sound *l_sound = new Sound(f_loop, f_async);
 
     std::string l_path(f_path);
     PathUtils::EscapePath(l_path);
     l_path.insert(0U, m_core->GetWorkingDirectory());
 
-    if(l_sound->Load(l_path)) m_core->GetMemoryManager()->AddMemoryPointer(l_sound);
+    if(f_async)
+    {
+        m_core->GetMemoryManager()->AddMemoryPointer(l_sound);
+        m_core->GetAsyncManager()->AddSoundToQueue(l_sound, l_path, f_priority);
+    }
+    else if(l_sound->Load(l_path)) m_core->GetMemoryManager()->AddMemoryPointer(l_sound);
     else
     {
         delete l_sound;
@@ -197,21 +237,42 @@ ROC::RenderTarget* ROC::ElementManager::CreateRenderTarget(int f_type, const glm
     return l_rt;
 }
 
-ROC::Texture* ROC::ElementManager::CreateTexture(const std::string &f_path, int f_type, int f_filter, bool f_compress)
+ROC::Texture* ROC::ElementManager::CreateTexture(const std::string &f_path, int f_type, int f_filter, bool f_compress, bool f_async, float f_priority)
 {
-    Texture *l_texture = new Texture();
+    Texture *l_texture = nullptr;
 
     std::string l_path(f_path);
     PathUtils::EscapePath(l_path);
     l_path.insert(0U, m_core->GetWorkingDirectory());
 
-    if(m_locked) m_core->GetRenderManager()->ResetCallsReducing();
-    if(l_texture->Load(l_path, f_type, f_filter, f_compress)) m_core->GetMemoryManager()->AddMemoryPointer(l_texture);
-    else
+    if(!f_async && m_locked) m_core->GetRenderManager()->ResetCallsReducing();
+    if(f_async)
     {
-        delete l_texture;
-        l_texture = nullptr;
+        std::string l_key = GetTextureCacheKey(l_path, f_type, f_filter, f_compress);
+
+        m_textureCacheMutex.lock();
+        auto l_insertResult = m_textureCache.emplace(l_key, nullptr);
+        if(l_insertResult.second)
+        {
+            l_insertResult.first->second = new Texture(true);
+            l_insertResult.first->second->SetCached(true);
+            m_textureCacheEntries[l_insertResult.first->second].m_key.assign(l_key);
+            m_textureCacheMisses++;
+        }
+        else m_textureCacheHits++;
+        l_texture = l_insertResult.first->second;
+        m_textureCacheEntries[l_texture].m_scriptReferences++;
+        m_textureCacheMutex.unlock();
+
+        if(l_insertResult.second)
+        {
+            // Usable right away, dummy texture is bound until upload is finished
+            m_core->GetAsyncManager()->AddTextureToQueue(l_texture, l_path, f_type, f_filter, f_compress, f_priority);
+        }
     }
+    else l_texture = AcquireTexture(l_path, f_type, f_filter, f_compress, true, false);
+
+    if(l_texture) m_core->GetMemoryManager()->AddMemoryPointer(l_texture);
     return l_texture;
 }
 ROC::Texture* ROC::ElementManager::CreateTexture(const std::vector<std::string> &f_path, int f_filter, bool f_compress)
@@ -237,16 +298,21 @@ ROC::Texture* ROC::ElementManager::CreateTexture(const std::vector<std::string>
     return l_texture;
 }
 
-ROC::Font* ROC::ElementManager::CreateFont_(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter)
+ROC::Font* ROC::ElementManager::CreateFont_(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter, bool f_async, float f_priority)
 {
-    Font *l_font = new Font();
+    Font *l_font = new Font(f_async);
 
     std::string l_path(f_path);
     PathUtils::EscapePath(l_path);
     l_path.insert(0U, m_core->GetWorkingDirectory());
 
-    if(m_locked) m_core->GetRenderManager()->ResetCallsReducing();
-    if(l_font->Load(l_path, f_size, f_atlas, f_filter)) m_core->GetMemoryManager()->AddMemoryPointer(l_font);
+    if(!f_async && m_locked) m_core->GetRenderManager()->ResetCallsReducing();
+    if(f_async)
+    {
+        m_core->GetMemoryManager()->AddMemoryPointer(l_font);
+        m_core->GetAsyncManager()->AddFontToQueue(l_font, l_path, f_size, f_atlas, f_filter, f_priority);
+    }
+    else if(l_font->Load(l_path, f_size, f_atlas, f_filter)) m_core->GetMemoryManager()->AddMemoryPointer(l_font);
     else
     {
         delete l_font;
@@ -331,6 +397,7 @@ bool ROC::ElementManager::DestroyElement(Element *f_element)
     bool l_result = false;
     if(m_core->GetMemoryManager()->IsValidMemoryPointer(f_element))
     {
+        if(m_locked) m_core->GetRenderManager()->FlushRenderQueue();
         switch(f_element->GetElementType())
         {
             case Element::ET_Scene:
@@ -342,17 +409,35 @@ bool ROC::ElementManager::DestroyElement(Element *f_element)
                 l_result = true;
             } break;
 
-            case Element::ET_Camera: case Element::ET_Light: case Element::ET_Texture:
+            case Element::ET_Camera: case Element::ET_Light:
             {
+                m_core->GetRenderManager()->RemoveAsOcclusionSource(f_element);
                 m_core->GetInheritManager()->RemoveChildRelations(f_element);
                 m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
                 delete f_element;
                 l_result = true;
             } break;
 
+            case Element::ET_Texture:
+            {
+                Texture *l_texture = reinterpret_cast<Texture*>(f_element);
+                if(!l_texture->IsAsyncLoad() || l_texture->IsReleased())
+                {
+                    if(l_texture->IsCached()) ReleaseTexture(l_texture, true);
+                    else
+                    {
+                        m_core->GetInheritManager()->RemoveChildRelations(f_element);
+                        m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
+                        delete l_texture;
+                    }
+                    l_result = true;
+                }
+            } break;
+
             case Element::ET_RenderTarget:
             {
                 m_core->GetRenderManager()->RemoveAsActiveTarget(reinterpret_cast<RenderTarget*>(f_element));
+                m_core->GetRenderManager()->RemoveAsOcclusionSource(f_element);
                 m_core->GetInheritManager()->RemoveChildRelations(f_element);
                 m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
                 delete f_element;
@@ -361,10 +446,36 @@ bool ROC::ElementManager::DestroyElement(Element *f_element)
 
             case Element::ET_Animation:
             {
-                m_core->GetInheritManager()->RemoveParentRelations(f_element);
-                m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
-                delete f_element;
-                l_result = true;
+                Animation *l_anim = reinterpret_cast<Animation*>(f_element);
+                if(!l_anim->IsAsyncLoad() || l_anim->IsReleased())
+                {
+                    m_core->GetInheritManager()->RemoveParentRelations(f_element);
+                    m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
+                    delete l_anim;
+                    l_result = true;
+                }
+            } break;
+
+            case Element::ET_Sound:
+            {
+                Sound *l_sound = reinterpret_cast<Sound*>(f_element);
+                if(!l_sound->IsAsyncLoad() || l_sound->IsReleased())
+                {
+                    m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
+                    delete l_sound;
+                    l_result = true;
+                }
+            } break;
+
+            case Element::ET_Font:
+            {
+                Font *l_font = reinterpret_cast<Font*>(f_element);
+                if(!l_font->IsAsyncLoad() || l_font->IsReleased())
+                {
+                    m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
+                    delete l_font;
+                    l_result = true;
+                }
             } break;
 
             case Element::ET_Geometry:
@@ -374,6 +485,7 @@ bool ROC::ElementManager::DestroyElement(Element *f_element)
                 {
                     m_core->GetInheritManager()->RemoveParentRelations(f_element);
                     m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
+                    ReleaseGeometryTextures(l_geometry);
                     delete l_geometry;
                     l_result = true;
                 }
@@ -385,6 +497,7 @@ bool ROC::ElementManager::DestroyElement(Element *f_element)
                 m_core->GetInheritManager()->RemoveChildRelations(f_element);
                 m_core->GetPreRenderManager()->RemoveModel(reinterpret_cast<Model*>(f_element));
                 m_core->GetPhysicsManager()->RemoveModel(reinterpret_cast<Model*>(f_element));
+                m_core->GetRenderManager()->RemoveModel(reinterpret_cast<Model*>(f_element));
                 m_core->GetMemoryManager()->RemoveMemoryPointer(f_element);
                 delete f_element;
                 l_result = true;
@@ -420,7 +533,142 @@ bool ROC::ElementManager::DestroyElement(Element *f_element)
     }
     return l_result;
 }
+ROC::Texture* ROC::ElementManager::AcquireTexture(const std::string &f_path, int f_type, int f_filter, bool f_compress, bool f_script, bool f_decode)
+{
+    // Called from loader threads for async geometries, these only decode
+    std::string l_key = GetTextureCacheKey(f_path, f_type, f_filter, f_compress);
+    Texture *l_texture = nullptr;
+
+    m_textureCacheMutex.lock();
+    auto l_searchIter = m_textureCache.find(l_key);
+    if(l_searchIter != m_textureCache.end())
+    {
+        l_texture = l_searchIter->second;
+        emTextureCacheEntry &l_entry = m_textureCacheEntries[l_texture];
+        f_script ? l_entry.m_scriptReferences++ : l_entry.m_references++;
+        m_textureCacheHits++;
+    }
+    else m_textureCacheMisses++;
+    m_textureCacheMutex.unlock();
+
+    if(!l_texture)
+    {
+        // Loading is done without lock, first inserted texture wins on concurrent miss
+        Texture *l_newTexture = new Texture();
+        if(f_decode ? l_newTexture->Decode(f_path, f_type, f_filter, f_compress) : l_newTexture->Load(f_path, f_type, f_filter, f_compress))
+        {
+            m_textureCacheMutex.lock();
+            auto l_insertResult = m_textureCache.emplace(l_key, l_newTexture);
+            if(l_insertResult.second)
+            {
+                l_newTexture->SetCached(true);
+                m_textureCacheEntries[l_newTexture].m_key.assign(l_key);
+                l_newTexture = nullptr;
+            }
+            l_texture = l_insertResult.first->second;
+            emTextureCacheEntry &l_entry = m_textureCacheEntries[l_texture];
+            f_script ? l_entry.m_scriptReferences++ : l_entry.m_references++;
+            m_textureCacheMutex.unlock();
+        }
+        delete l_newTexture;
+    }
+
+    // Texture decoded for async geometry is uploaded by first synchronous user
+    if(l_texture && !f_decode && !l_texture->IsAsyncLoad()) l_texture->Upload();
+    return l_texture;
+}
+void ROC::ElementManager::ReleaseTexture(Texture *f_texture, bool f_script)
+{
+    bool l_unused = false;
+    bool l_unreferenced = false;
+
+    m_textureCacheMutex.lock();
+    auto l_entryIter = m_textureCacheEntries.find(f_texture);
+    if(l_entryIter != m_textureCacheEntries.end())
+    {
+        emTextureCacheEntry &l_entry = l_entryIter->second;
+        if(f_script)
+        {
+            if(l_entry.m_scriptReferences > 0U)
+            {
+                l_entry.m_scriptReferences--;
+                l_unreferenced = (l_entry.m_scriptReferences == 0U);
+            }
+        }
+        else if(l_entry.m_references > 0U) l_entry.m_references--;
+
+        if((l_entry.m_references == 0U) && (l_entry.m_scriptReferences == 0U))
+        {
+            // Key may be already taken by newer texture if this one was uncached
+            auto l_searchIter = m_textureCache.find(l_entry.m_key);
+            if((l_searchIter != m_textureCache.end()) && (l_searchIter->second == f_texture)) m_textureCache.erase(l_searchIter);
+            m_textureCacheEntries.erase(l_entryIter);
+            l_unused = true;
+        }
+    }
+    m_textureCacheMutex.unlock();
+
+    if(l_unreferenced)
+    {
+        // Scripts can't access texture that is still used by materials only
+        m_core->GetInheritManager()->RemoveChildRelations(f_texture);
+        m_core->GetMemoryManager()->RemoveMemoryPointer(f_texture);
+    }
+    if(l_unused) delete f_texture;
+}
+void ROC::ElementManager::UncacheTexture(Texture *f_texture)
+{
+    // Broken texture stays alive for current references, next request loads it again
+    m_textureCacheMutex.lock();
+    auto l_entryIter = m_textureCacheEntries.find(f_texture);
+    if(l_entryIter != m_textureCacheEntries.end())
+    {
+        auto l_searchIter = m_textureCache.find(l_entryIter->second.m_key);
+        if((l_searchIter != m_textureCache.end()) && (l_searchIter->second == f_texture)) m_textureCache.erase(l_searchIter);
+    }
+    m_textureCacheMutex.unlock();
+}
+size_t ROC::ElementManager::GetTextureCacheMemory()
+{
+    size_t l_memory = 0U;
+    m_textureCacheMutex.lock();
+    for(auto &iter : m_textureCacheEntries) l_memory += iter.first->GetMemorySize();
+    m_textureCacheMutex.unlock();
+    return l_memory;
+}
+
+void ROC::ElementManager::AcquireGeometryTextures(Geometry *f_geometry, bool f_decode)
+{
+    for(auto iter : f_geometry->GetMaterialVector())
+    {
+        if(!iter->GetTexturePath().empty() && !iter->HasTexture())
+        {
+            // Same escaping as CreateTexture, so both build equal cache keys
+            std::string l_path(iter->GetTexturePath());
+            PathUtils::EscapePath(l_path);
+            l_path.insert(0U, m_core->GetWorkingDirectory());
+            int l_type = iter->IsTransparent() ? Texture::TT_RGBA : Texture::TT_RGB;
+            iter->SetTexture(AcquireTexture(l_path, l_type, iter->GetFilteringType(), iter->IsCompressed(), false, f_decode));
+        }
+    }
+}
+void ROC::ElementManager::ReleaseGeometryTextures(Geometry *f_geometry)
+{
+    for(auto iter : f_geometry->GetMaterialVector())
+    {
+        if(iter->HasTexture())
+        {
+            ReleaseTexture(iter->GetTexture(), false);
+            iter->SetTexture(nullptr);
+        }
+    }
+}
+
 void ROC::ElementManager::DestroyElementByPointer(void *f_ptr)
 {
-    delete reinterpret_cast<Element*>(f_ptr);
+    Element *l_element = reinterpret_cast<Element*>(f_ptr);
+
+    // Cached textures are released by element manager
+    if((l_element->GetElementType() == Element::ET_Texture) && reinterpret_cast<Texture*>(l_element)->IsCached()) return;
+    delete l_element;
 }
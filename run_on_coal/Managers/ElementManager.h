@@ -23,31 +23,58 @@ class ElementManager final
 {
     Core *m_core;
     bool m_locked;
+
+    // Shared textures, key is path with type, filtering and compression
+    struct emTextureCacheEntry
+    {
+        std::string m_key;
+        unsigned int m_references = 0U;
+        unsigned int m_scriptReferences = 0U;
+    };
+    std::unordered_map<std::string, Texture*> m_textureCache;
+    std::unordered_map<Texture*, emTextureCacheEntry> m_textureCacheEntries;
+    std::mutex m_textureCacheMutex;
+    std::atomic<unsigned long long> m_textureCacheHits;
+    std::atomic<unsigned long long> m_textureCacheMisses;
+
+    Texture* AcquireTexture(const std::string &f_path, int f_type, int f_filter, bool f_compress, bool f_script, bool f_decode);
+    void ReleaseTexture(Texture *f_texture, bool f_script);
+    void UncacheTexture(Texture *f_texture);
+
+    ElementManager(const ElementManager &that);
+    ElementManager &operator =(const ElementManager &that);
 public:
     Scene* CreateScene();
     Camera* CreateCamera(int f_type);
     Light* CreateLight();
-    Geometry* CreateGeometry(const std::string &f_path, bool f_async = false);
+    Geometry* CreateGeometry(const std::string &f_path, bool f_async = false, float f_priority = 0.f);
     Model* CreateModel(Geometry *f_geometry);
     Shader* CreateShader(const std::string &f_vpath, const std::string &f_fpath, const std::string &f_gpath);
-    Animation* CreateAnimation(const std::string &f_path);
-    Sound* CreateSound(const std::string &f_path, bool f_loop);
+    Animation* CreateAnimation(const std::string &f_path, bool f_async = false, float f_priority = 0.f);
+    Sound* CreateSound(const std::string &f_path, bool f_loop, bool f_async = false, float f_priority = 0.f);
     RenderTarget* CreateRenderTarget(int f_type, const glm::ivec2 &f_size, int f_filter);
-    Texture* CreateTexture(const std::string &f_path, int f_type, int f_filter, bool f_compress);
+    Texture* CreateTexture(const std::string &f_path, int f_type, int f_filter, bool f_compress, bool f_async = false, float f_priority = 0.f);
     Texture* CreateTexture(const std::vector<std::string> &f_path, int f_filter, bool f_compress);
-    Font* CreateFont_(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter);
+    Font* CreateFont_(const std::string &f_path, int f_size, const glm::ivec2 &f_atlas, int f_filter, bool f_async = false, float f_priority = 0.f);
     File* CreateFile_(const std::string &f_path);
     File* OpenFile(const std::string &f_path, bool f_ro);
     Collision* CreateCollision(int f_type, glm::vec3 &f_size, float f_mass);
     Movie* CreateMovie(const std::string &f_path);
 
     bool DestroyElement(Element *f_element);
+
+    inline unsigned long long GetTextureCacheHits() const { return m_textureCacheHits; }
+    inline unsigned long long GetTextureCacheMisses() const { return m_textureCacheMisses; }
+    size_t GetTextureCacheMemory();
 protected:
     explicit ElementManager(Core *f_core);
     ~ElementManager();
 
     inline void SetLock(bool f_lock) { m_locked = f_lock; }
 
+    void AcquireGeometryTextures(Geometry *f_geometry, bool f_decode);
+    void ReleaseGeometryTextures(Geometry *f_geometry);
+
     static void DestroyElementByPointer(void* f_ptr);
 
     friend class Core;
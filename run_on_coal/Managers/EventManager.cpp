@@ -22,7 +22,7 @@ const std::vector<std::string> g_DefaultEventsNames
     "onJoypadStateChange", "onJoypadButton", "onJoypadAxis",
     "onTextInput",
     "onNetworkStateChange", "onNetworkDataRecieve",
-    "onGeometryLoad"
+    "onGeometryLoad", "onTextureLoad", "onAnimationLoad", "onSoundLoad", "onFontLoad"
 };
 
 }
@@ -83,7 +83,7 @@ void ROC::InheritanceManager::InheritanceBreakProcessing(Element *f_child, Eleme
                     reinterpret_cast<Model*>(f_child)->SetGeometry(nullptr);
                     break;
                 case Element::ET_Animation:
-                    reinterpret_cast<Model*>(f_child)->GetAnimationController()->SetAnimation(nullptr);
+                    reinterpret_cast<Model*>(f_child)->GetAnimationController()->RemoveAnimation(reinterpret_cast<Animation*>(f_parent));
                     break;
             }
         } break;
@@ -132,33 +132,37 @@ void ROC::InheritanceManager::SetModelGeometry(Model *f_model, Geometry *f_geome
 {
     AddInheritance(f_model, f_geometry);
 }
-bool ROC::InheritanceManager::SetModelAnimation(Model *f_model, Animation *f_anim)
+bool ROC::InheritanceManager::SetModelAnimation(Model *f_model, Animation *f_anim, unsigned int f_layer)
 {
     bool l_result = false;
-    if(f_model->HasSkeleton())
+    if(f_model->HasSkeleton() && (f_layer < ROC_ANIMCONTROL_MAX_LAYERS))
     {
-        Animation *l_modelAnim = f_model->GetAnimationController()->GetAnimation();
-        if(l_modelAnim == f_anim) l_result = true;
+        // Model is linked to animation once, no matter how many layers use it
+        AnimationController *l_controller = f_model->GetAnimationController();
+        Animation *l_layerAnim = l_controller->GetAnimation(f_layer);
+        if(l_layerAnim == f_anim) l_result = true;
         else
         {
-            if(f_model->GetSkeleton()->GetBonesCount() == f_anim->GetBonesCount())
+            if(f_anim->IsLoaded() && (f_model->GetSkeleton()->GetBonesCount() == f_anim->GetBonesCount()))
             {
-                if(l_modelAnim) RemoveInheritance(f_model, l_modelAnim);
-                AddInheritance(f_model, f_anim);
-                f_model->GetAnimationController()->SetAnimation(f_anim);
+                if(!l_controller->HasAnimation(f_anim)) AddInheritance(f_model, f_anim);
+                l_controller->SetAnimation(f_anim, f_layer);
+                if(l_layerAnim && !l_controller->HasAnimation(l_layerAnim)) RemoveInheritance(f_model, l_layerAnim);
                 l_result = true;
             }
         }
     }
     return l_result;
 }
-bool ROC::InheritanceManager::RemoveModelAnimation(Model *f_model)
+bool ROC::InheritanceManager::RemoveModelAnimation(Model *f_model, unsigned int f_layer)
 {
     bool l_result = false;
-    Animation *l_anim = f_model->GetAnimationController()->GetAnimation();
+    AnimationController *l_controller = f_model->GetAnimationController();
+    Animation *l_anim = l_controller->GetAnimation(f_layer);
     if(l_anim)
     {
-        RemoveInheritance(f_model, l_anim);
+        l_controller->SetAnimation(nullptr, f_layer);
+        if(!l_controller->HasAnimation(l_anim)) RemoveInheritance(f_model, l_anim);
         l_result = true;
     }
     return l_result;
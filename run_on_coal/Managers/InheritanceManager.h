@@ -27,8 +27,8 @@ class InheritanceManager final
 public:
     bool AttachModelToModel(Model *f_model, Model *f_parent, int f_bone = -1);
     bool DetachModel(Model *f_model);
-    bool SetModelAnimation(Model *f_model, Animation *f_anim);
-    bool RemoveModelAnimation(Model *f_model);
+    bool SetModelAnimation(Model *f_model, Animation *f_anim, unsigned int f_layer = 0U);
+    bool RemoveModelAnimation(Model *f_model, unsigned int f_layer = 0U);
 
     bool AttachCollisionToModel(Collision *f_col, Model *f_model);
     bool DetachCollision(Collision *f_col);
@@ -8,10 +8,59 @@
 
 #include "Managers/ConfigManager.h"
 #include "Managers/MemoryManager.h"
+#include "Utils/WorkerPool.h"
+#include "Utils/CollisionShapeCache.h"
 #include "Utils/SystemTick.h"
 
-#define ROC_PHYSICS_DEFAULT_TIMESTEP 1.f/60.f
-#define ROC_PHYSICS_DEFAULT_SUBSTEPS 10
+namespace ROC
+{
+
+// Tests ray or convex sweep against objects of broadphase leaves
+class PhysicsQueryCollider final : public btDbvt::ICollide
+{
+public:
+    btTransform m_from;
+    btTransform m_to;
+    const btConvexShape *m_shape;
+    btCollisionWorld::RayResultCallback *m_rayCallback;
+    btCollisionWorld::ConvexResultCallback *m_convexCallback;
+
+    void Process(const btDbvtNode *f_leaf)
+    {
+        btBroadphaseProxy *l_proxy = reinterpret_cast<btBroadphaseProxy*>(f_leaf->data);
+        btCollisionObject *l_object = reinterpret_cast<btCollisionObject*>(l_proxy->m_clientObject);
+        if(m_shape)
+        {
+            if(m_convexCallback->needsCollision(l_proxy)) btCollisionWorld::objectQuerySingle(m_shape, m_from, m_to, l_object, l_object->getCollisionShape(), l_object->getWorldTransform(), *m_convexCallback, 0.f);
+        }
+        else
+        {
+            if(m_rayCallback->needsCollision(l_proxy)) btCollisionWorld::rayTestSingle(m_from, m_to, l_object, l_object->getCollisionShape(), l_object->getWorldTransform(), *m_rayCallback);
+        }
+    }
+};
+
+// Looks for awake dynamic body in tested box
+class PhysicsActiveBodyCallback final : public btBroadphaseAabbCallback
+{
+public:
+    bool m_found;
+
+    bool process(const btBroadphaseProxy *f_proxy)
+    {
+        const btCollisionObject *l_object = reinterpret_cast<const btCollisionObject*>(f_proxy->m_clientObject);
+        if(!l_object->isStaticOrKinematicObject() && l_object->isActive()) m_found = true;
+        return !m_found;
+    }
+};
+
+}
+
+bool ROC::PhysicsQueryHit::operator<(const PhysicsQueryHit &f_hit) const
+{
+    return ((m_query != f_hit.m_query) ? (m_query < f_hit.m_query) : (m_fraction < f_hit.m_fraction));
+}
+
 
 ROC::PhysicsManager::PhysicsManager(Core *f_core)
 {
@@ -20,8 +69,8 @@ ROC::PhysicsManager::PhysicsManager(Core *f_core)
     m_broadPhase = new btDbvtBroadphase();
     m_collisionConfig = new btDefaultCollisionConfiguration();
     m_dispatcher = new btCollisionDispatcher(m_collisionConfig);
-    m_solver = new btSequentialImpulseConstraintSolver();
 
+    m_solver = new btSequentialImpulseConstraintSolver();
     m_dynamicWorld = new btDiscreteDynamicsWorld(m_dispatcher, m_broadPhase, m_solver, m_collisionConfig);
     m_dynamicWorld->setGravity(btVector3(0.f, -9.8f, 0.f));
 
@@ -29,8 +78,11 @@ ROC::PhysicsManager::PhysicsManager(Core *f_core)
 
     m_enabled = false;
 
-    unsigned int l_fpsLimit = m_core->GetConfigManager()->GetFPSLimit();
-    m_timeStep = (l_fpsLimit == 0U) ? ROC_PHYSICS_DEFAULT_TIMESTEP : (1.f / static_cast<float>(l_fpsLimit));
+    m_timeStep = 0.f;
+    m_maxSubSteps = 0U;
+    m_accumulator = 0.f;
+    m_interpolation = 1.f;
+    SetStepRate(m_core->GetConfigManager()->GetPhysicsRate(), m_core->GetConfigManager()->GetPhysicsSubSteps());
 }
 ROC::PhysicsManager::~PhysicsManager()
 {
@@ -150,9 +202,16 @@ bool ROC::PhysicsManager::SetModelsCollidable(Model *f_model1, Model *f_model2,
     return (!l_bodies1.empty() && !l_bodies2.empty());
 }
 
-void ROC::PhysicsManager::UpdateWorldSteps(unsigned int f_fps)
+void ROC::PhysicsManager::SetStepRate(unsigned int f_rate, unsigned int f_substeps)
+{
+    m_timeStep = 1.f / static_cast<float>(std::max(f_rate, 1U));
+    m_maxSubSteps = std::max(f_substeps, 1U);
+    m_accumulator = 0.f;
+}
+void ROC::PhysicsManager::GetStepRate(unsigned int &f_rate, unsigned int &f_substeps) const
 {
-    m_timeStep = (f_fps == 0U) ? ROC_PHYSICS_DEFAULT_TIMESTEP : (1.f / static_cast<float>(f_fps));
+    f_rate = static_cast<unsigned int>(std::round(1.f / m_timeStep));
+    f_substeps = m_maxSubSteps;
 }
 
 void ROC::PhysicsManager::AddModel(Model *f_model)
@@ -175,6 +234,8 @@ void ROC::PhysicsManager::AddModel(Model *f_model)
                     m_dynamicWorld->addConstraint(iter1->m_constraint, true);
                 }
             }
+            l_skeleton->SaveCollisionTransforms();
+            m_ragdolls.push_back(l_skeleton);
         }
     }
 }
@@ -198,6 +259,12 @@ void ROC::PhysicsManager::RemoveModel(Model *f_model)
                     m_dynamicWorld->removeConstraint(iter1->m_constraint);
                 }
             }
+            auto l_searchIter = std::find(m_ragdolls.begin(), m_ragdolls.end(), l_skeleton);
+            if(l_searchIter != m_ragdolls.end())
+            {
+                *l_searchIter = m_ragdolls.back();
+                m_ragdolls.pop_back();
+            }
         }
     }
 }
@@ -205,10 +272,18 @@ void ROC::PhysicsManager::RemoveModel(Model *f_model)
 void ROC::PhysicsManager::AddCollision(Collision *f_col)
 {
     m_dynamicWorld->addRigidBody(f_col->GetRigidBody());
+    f_col->SaveTransform();
+    m_collisions.push_back(f_col);
 }
 void ROC::PhysicsManager::RemoveCollision(Collision *f_col)
 {
     m_dynamicWorld->removeRigidBody(f_col->GetRigidBody());
+    auto iter = std::find(m_collisions.begin(), m_collisions.end(), f_col);
+    if(iter != m_collisions.end())
+    {
+        *iter = m_collisions.back();
+        m_collisions.pop_back();
+    }
 }
 
 bool ROC::PhysicsManager::RayCast(const glm::vec3 &f_start, glm::vec3 &f_end, glm::vec3 &f_normal, Element *&f_element)
@@ -234,7 +309,167 @@ bool ROC::PhysicsManager::RayCast(const glm::vec3 &f_start, glm::vec3 &f_end, gl
     return l_result;
 }
 
+void ROC::PhysicsManager::RayCastBatch(const std::vector<glm::vec3> &f_points, bool f_allHits, bool f_parallel, std::vector<PhysicsQueryHit> &f_hits)
+{
+    pmQueryBatch l_batch;
+    l_batch.m_manager = this;
+    l_batch.m_points = &f_points;
+    l_batch.m_shape = nullptr;
+    l_batch.m_allHits = f_allHits;
+    RunQueryBatch(l_batch, f_parallel, f_hits);
+}
+bool ROC::PhysicsManager::SweepBatch(int f_type, const glm::vec3 &f_size, const std::vector<glm::vec3> &f_points, bool f_parallel, std::vector<PhysicsQueryHit> &f_hits)
+{
+    bool l_result = false;
+    if((f_type >= CollisionShapeCache::ST_Sphere) && (f_type <= CollisionShapeCache::ST_Cone))
+    {
+        btCollisionShape *l_shape = CollisionShapeCache::AcquireShape(f_type, f_size, glm::vec3(1.f));
+
+        pmQueryBatch l_batch;
+        l_batch.m_manager = this;
+        l_batch.m_points = &f_points;
+        l_batch.m_shape = static_cast<btConvexShape*>(l_shape);
+        l_batch.m_allHits = false;
+        RunQueryBatch(l_batch, f_parallel, f_hits);
+
+        CollisionShapeCache::ReleaseShape(l_shape);
+        l_result = true;
+    }
+    return l_result;
+}
+
+bool ROC::PhysicsManager::HasActiveBodies(const glm::vec3 &f_min, const glm::vec3 &f_max)
+{
+    PhysicsActiveBodyCallback l_callback;
+    l_callback.m_found = false;
+    m_broadPhase->aabbTest(btVector3(f_min.x, f_min.y, f_min.z), btVector3(f_max.x, f_max.y, f_max.z), l_callback);
+    return l_callback.m_found;
+}
+
+void ROC::PhysicsManager::RunQueryBatch(pmQueryBatch &f_batch, bool f_parallel, std::vector<PhysicsQueryHit> &f_hits)
+{
+    f_batch.m_nextQuery = 0U;
+    WorkerPool *l_workerPool = m_core->GetWorkerPool();
+    if(f_parallel && l_workerPool->HasWorkers()) l_workerPool->Run(&PhysicsManager::QueryBatchJob, &f_batch);
+    else ProcessQueryBatch(f_batch);
+
+    // Threads finish queries in any order, elements are checked on main thread only
+    std::sort(f_batch.m_hits.begin(), f_batch.m_hits.end());
+    MemoryManager *l_memoryManager = m_core->GetMemoryManager();
+    for(auto &iter : f_batch.m_hits)
+    {
+        if(iter.m_element && !l_memoryManager->IsValidMemoryPointer(iter.m_element)) iter.m_element = nullptr;
+    }
+    f_hits.swap(f_batch.m_hits);
+}
+void ROC::PhysicsManager::QueryBatchJob(void *f_batch, unsigned int f_thread)
+{
+    pmQueryBatch *l_batch = reinterpret_cast<pmQueryBatch*>(f_batch);
+    l_batch->m_manager->ProcessQueryBatch(*l_batch);
+}
+void ROC::PhysicsManager::ProcessQueryBatch(pmQueryBatch &f_batch)
+{
+    const std::vector<glm::vec3> &l_points = *f_batch.m_points;
+    btAlignedObjectArray<const btDbvtNode*> l_stack;
+    std::vector<PhysicsQueryHit> l_hits;
+    PhysicsQueryHit l_hit;
+
+    PhysicsQueryCollider l_collider;
+    l_collider.m_shape = f_batch.m_shape;
+    l_collider.m_rayCallback = nullptr;
+    l_collider.m_convexCallback = nullptr;
+    btVector3 l_aabbMin(0.f, 0.f, 0.f), l_aabbMax(0.f, 0.f, 0.f);
+    if(f_batch.m_shape) f_batch.m_shape->getAabb(btTransform::getIdentity(), l_aabbMin, l_aabbMax);
+
+    for(size_t i = f_batch.m_nextQuery++, j = l_points.size() / 2U; i < j; i = f_batch.m_nextQuery++)
+    {
+        const glm::vec3 &l_start = l_points[i * 2U];
+        const glm::vec3 &l_end = l_points[i * 2U + 1U];
+        if(l_start == l_end) continue;
+
+        btVector3 l_from(l_start.x, l_start.y, l_start.z), l_to(l_end.x, l_end.y, l_end.z);
+        btVector3 l_direction = l_to - l_from;
+        btScalar l_length = l_direction.length();
+        l_direction /= l_length;
+        btVector3 l_directionInverse;
+        unsigned int l_signs[3];
+        for(int k = 0; k < 3; k++)
+        {
+            l_directionInverse[k] = (l_direction[k] == 0.f) ? BT_LARGE_FLOAT : (1.f / l_direction[k]);
+            l_signs[k] = (l_directionInverse[k] < 0.f) ? 1U : 0U;
+        }
+        l_collider.m_from.setIdentity();
+        l_collider.m_from.setOrigin(l_from);
+        l_collider.m_to.setIdentity();
+        l_collider.m_to.setOrigin(l_to);
+        l_hit.m_query = static_cast<unsigned int>(i);
+
+        if(f_batch.m_shape)
+        {
+            btCollisionWorld::ClosestConvexResultCallback l_result(l_from, l_to);
+            l_collider.m_convexCallback = &l_result;
+            for(int k = 0; k < 2; k++) m_broadPhase->m_sets[k].rayTestInternal(m_broadPhase->m_sets[k].m_root, l_from, l_to, l_directionInverse, l_signs, l_length, l_aabbMin, l_aabbMax, l_stack, l_collider);
+            if(l_result.hasHit())
+            {
+                l_hit.m_fraction = l_result.m_closestHitFraction;
+                std::memcpy(&l_hit.m_position, l_result.m_hitPointWorld.m_floats, sizeof(glm::vec3));
+                std::memcpy(&l_hit.m_normal, l_result.m_hitNormalWorld.m_floats, sizeof(glm::vec3));
+                l_hit.m_element = reinterpret_cast<Element*>(l_result.m_hitCollisionObject->getUserPointer());
+                l_hits.push_back(l_hit);
+            }
+        }
+        else if(f_batch.m_allHits)
+        {
+            btCollisionWorld::AllHitsRayResultCallback l_result(l_from, l_to);
+            l_collider.m_rayCallback = &l_result;
+            for(int k = 0; k < 2; k++) m_broadPhase->m_sets[k].rayTestInternal(m_broadPhase->m_sets[k].m_root, l_from, l_to, l_directionInverse, l_signs, l_length, l_aabbMin, l_aabbMax, l_stack, l_collider);
+            for(int k = 0, l = l_result.m_collisionObjects.size(); k < l; k++)
+            {
+                l_hit.m_fraction = l_result.m_hitFractions[k];
+                std::memcpy(&l_hit.m_position, l_result.m_hitPointWorld[k].m_floats, sizeof(glm::vec3));
+                std::memcpy(&l_hit.m_normal, l_result.m_hitNormalWorld[k].m_floats, sizeof(glm::vec3));
+                l_hit.m_element = reinterpret_cast<Element*>(l_result.m_collisionObjects[k]->getUserPointer());
+                l_hits.push_back(l_hit);
+            }
+        }
+        else
+        {
+            btCollisionWorld::ClosestRayResultCallback l_result(l_from, l_to);
+            l_collider.m_rayCallback = &l_result;
+            for(int k = 0; k < 2; k++) m_broadPhase->m_sets[k].rayTestInternal(m_broadPhase->m_sets[k].m_root, l_from, l_to, l_directionInverse, l_signs, l_length, l_aabbMin, l_aabbMax, l_stack, l_collider);
+            if(l_result.hasHit())
+            {
+                l_hit.m_fraction = l_result.m_closestHitFraction;
+                std::memcpy(&l_hit.m_position, l_result.m_hitPointWorld.m_floats, sizeof(glm::vec3));
+                std::memcpy(&l_hit.m_normal, l_result.m_hitNormalWorld.m_floats, sizeof(glm::vec3));
+                l_hit.m_element = reinterpret_cast<Element*>(l_result.m_collisionObject->getUserPointer());
+                l_hits.push_back(l_hit);
+            }
+        }
+    }
+
+    if(!l_hits.empty())
+    {
+        std::lock_guard<std::mutex> l_lock(f_batch.m_hitsMutex);
+        f_batch.m_hits.insert(f_batch.m_hits.end(), l_hits.begin(), l_hits.end());
+    }
+}
+
 void ROC::PhysicsManager::DoPulse()
 {
-    if(m_enabled) m_dynamicWorld->stepSimulation(m_timeStep, ROC_PHYSICS_DEFAULT_SUBSTEPS, ROC_PHYSICS_DEFAULT_TIMESTEP);
+    if(m_enabled)
+    {
+        // Time over substeps limit is dropped, simulation slows down instead of stalling frames
+        m_accumulator += static_cast<float>(SystemTick::GetDelta())*0.001f;
+        m_accumulator = std::min(m_accumulator, m_timeStep*static_cast<float>(m_maxSubSteps));
+        while(m_accumulator >= m_timeStep)
+        {
+            for(auto iter : m_collisions) iter->SaveTransform();
+            for(auto iter : m_ragdolls) iter->SaveCollisionTransforms();
+            m_dynamicWorld->stepSimulation(m_timeStep, 1, m_timeStep);
+            m_accumulator -= m_timeStep;
+        }
+        m_interpolation = m_accumulator / m_timeStep;
+    }
+    else m_interpolation = 1.f;
 }
@@ -6,21 +6,56 @@ namespace ROC
 class Core;
 class Element;
 class Model;
+class Skeleton;
 class Collision;
+
+struct PhysicsQueryHit
+{
+    unsigned int m_query; // Index of ray or sweep in batch
+    float m_fraction;
+    glm::vec3 m_position;
+    glm::vec3 m_normal;
+    Element *m_element;
+
+    bool operator<(const PhysicsQueryHit &f_hit) const;
+};
+
 class PhysicsManager final
 {
     Core *m_core;
 
     bool m_enabled;
     btDiscreteDynamicsWorld *m_dynamicWorld;
-    btBroadphaseInterface *m_broadPhase;
+    btDbvtBroadphase *m_broadPhase;
     btDefaultCollisionConfiguration *m_collisionConfig;
     btCollisionDispatcher *m_dispatcher;
-    btSequentialImpulseConstraintSolver *m_solver;
+    btConstraintSolver *m_solver;
+
+    // Measured frame time is simulated in fixed steps, models are drawn between two last steps
     float m_timeStep;
+    unsigned int m_maxSubSteps;
+    float m_accumulator;
+    float m_interpolation;
+    std::vector<Collision*> m_collisions;
+    std::vector<Skeleton*> m_ragdolls; // Skeletons with dynamic bone collision
 
     btRigidBody *m_floorBody;
 
+    // Batched queries walk broadphase trees with own stacks, threads don't share Bullet query state
+    struct pmQueryBatch
+    {
+        PhysicsManager *m_manager;
+        const std::vector<glm::vec3> *m_points; // Start and end of every query
+        const btConvexShape *m_shape; // Ray queries if not set
+        bool m_allHits;
+        std::atomic<size_t> m_nextQuery;
+        std::mutex m_hitsMutex;
+        std::vector<PhysicsQueryHit> m_hits;
+    };
+    void ProcessQueryBatch(pmQueryBatch &f_batch);
+    static void QueryBatchJob(void *f_batch, unsigned int f_thread);
+    void RunQueryBatch(pmQueryBatch &f_batch, bool f_parallel, std::vector<PhysicsQueryHit> &f_hits);
+
     PhysicsManager(const PhysicsManager& that);
     PhysicsManager &operator =(const PhysicsManager &that);
 public:
@@ -30,17 +65,22 @@ public:
     inline bool GetFloorEnabled() const { return (m_floorBody != nullptr); }
     void SetGravity(const glm::vec3 &f_grav);
     void GetGravity(glm::vec3 &f_grav);
+    void SetStepRate(unsigned int f_rate, unsigned int f_substeps);
+    void GetStepRate(unsigned int &f_rate, unsigned int &f_substeps) const;
+    inline float GetInterpolation() const { return m_interpolation; }
 
     void SetCollisionScale(Collision *f_col, const glm::vec3 &f_scale);
     static bool SetModelsCollidable(Model *f_model1, Model *f_model2, bool f_state);
 
     bool RayCast(const glm::vec3 &f_start, glm::vec3 &f_end, glm::vec3 &f_normal, Element *&f_element);
+    void RayCastBatch(const std::vector<glm::vec3> &f_points, bool f_allHits, bool f_parallel, std::vector<PhysicsQueryHit> &f_hits);
+    bool SweepBatch(int f_type, const glm::vec3 &f_size, const std::vector<glm::vec3> &f_points, bool f_parallel, std::vector<PhysicsQueryHit> &f_hits);
+
+    bool HasActiveBodies(const glm::vec3 &f_min, const glm::vec3 &f_max);
 protected:
     explicit PhysicsManager(Core *f_core);
     ~PhysicsManager();
 
-    void UpdateWorldSteps(unsigned int f_fps);
-
     void AddModel(Model *f_model);
     void RemoveModel(Model *f_model);
     void AddCollision(Collision *f_col);
@@ -50,7 +90,6 @@ protected:
 
     friend class Core;
     friend class ElementManager;
-    friend class SfmlManager;
 };
 
 }
@@ -4,11 +4,18 @@
 #include "Core/Core.h"
 #include "Elements/Model/Model.h"
 #include "Lua/LuaArguments.h"
+#include "Utils/SpatialTree.h"
 #include "Utils/TreeNode.h"
+#include "Utils/WorkerPool.h"
 
+#include "Managers/ConfigManager.h"
 #include "Managers/EventManager.h"
 #include "Managers/LuaManager.h"
 #include "Managers/PhysicsManager.h"
+#include "Managers/RenderManager/RenderManager.h"
+#include "Elements/Camera.h"
+#include "Elements/Scene.h"
+#include "Elements/Model/AnimationController.h"
 #include "Elements/Model/Skeleton.h"
 
 ROC::PreRenderManager::PreRenderManager(Core *f_core)
@@ -18,6 +25,22 @@ ROC::PreRenderManager::PreRenderManager(Core *f_core)
     m_callback = nullptr;
     m_modelTreeRoot = new TreeNode(nullptr);
     m_modelToNodeMapEnd = m_modelToNodeMap.end();
+    m_spatialTree = new SpatialTree();
+
+    m_animationLODDistance = m_core->GetConfigManager()->GetAnimationLODDistance();
+    m_animationLODFreeze = m_core->GetConfigManager()->IsAnimationFreezeEnabled();
+    m_animationFull = 0U;
+    m_animationThrottled = 0U;
+    m_animationSkipped = 0U;
+    for(unsigned int i = 0U; i < 3U; i++) m_animationStats[i] = 0U;
+
+    m_collisionSleepDistance = m_core->GetConfigManager()->GetPhysicsSleepDistance();
+    for(unsigned int i = 0U; i < 3U; i++) m_collisionStats[i] = 0U;
+
+    m_nextRootNode = 0U;
+    unsigned int l_threadsCount = m_core->GetWorkerPool()->GetThreadsCount();
+    m_threadNodeStacks.resize(l_threadsCount);
+    m_threadCollisionModels.resize(l_threadsCount);
 }
 ROC::PreRenderManager::~PreRenderManager()
 {
@@ -33,6 +56,7 @@ ROC::PreRenderManager::~PreRenderManager()
         delete l_node;
     }
     delete m_modelTreeRoot;
+    delete m_spatialTree;
     delete m_argument;
 }
 
@@ -42,6 +66,11 @@ void ROC::PreRenderManager::AddModel(Model *f_model)
     m_modelTreeRoot->AddChild(l_node);
     m_modelToNodeMap.insert(std::make_pair(f_model, l_node));
     m_modelToNodeMapEnd = m_modelToNodeMap.end();
+
+    const glm::vec3 &l_center = f_model->GetBoundBoxCenter();
+    const glm::vec3 &l_extent = f_model->GetBoundBoxExtent();
+    f_model->m_spatialProxy = m_spatialTree->Insert(f_model, l_center - l_extent, l_center + l_extent);
+    f_model->m_boundsUpdated = false;
 }
 void ROC::PreRenderManager::RemoveModel(Model *f_model)
 {
@@ -62,6 +91,9 @@ void ROC::PreRenderManager::RemoveModel(Model *f_model)
         m_modelToNodeMap.erase(l_modelIter);
         m_modelToNodeMapEnd = m_modelToNodeMap.end();
         delete l_node;
+
+        m_spatialTree->Remove(f_model->m_spatialProxy);
+        f_model->m_spatialProxy = -1;
     }
 }
 
@@ -103,30 +135,149 @@ void ROC::PreRenderManager::RemoveLink(Model *f_model)
     }
 }
 
+void ROC::PreRenderManager::UpdateJob(void *f_manager, unsigned int f_thread)
+{
+    // Every thread has own stack and collision list, lists are merged on main thread
+    PreRenderManager *l_manager = reinterpret_cast<PreRenderManager*>(f_manager);
+    l_manager->UpdateHierarchies(l_manager->m_threadNodeStacks[f_thread], l_manager->m_threadCollisionModels[f_thread]);
+}
+void ROC::PreRenderManager::UpdateHierarchies(std::vector<TreeNode*> &f_nodeStack, std::vector<Model*> &f_collisionModels)
+{
+    unsigned int l_animationCounters[3U] = { 0U };
+    const std::vector<TreeNode*> &l_rootNodes = m_modelTreeRoot->GetChildren();
+    for(size_t l_rootIndex = m_nextRootNode++, l_rootCount = l_rootNodes.size(); l_rootIndex < l_rootCount; l_rootIndex = m_nextRootNode++)
+    {
+        // Parents are updated before children, attached models depend on parent bones
+        f_nodeStack.push_back(l_rootNodes[l_rootIndex]);
+        while(!f_nodeStack.empty())
+        {
+            TreeNode *l_current = f_nodeStack.back();
+            f_nodeStack.pop_back();
+
+            auto &l_nodeChildren = l_current->GetChildren();
+            f_nodeStack.insert(f_nodeStack.end(), l_nodeChildren.rbegin(), l_nodeChildren.rend());
+
+            Model *l_model = reinterpret_cast<Model*>(l_current->GetPointer());
+            if(!l_model->HasCollision()) l_model->Update(Model::MUS_Matrix);
+            if(l_model->HasSkeleton())
+            {
+                l_model->m_animationInterval = GetAnimationInterval(l_model);
+                l_model->m_drawn = false;
+                if(l_model->GetAnimationController()->GetAnimation()) l_animationCounters[std::min(l_model->m_animationInterval, 2U)]++;
+            }
+            l_model->Update(Model::MUS_Skeleton);
+            if(l_model->HasSkeleton())
+            {
+                Skeleton *l_skeleton = l_model->GetSkeleton();
+                if(l_skeleton->HasStaticBoneCollision() || l_skeleton->HasDynamicBoneCollision()) f_collisionModels.push_back(l_model);
+            }
+        }
+    }
+    m_animationSkipped += l_animationCounters[0U];
+    m_animationFull += l_animationCounters[1U];
+    m_animationThrottled += l_animationCounters[2U];
+}
+unsigned int ROC::PreRenderManager::GetAnimationInterval(Model *f_model) const
+{
+    // Bone bodies follow pose of every frame
+    Skeleton *l_skeleton = f_model->GetSkeleton();
+    if(l_skeleton->HasStaticBoneCollision() || l_skeleton->HasDynamicBoneCollision()) return 1U;
+
+    unsigned int l_interval = 1U;
+    switch(f_model->GetAnimationLOD())
+    {
+        case Model::MAL_Auto:
+        {
+            if(!f_model->m_drawn)
+            {
+                if(m_animationLODFreeze) l_interval = 0U;
+                else if(m_animationLODDistance > 0.f) l_interval = 4U;
+            }
+            else if(m_animationLODDistance > 0.f)
+            {
+                if(f_model->m_drawDistance >= m_animationLODDistance*2.f) l_interval = 4U;
+                else if(f_model->m_drawDistance >= m_animationLODDistance) l_interval = 2U;
+            }
+        } break;
+        case Model::MAL_Half:
+            l_interval = 2U;
+            break;
+        case Model::MAL_Quarter:
+            l_interval = 4U;
+            break;
+        case Model::MAL_Frozen:
+            l_interval = 0U;
+            break;
+    }
+    return l_interval;
+}
+
+bool ROC::PreRenderManager::IsCollisionSleepAllowed(Model *f_model)
+{
+    // Ragdoll parts are simulated and need joint bodies awake
+    bool l_result = false;
+    if((m_collisionSleepDistance > 0.f) && !f_model->GetSkeleton()->HasDynamicBoneCollision())
+    {
+        // Culled models can be right behind camera, only real distance counts
+        Scene *l_scene = m_core->GetRenderManager()->GetActiveScene();
+        Camera *l_camera = (l_scene ? l_scene->GetCamera() : nullptr);
+        if(l_camera) l_result = (glm::distance(l_camera->GetPosition(), f_model->GetBoundSphereCenter()) >= m_collisionSleepDistance);
+        else l_result = true;
+    }
+    if(l_result)
+    {
+        glm::vec3 l_extent = f_model->GetBoundBoxExtent() + glm::vec3(ROC_PRERENDER_SLEEP_MARGIN);
+        const glm::vec3 &l_center = f_model->GetBoundBoxCenter();
+        l_result = !m_core->GetPhysicsManager()->HasActiveBodies(l_center - l_extent, l_center + l_extent);
+    }
+    return l_result;
+}
+
 void ROC::PreRenderManager::DoPulse_S1()
 {
     if(m_callback) (*m_callback)();
     m_core->GetLuaManager()->GetEventManager()->CallEvent("onPreRender", m_argument);
     bool l_physicsState = m_core->GetPhysicsManager()->GetPhysicsEnabled();
 
-    auto &l_rootNodes = m_modelTreeRoot->GetChildren();
-    m_nodeStack.insert(m_nodeStack.end(), l_rootNodes.rbegin(), l_rootNodes.rend());
-    while(!m_nodeStack.empty())
+    m_animationStats[0U] = m_animationFull.exchange(0U);
+    m_animationStats[1U] = m_animationThrottled.exchange(0U);
+    m_animationStats[2U] = m_animationSkipped.exchange(0U);
+
+    m_nextRootNode = 0U;
+    WorkerPool *l_workerPool = m_core->GetWorkerPool();
+    if(l_workerPool->HasWorkers() && (m_modelTreeRoot->GetChildren().size() >= ROC_PRERENDER_PARALLEL_THRESHOLD))
     {
-        TreeNode *l_current = m_nodeStack.back();
-        m_nodeStack.pop_back();
+        l_workerPool->Run(&PreRenderManager::UpdateJob, this);
+        for(auto &iter : m_threadCollisionModels)
+        {
+            m_collisionModels.insert(m_collisionModels.end(), iter.begin(), iter.end());
+            iter.clear();
+        }
+    }
+    else UpdateHierarchies(m_nodeStack, m_collisionModels);
 
-        auto &l_nodeChildren = l_current->GetChildren();
-        m_nodeStack.insert(m_nodeStack.end(), l_nodeChildren.rbegin(), l_nodeChildren.rend());
+    // Bone bodies follow pose of current frame
+    for(unsigned int i = 0U; i < 3U; i++) m_collisionStats[i] = 0U;
+    for(auto iter : m_collisionModels)
+    {
+        Skeleton *l_skeleton = iter->GetSkeleton();
+        l_skeleton->SetCollisionSleeping(IsCollisionSleepAllowed(iter));
+        iter->Update(Model::MUS_SkeletonStatic, l_physicsState);
 
-        Model *l_model = reinterpret_cast<Model*>(l_current->GetPointer());
-        if(!l_model->HasCollision()) l_model->Update(Model::MUS_Matrix);
-        l_model->Update(Model::MUS_SkeletonStatic, l_physicsState);
+        unsigned int l_bodiesCount = l_skeleton->GetCollisionBodiesCount();
+        if(l_skeleton->IsCollisionSleeping()) m_collisionStats[2U] += l_bodiesCount;
+        else
+        {
+            m_collisionStats[0U] += l_skeleton->GetCollisionUpdates();
+            m_collisionStats[1U] += l_bodiesCount - l_skeleton->GetCollisionUpdates();
+        }
     }
+    m_collisionModels.clear();
 }
 void ROC::PreRenderManager::DoPulse_S2()
 {
     bool l_physicsState = m_core->GetPhysicsManager()->GetPhysicsEnabled();
+    float l_interpolation = m_core->GetPhysicsManager()->GetInterpolation();
 
     auto &l_rootNodes = m_modelTreeRoot->GetChildren();
     m_nodeStack.insert(m_nodeStack.end(), l_rootNodes.rbegin(), l_rootNodes.rend());
@@ -139,7 +290,57 @@ void ROC::PreRenderManager::DoPulse_S2()
         m_nodeStack.insert(m_nodeStack.end(), l_nodeChildren.rbegin(), l_nodeChildren.rend());
 
         Model *l_model = reinterpret_cast<Model*>(l_current->GetPointer());
-        l_model->Update(l_model->HasCollision() ? Model::MUS_Collision : Model::MUS_Matrix);
-        l_model->Update(Model::MUS_SkeletonDynamic, l_physicsState);
+        l_model->HasCollision() ? l_model->Update(Model::MUS_Collision, false, l_interpolation) : l_model->Update(Model::MUS_Matrix);
+        l_model->Update(Model::MUS_SkeletonDynamic, l_physicsState, l_interpolation);
+
+        if(l_model->m_boundsUpdated)
+        {
+            const glm::vec3 &l_center = l_model->GetBoundBoxCenter();
+            const glm::vec3 &l_extent = l_model->GetBoundBoxExtent();
+            m_spatialTree->Move(l_model->m_spatialProxy, l_center - l_extent, l_center + l_extent);
+            l_model->m_boundsUpdated = false;
+        }
     }
 }
+
+void ROC::PreRenderManager::SetAnimationLOD(float f_distance, bool f_freeze)
+{
+    m_animationLODDistance = std::max(f_distance, 0.f);
+    m_animationLODFreeze = f_freeze;
+}
+void ROC::PreRenderManager::GetAnimationLODStats(unsigned int &f_full, unsigned int &f_throttled, unsigned int &f_skipped) const
+{
+    f_full = m_animationStats[0U];
+    f_throttled = m_animationStats[1U];
+    f_skipped = m_animationStats[2U];
+}
+
+void ROC::PreRenderManager::GetCollisionStats(unsigned int &f_updated, unsigned int &f_unchanged, unsigned int &f_sleeping) const
+{
+    f_updated = m_collisionStats[0U];
+    f_unchanged = m_collisionStats[1U];
+    f_sleeping = m_collisionStats[2U];
+}
+
+void ROC::PreRenderManager::FillQueryResult(std::vector<Model*> &f_models)
+{
+    f_models.reserve(f_models.size() + m_queryResult.size());
+    for(auto iter : m_queryResult) f_models.push_back(reinterpret_cast<Model*>(iter));
+    m_queryResult.clear();
+}
+void ROC::PreRenderManager::GetModelsInFrustum(Camera *f_camera, std::vector<Model*> &f_models)
+{
+    f_camera->Update();
+    m_spatialTree->QueryFrustum(f_camera->GetPlanes(), m_queryResult);
+    FillQueryResult(f_models);
+}
+void ROC::PreRenderManager::GetModelsInRadius(const glm::vec3 &f_pos, float f_radius, std::vector<Model*> &f_models)
+{
+    m_spatialTree->QuerySphere(f_pos, f_radius, m_queryResult);
+    FillQueryResult(f_models);
+}
+void ROC::PreRenderManager::GetModelsInBox(const glm::vec3 &f_min, const glm::vec3 &f_max, std::vector<Model*> &f_models)
+{
+    m_spatialTree->QueryBox(f_min, f_max, m_queryResult);
+    FillQueryResult(f_models);
+}
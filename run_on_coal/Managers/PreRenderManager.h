@@ -1,12 +1,17 @@
 #pragma once
 
+#define ROC_PRERENDER_PARALLEL_THRESHOLD 16U
+#define ROC_PRERENDER_SLEEP_MARGIN 1.f
+
 namespace ROC
 {
 
 class Core;
+class Camera;
 class Model;
 class LuaArguments;
 class TreeNode;
+class SpatialTree;
 typedef void(*OnPreRender)(void);
 
 class PreRenderManager final
@@ -19,13 +24,53 @@ class PreRenderManager final
 
     std::vector<TreeNode*> m_nodeStack;
 
+    // Bounds of all models, leaves are moved in serial stage after matrices are final
+    SpatialTree *m_spatialTree;
+    std::vector<void*> m_queryResult;
+
+    // Root hierarchies are independent, worker pool threads take them one by one until none left
+    std::atomic<size_t> m_nextRootNode;
+    std::vector<std::vector<TreeNode*>> m_threadNodeStacks;
+
+    // Models with bone collision are updated after parallel stage, physics calls stay on main thread
+    std::vector<Model*> m_collisionModels;
+    std::vector<std::vector<Model*>> m_threadCollisionModels;
+
+    // Skinned models far from camera or not drawn in previous frame are animated at reduced rate
+    float m_animationLODDistance;
+    bool m_animationLODFreeze;
+    std::atomic<unsigned int> m_animationFull;
+    std::atomic<unsigned int> m_animationThrottled;
+    std::atomic<unsigned int> m_animationSkipped;
+    unsigned int m_animationStats[3U]; // Counters of last frame
+
+    // Static bone bodies of far models sleep if no awake dynamic body is near
+    float m_collisionSleepDistance;
+    unsigned int m_collisionStats[3U]; // Moved, unchanged and sleeping bone bodies of last frame
+
     LuaArguments *m_argument;
     OnPreRender m_callback;
 
+    static void UpdateJob(void *f_manager, unsigned int f_thread);
+    void UpdateHierarchies(std::vector<TreeNode*> &f_nodeStack, std::vector<Model*> &f_collisionModels);
+    void FillQueryResult(std::vector<Model*> &f_models);
+    unsigned int GetAnimationInterval(Model *f_model) const;
+    bool IsCollisionSleepAllowed(Model *f_model);
+
     PreRenderManager(const PreRenderManager& that);
     PreRenderManager &operator =(const PreRenderManager &that);
 public:
     inline void SetPreRenderCallback(OnPreRender f_callback) { m_callback = f_callback; }
+
+    void SetAnimationLOD(float f_distance, bool f_freeze);
+    void GetAnimationLODStats(unsigned int &f_full, unsigned int &f_throttled, unsigned int &f_skipped) const;
+    inline void SetCollisionSleepDistance(float f_distance) { m_collisionSleepDistance = std::max(f_distance, 0.f); }
+    inline float GetCollisionSleepDistance() const { return m_collisionSleepDistance; }
+    void GetCollisionStats(unsigned int &f_updated, unsigned int &f_unchanged, unsigned int &f_sleeping) const;
+
+    void GetModelsInFrustum(Camera *f_camera, std::vector<Model*> &f_models);
+    void GetModelsInRadius(const glm::vec3 &f_pos, float f_radius, std::vector<Model*> &f_models);
+    void GetModelsInBox(const glm::vec3 &f_min, const glm::vec3 &f_max, std::vector<Model*> &f_models);
 protected:
     explicit PreRenderManager(Core *f_core);
     ~PreRenderManager();
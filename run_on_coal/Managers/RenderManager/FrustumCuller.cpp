@@ -0,0 +1,130 @@
+#include "stdafx.h"
+
+#include "Managers/RenderManager/FrustumCuller.h"
+#include "Elements/Camera.h"
+#include "Elements/Model/Model.h"
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1)) || defined(__SSE__)
+#define ROC_FRUSTUMCULLER_SSE
+#include <xmmintrin.h>
+#endif
+
+#define ROC_FRUSTUMCULLER_BLOCK_SIZE 4U
+#define ROC_FRUSTUMCULLER_BLOCK_FLOATS 24U
+
+ROC::FrustumCuller::FrustumCuller()
+{
+    m_camera = nullptr;
+    m_frustumVersion = 0U;
+    m_valid = false;
+}
+ROC::FrustumCuller::~FrustumCuller()
+{
+    m_models.clear();
+    m_bounds.clear();
+    m_visibility.clear();
+}
+
+void ROC::FrustumCuller::AddModel(Model *f_model)
+{
+    f_model->m_cullingIndex = m_models.size();
+    m_models.push_back(f_model);
+    m_valid = false;
+}
+void ROC::FrustumCuller::RemoveModel(Model *f_model)
+{
+    size_t l_index = f_model->m_cullingIndex;
+    if((l_index < m_models.size()) && (m_models[l_index] == f_model))
+    {
+        // Last model takes place of removed one
+        m_models[l_index] = m_models.back();
+        m_models[l_index]->m_cullingIndex = l_index;
+        m_models.pop_back();
+        m_valid = false;
+    }
+}
+
+bool ROC::FrustumCuller::IsVisible(Model *f_model, Camera *f_camera)
+{
+    if(!m_valid || (m_camera != f_camera) || (m_frustumVersion != f_camera->GetFrustumVersion())) Cull(f_camera);
+
+    bool l_result;
+    size_t l_index = f_model->m_cullingIndex;
+    if((l_index < m_models.size()) && (m_models[l_index] == f_model)) l_result = (m_visibility[l_index] != 0U);
+    else l_result = f_camera->IsInFrustum(f_model->GetBoundSphereCenter(), f_model->GetBoundSphereRadius());
+    return l_result;
+}
+
+void ROC::FrustumCuller::Cull(Camera *f_camera)
+{
+    size_t l_count = m_models.size();
+    size_t l_blocks = (l_count + ROC_FRUSTUMCULLER_BLOCK_SIZE - 1U) / ROC_FRUSTUMCULLER_BLOCK_SIZE;
+    m_bounds.resize(l_blocks*ROC_FRUSTUMCULLER_BLOCK_FLOATS);
+    m_visibility.resize(l_blocks*ROC_FRUSTUMCULLER_BLOCK_SIZE);
+
+    for(size_t i = 0U; i < l_count; i++)
+    {
+        float *l_lane = m_bounds.data() + (i / ROC_FRUSTUMCULLER_BLOCK_SIZE)*ROC_FRUSTUMCULLER_BLOCK_FLOATS + (i % ROC_FRUSTUMCULLER_BLOCK_SIZE);
+        const glm::vec3 &l_center = m_models[i]->GetBoundBoxCenter();
+        const glm::vec3 &l_extent = m_models[i]->GetBoundBoxExtent();
+        for(size_t j = 0U; j < 3U; j++)
+        {
+            l_lane[j*ROC_FRUSTUMCULLER_BLOCK_SIZE] = l_center[j];
+            l_lane[(j + 3U)*ROC_FRUSTUMCULLER_BLOCK_SIZE] = l_extent[j];
+        }
+    }
+
+    // Box is outside when its extents projected on plane normal don't reach the plane
+    const glm::vec4 *l_planes = f_camera->GetPlanes();
+#ifdef ROC_FRUSTUMCULLER_SSE
+    __m128 l_planeData[6][7];
+    for(size_t i = 0U; i < 6U; i++)
+    {
+        for(int j = 0; j < 4; j++) l_planeData[i][j] = _mm_set1_ps(l_planes[i][j]);
+        for(int j = 0; j < 3; j++) l_planeData[i][4 + j] = _mm_set1_ps(std::abs(l_planes[i][j]));
+    }
+
+    const __m128 l_zero = _mm_setzero_ps();
+    for(size_t i = 0U; i < l_blocks; i++)
+    {
+        const float *l_block = m_bounds.data() + i*ROC_FRUSTUMCULLER_BLOCK_FLOATS;
+        __m128 l_centerX = _mm_loadu_ps(l_block);
+        __m128 l_centerY = _mm_loadu_ps(l_block + 4);
+        __m128 l_centerZ = _mm_loadu_ps(l_block + 8);
+        __m128 l_extentX = _mm_loadu_ps(l_block + 12);
+        __m128 l_extentY = _mm_loadu_ps(l_block + 16);
+        __m128 l_extentZ = _mm_loadu_ps(l_block + 20);
+
+        __m128 l_inside = _mm_cmpeq_ps(l_zero, l_zero);
+        for(size_t j = 0U; j < 6U; j++)
+        {
+            const __m128 *l_plane = l_planeData[j];
+            __m128 l_distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l_centerX, l_plane[0]), _mm_mul_ps(l_centerY, l_plane[1])), _mm_add_ps(_mm_mul_ps(l_centerZ, l_plane[2]), l_plane[3]));
+            __m128 l_radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l_extentX, l_plane[4]), _mm_mul_ps(l_extentY, l_plane[5])), _mm_mul_ps(l_extentZ, l_plane[6]));
+            l_inside = _mm_and_ps(l_inside, _mm_cmpge_ps(_mm_add_ps(l_distance, l_radius), l_zero));
+        }
+
+        int l_mask = _mm_movemask_ps(l_inside);
+        unsigned char *l_visibility = m_visibility.data() + i*ROC_FRUSTUMCULLER_BLOCK_SIZE;
+        for(int j = 0; j < 4; j++) l_visibility[j] = static_cast<unsigned char>((l_mask >> j) & 1);
+    }
+#else
+    for(size_t i = 0U; i < l_count; i++)
+    {
+        const float *l_lane = m_bounds.data() + (i / ROC_FRUSTUMCULLER_BLOCK_SIZE)*ROC_FRUSTUMCULLER_BLOCK_FLOATS + (i % ROC_FRUSTUMCULLER_BLOCK_SIZE);
+        bool l_inside = true;
+        for(size_t j = 0U; (j < 6U) && l_inside; j++)
+        {
+            const glm::vec4 &l_plane = l_planes[j];
+            float l_distance = l_plane.x*l_lane[0] + l_plane.y*l_lane[4] + l_plane.z*l_lane[8] + l_plane.w;
+            float l_radius = std::abs(l_plane.x)*l_lane[12] + std::abs(l_plane.y)*l_lane[16] + std::abs(l_plane.z)*l_lane[20];
+            l_inside = (l_distance + l_radius >= 0.f);
+        }
+        m_visibility[i] = l_inside ? 1U : 0U;
+    }
+#endif
+
+    m_camera = f_camera;
+    m_frustumVersion = f_camera->GetFrustumVersion();
+    m_valid = true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+namespace ROC
+{
+
+class Camera;
+class Model;
+
+class FrustumCuller final
+{
+    std::vector<Model*> m_models;
+
+    // Bounds are laid out in blocks of four models: centers x, y, z, then extents x, y, z
+    std::vector<float> m_bounds;
+    std::vector<unsigned char> m_visibility;
+
+    Camera *m_camera;
+    unsigned int m_frustumVersion;
+    bool m_valid;
+
+    void Cull(Camera *f_camera);
+
+    FrustumCuller(const FrustumCuller &that);
+    FrustumCuller &operator =(const FrustumCuller &that);
+protected:
+    FrustumCuller();
+    ~FrustumCuller();
+
+    void AddModel(Model *f_model);
+    void RemoveModel(Model *f_model);
+
+    // Results are kept until next frame, model registration or another camera state
+    inline void Invalidate() { m_valid = false; }
+    bool IsVisible(Model *f_model, Camera *f_camera);
+
+    friend class RenderManager;
+};
+
+}
@@ -0,0 +1,233 @@
+#include "stdafx.h"
+
+#include "Managers/RenderManager/OcclusionCuller.h"
+#include "Elements/Camera.h"
+#include "Elements/Model/Model.h"
+#include "Elements/RenderTarget.h"
+
+#define ROC_OCCLUSION_MIN_W 0.0001f
+
+ROC::OcclusionCuller::OcclusionCuller()
+{
+    m_readbackIndex = 0U;
+    m_sourceSize = glm::ivec2(0);
+    m_viewProjection = glm::mat4(1.f);
+    m_ready = false;
+
+    m_enabled = false;
+    m_camera = nullptr;
+    m_target = nullptr;
+    m_multisampled = false;
+
+    m_culledCount = 0U;
+    m_visibleCount = 0U;
+    m_lastCulledCount = 0U;
+    m_lastVisibleCount = 0U;
+}
+ROC::OcclusionCuller::~OcclusionCuller()
+{
+    ReleaseBuffers();
+}
+
+void ROC::OcclusionCuller::ReleaseBuffers()
+{
+    for(auto &iter : m_readbacks)
+    {
+        if(iter.m_buffer != 0U)
+        {
+            glDeleteBuffers(1, &iter.m_buffer);
+            iter.m_buffer = 0U;
+        }
+        iter.m_size = glm::ivec2(0);
+        iter.m_pending = false;
+    }
+    m_levels.clear();
+    m_levelSizes.clear();
+    m_ready = false;
+}
+
+void ROC::OcclusionCuller::SetSource(bool f_state, Camera *f_camera, RenderTarget *f_target)
+{
+    if(f_state && f_camera)
+    {
+        if((m_camera != f_camera) || (m_target != f_target))
+        {
+            // Depth of previous source doesn't match new view
+            for(auto &iter : m_readbacks) iter.m_pending = false;
+            m_ready = false;
+        }
+        if(!m_enabled || (m_target != f_target))
+        {
+            // Sample buffers are reported for draw framebuffer only
+            GLint l_drawFramebuffer = 0;
+            GLint l_sampleBuffers = 0;
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &l_drawFramebuffer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, f_target ? f_target->GetFramebufferID() : 0U);
+            glGetIntegerv(GL_SAMPLE_BUFFERS, &l_sampleBuffers);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(l_drawFramebuffer));
+            m_multisampled = (l_sampleBuffers > 0);
+        }
+        m_camera = f_camera;
+        m_target = f_target;
+        m_enabled = true;
+    }
+    else
+    {
+        m_enabled = false;
+        m_camera = nullptr;
+        m_target = nullptr;
+        m_multisampled = false;
+        ReleaseBuffers();
+    }
+}
+void ROC::OcclusionCuller::RemoveSource(Element *f_element)
+{
+    if((m_camera == f_element) || (m_target == f_element)) SetSource(false, nullptr, nullptr);
+}
+
+bool ROC::OcclusionCuller::IsOccluded(Model *f_model, Camera *f_camera)
+{
+    bool l_result = false;
+    if(m_ready && (m_camera == f_camera))
+    {
+        // Screen rectangle and nearest depth of box as it was seen in captured frame
+        const glm::vec3 &l_center = f_model->GetBoundBoxCenter();
+        const glm::vec3 &l_extent = f_model->GetBoundBoxExtent();
+        glm::vec2 l_rectMin(std::numeric_limits<float>::max());
+        glm::vec2 l_rectMax(-std::numeric_limits<float>::max());
+        float l_minDepth = 1.f;
+        bool l_testable = true;
+        for(int i = 0; (i < 8) && l_testable; i++)
+        {
+            glm::vec3 l_corner(((i & 1) ? l_extent.x : -l_extent.x), ((i & 2) ? l_extent.y : -l_extent.y), ((i & 4) ? l_extent.z : -l_extent.z));
+            glm::vec4 l_clip = m_viewProjection*glm::vec4(l_center + l_corner, 1.f);
+            if(l_clip.w > ROC_OCCLUSION_MIN_W)
+            {
+                glm::vec3 l_ndc = glm::vec3(l_clip) / l_clip.w;
+                l_rectMin = glm::min(l_rectMin, glm::vec2(l_ndc));
+                l_rectMax = glm::max(l_rectMax, glm::vec2(l_ndc));
+                l_minDepth = std::min(l_minDepth, l_ndc.z*0.5f + 0.5f);
+            }
+            else l_testable = false; // Box crosses camera plane
+        }
+        if(l_testable) l_testable = ((l_rectMax.x >= -1.f) && (l_rectMin.x <= 1.f) && (l_rectMax.y >= -1.f) && (l_rectMin.y <= 1.f));
+
+        if(l_testable)
+        {
+            glm::vec2 l_pixelMin = (glm::clamp(l_rectMin, -1.f, 1.f)*0.5f + 0.5f)*glm::vec2(m_sourceSize);
+            glm::vec2 l_pixelMax = (glm::clamp(l_rectMax, -1.f, 1.f)*0.5f + 0.5f)*glm::vec2(m_sourceSize);
+
+            // Coarsest level where rectangle covers only few texels
+            size_t l_level = 0U;
+            glm::ivec2 l_texelMin, l_texelMax;
+            while(true)
+            {
+                float l_scale = static_cast<float>(2U << l_level);
+                const glm::ivec2 &l_levelSize = m_levelSizes[l_level];
+                l_texelMin = glm::clamp(glm::ivec2(glm::floor(l_pixelMin / l_scale)), glm::ivec2(0), l_levelSize - 1);
+                l_texelMax = glm::clamp(glm::ivec2(glm::floor(l_pixelMax / l_scale)), glm::ivec2(0), l_levelSize - 1);
+                bool l_fits = (((l_texelMax.x - l_texelMin.x) < ROC_OCCLUSION_MAX_FOOTPRINT) && ((l_texelMax.y - l_texelMin.y) < ROC_OCCLUSION_MAX_FOOTPRINT));
+                if(l_fits || (l_level + 1U >= m_levels.size())) break;
+                l_level++;
+            }
+
+            const std::vector<float> &l_depth = m_levels[l_level];
+            int l_width = m_levelSizes[l_level].x;
+            float l_maxDepth = 0.f;
+            for(int y = l_texelMin.y; y <= l_texelMax.y; y++)
+            {
+                for(int x = l_texelMin.x; x <= l_texelMax.x; x++) l_maxDepth = std::max(l_maxDepth, l_depth[y*l_width + x]);
+            }
+            l_result = (l_minDepth > l_maxDepth);
+        }
+        l_result ? m_culledCount++ : m_visibleCount++;
+    }
+    return l_result;
+}
+
+void ROC::OcclusionCuller::BuildPyramid(const float *f_depth, const glm::ivec2 &f_size)
+{
+    m_sourceSize = f_size;
+    m_levelSizes.clear();
+    glm::ivec2 l_size = f_size;
+    do
+    {
+        l_size = (l_size + 1) / 2;
+        m_levelSizes.push_back(l_size);
+    } while((l_size.x > 1) || (l_size.y > 1));
+    m_levels.resize(m_levelSizes.size());
+
+    for(size_t i = 0U, j = m_levels.size(); i < j; i++)
+    {
+        const float *l_source = (i == 0U) ? f_depth : m_levels[i - 1U].data();
+        const glm::ivec2 &l_sourceSize = (i == 0U) ? f_size : m_levelSizes[i - 1U];
+        const glm::ivec2 &l_levelSize = m_levelSizes[i];
+        std::vector<float> &l_level = m_levels[i];
+        l_level.resize(static_cast<size_t>(l_levelSize.x*l_levelSize.y));
+
+        for(int y = 0; y < l_levelSize.y; y++)
+        {
+            const float *l_row0 = l_source + (y*2)*l_sourceSize.x;
+            const float *l_row1 = l_source + std::min(y*2 + 1, l_sourceSize.y - 1)*l_sourceSize.x;
+            float *l_target = l_level.data() + y*l_levelSize.x;
+            for(int x = 0; x < l_levelSize.x; x++)
+            {
+                int l_x0 = x*2;
+                int l_x1 = std::min(l_x0 + 1, l_sourceSize.x - 1);
+                l_target[x] = std::max(std::max(l_row0[l_x0], l_row0[l_x1]), std::max(l_row1[l_x0], l_row1[l_x1]));
+            }
+        }
+    }
+}
+
+void ROC::OcclusionCuller::Capture(const glm::ivec2 &f_windowSize, GLuint f_activeFramebuffer)
+{
+    // Reading depth of multisampled framebuffer fails with GL_INVALID_OPERATION
+    if(m_enabled && !m_multisampled)
+    {
+        glm::ivec2 l_size = m_target ? m_target->GetSize() : f_windowSize;
+        if((l_size.x > 0) && (l_size.y > 0))
+        {
+            ocReadback &l_readback = m_readbacks[m_readbackIndex];
+            if(l_readback.m_buffer == 0U) glGenBuffers(1, &l_readback.m_buffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, l_readback.m_buffer);
+            if(l_readback.m_size != l_size)
+            {
+                glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(l_size.x*l_size.y)*sizeof(float), NULL, GL_STREAM_READ);
+                l_readback.m_size = l_size;
+            }
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_target ? m_target->GetFramebufferID() : 0U);
+            glReadPixels(0, 0, l_size.x, l_size.y, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, f_activeFramebuffer);
+            std::memcpy(&l_readback.m_viewProjection, &m_camera->GetViewProjectionMatrix(), sizeof(glm::mat4));
+            l_readback.m_pending = true;
+        }
+
+        // Oldest readback had whole frame to complete
+        m_readbackIndex = (m_readbackIndex + 1U) % ROC_OCCLUSION_READBACK_COUNT;
+        ocReadback &l_oldest = m_readbacks[m_readbackIndex];
+        if(l_oldest.m_pending)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, l_oldest.m_buffer);
+            GLsizeiptr l_dataSize = static_cast<GLsizeiptr>(l_oldest.m_size.x*l_oldest.m_size.y)*sizeof(float);
+            const float *l_depth = reinterpret_cast<const float*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, l_dataSize, GL_MAP_READ_BIT));
+            if(l_depth)
+            {
+                BuildPyramid(l_depth, l_oldest.m_size);
+                std::memcpy(&m_viewProjection, &l_oldest.m_viewProjection, sizeof(glm::mat4));
+                m_ready = true;
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            l_oldest.m_pending = false;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0U);
+    }
+}
+
+void ROC::OcclusionCuller::ResetCounters()
+{
+    m_lastCulledCount = m_culledCount;
+    m_lastVisibleCount = m_visibleCount;
+    m_culledCount = 0U;
+    m_visibleCount = 0U;
+}
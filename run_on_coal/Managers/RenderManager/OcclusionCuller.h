@@ -0,0 +1,67 @@
+#pragma once
+
+#define ROC_OCCLUSION_READBACK_COUNT 2U
+#define ROC_OCCLUSION_MAX_FOOTPRINT 4
+
+namespace ROC
+{
+
+class Camera;
+class Element;
+class Model;
+class RenderTarget;
+
+// Hierarchical depth of earlier frame, read back through pixel buffers without stalling
+class OcclusionCuller final
+{
+    struct ocReadback
+    {
+        GLuint m_buffer = 0U;
+        glm::ivec2 m_size = glm::ivec2(0);
+        glm::mat4 m_viewProjection;
+        bool m_pending = false;
+    };
+    ocReadback m_readbacks[ROC_OCCLUSION_READBACK_COUNT];
+    size_t m_readbackIndex;
+
+    // Level 0 is half of source size, every next level keeps maximal depth of 2x2 texels
+    std::vector<std::vector<float>> m_levels;
+    std::vector<glm::ivec2> m_levelSizes;
+    glm::ivec2 m_sourceSize;
+    glm::mat4 m_viewProjection;
+    bool m_ready;
+
+    bool m_enabled;
+    Camera *m_camera;
+    RenderTarget *m_target;
+    bool m_multisampled; // Depth of multisampled source can't be read back, models are never culled
+
+    unsigned int m_culledCount;
+    unsigned int m_visibleCount;
+    unsigned int m_lastCulledCount;
+    unsigned int m_lastVisibleCount;
+
+    void BuildPyramid(const float *f_depth, const glm::ivec2 &f_size);
+    void ReleaseBuffers();
+
+    OcclusionCuller(const OcclusionCuller &that);
+    OcclusionCuller &operator =(const OcclusionCuller &that);
+protected:
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    void SetSource(bool f_state, Camera *f_camera, RenderTarget *f_target);
+    void RemoveSource(Element *f_element);
+    inline bool IsEnabled() const { return m_enabled; }
+
+    bool IsOccluded(Model *f_model, Camera *f_camera);
+
+    void Capture(const glm::ivec2 &f_windowSize, GLuint f_activeFramebuffer);
+    void ResetCounters();
+    inline unsigned int GetCulledCount() const { return m_lastCulledCount; }
+    inline unsigned int GetVisibleCount() const { return m_lastVisibleCount; }
+
+    friend class RenderManager;
+};
+
+}
@@ -2,8 +2,11 @@
 
 #include "Managers/RenderManager/RenderManager.h"
 #include "Core/Core.h"
+#include "Managers/RenderManager/FrustumCuller.h"
+#include "Managers/RenderManager/OcclusionCuller.h"
 #include "Managers/RenderManager/Quad2D.h"
 #include "Managers/RenderManager/Quad3D.h"
+#include "Managers/RenderManager/RenderQueue.h"
 #include "Elements/Font.h"
 #include "Elements/Geometry/Geometry.h"
 #include "Elements/Geometry/Material.h"
@@ -17,6 +20,7 @@
 #include "Lua/LuaArguments.h"
 #include "Utils/Pool.h"
 
+#include "Managers/ConfigManager.h"
 #include "Managers/EventManager.h"
 #include "Managers/LuaManager.h"
 #include "Managers/SfmlManager.h"
@@ -49,7 +53,10 @@ ROC::RenderManager::RenderManager(Core *f_core)
 
     Font::CreateLibrary();
     Font::CreateVAO();
+    Skeleton::SetPalette(m_core->GetConfigManager()->GetBonesPalette());
     Shader::CreateBonesUBO();
+    Material::CreateInstanceVBO();
+    Texture::SetSampling(m_core->GetConfigManager()->IsMipmapsEnabled(), m_core->GetConfigManager()->GetAnisotropy());
 
     m_activeScene = nullptr;
     m_activeShader = nullptr;
@@ -60,6 +67,11 @@ ROC::RenderManager::RenderManager(Core *f_core)
     m_dummyTexture = new Texture();
     m_dummyTexture->LoadDummy();
 
+    m_renderQueue = new RenderQueue();
+    m_frustumCuller = new FrustumCuller();
+    m_occlusionCuller = new OcclusionCuller();
+    m_queueEnabled = false;
+
     m_lastVAO = 0U;
     m_lastTexture = 0U;
     m_depthEnabled = true;
@@ -87,16 +99,21 @@ ROC::RenderManager::~RenderManager()
     delete m_quad2D;
     delete m_quad3D;
     delete m_dummyTexture;
+    delete m_renderQueue;
+    delete m_frustumCuller;
+    delete m_occlusionCuller;
     delete m_argument;
     Font::DestroyVAO();
     Font::DestroyLibrary();
     Shader::DestroyBonesUBO();
+    Material::DestroyInstanceVBO();
 }
 
 void ROC::RenderManager::SetActiveTarget(RenderTarget *f_rt)
 {
     if(!m_locked && (m_activeTarget != f_rt))
     {
+        FlushRenderQueue();
         m_activeTarget = f_rt;
         if(!m_activeTarget)
         {
@@ -131,6 +148,7 @@ void ROC::RenderManager::SetActiveScene(Scene *f_scene)
 {
     if(!m_locked)
     {
+        FlushRenderQueue();
         m_activeScene = f_scene;
         if(m_activeScene)
         {
@@ -161,6 +179,7 @@ void ROC::RenderManager::SetActiveShader(Shader *f_shader)
 {
     if(!m_locked)
     {
+        FlushRenderQueue();
         if(m_activeShader) m_activeShader->Disable();
         m_activeShader = f_shader;
         if(m_activeShader)
@@ -184,6 +203,25 @@ void ROC::RenderManager::DisableActiveShader()
     if(m_activeShader) m_activeShader->Disable();
 }
 
+void ROC::RenderManager::AddModel(Model *f_model)
+{
+    m_frustumCuller->AddModel(f_model);
+    if(f_model->HasSkeleton()) m_skinnedModels.push_back(f_model);
+}
+void ROC::RenderManager::RemoveModel(Model *f_model)
+{
+    m_frustumCuller->RemoveModel(f_model);
+    if(f_model->HasSkeleton())
+    {
+        auto iter = std::find(m_skinnedModels.begin(), m_skinnedModels.end(), f_model);
+        if(iter != m_skinnedModels.end())
+        {
+            *iter = m_skinnedModels.back();
+            m_skinnedModels.pop_back();
+        }
+    }
+}
+
 void ROC::RenderManager::AddMovie(Movie *f_movie)
 {
     if(std::find(m_movieVector.begin(), m_movieVectorEnd, f_movie) == m_movieVectorEnd)
@@ -210,52 +248,110 @@ void ROC::RenderManager::Render(Model *f_model, bool f_frustum, bool f_texturize
         if(f_frustum)
         {
             Camera *l_camera = m_activeScene->GetCamera();
+            // All registered models are tested at once on first call for current camera state
             if(l_camera)
             {
-                if(!l_camera->IsInFrustum(f_model->GetGlobalMatrix(), f_model->GetBoundSphereRadius())) l_result = false;
+                l_result = m_frustumCuller->IsVisible(f_model, l_camera);
+                if(l_result && m_occlusionCuller->IsEnabled()) l_result = !m_occlusionCuller->IsOccluded(f_model, l_camera);
             }
         }
         if(l_result)
         {
-            m_activeShader->SetModelMatrix(f_model->GetGlobalMatrix());
+            float l_distance = 0.f;
+            Camera *l_camera = m_activeScene->GetCamera();
+            if(l_camera) l_distance = glm::distance(l_camera->GetPosition(), f_model->GetBoundSphereCenter());
 
-            if(f_model->HasSkeleton())
-            {
-                Shader::SetBoneMatrices(f_model->GetSkeleton()->GetPoseMatrices());
-                m_activeShader->SetAnimated(1U);
-            }
-            else m_activeShader->SetAnimated(0U);
+            // Animation LOD of next frame uses closest draw of model
+            f_model->m_drawDistance = f_model->m_drawn ? std::min(f_model->m_drawDistance, l_distance) : l_distance;
+            f_model->m_drawn = true;
 
-            for(auto iter : f_model->GetGeometry()->GetMaterialVector())
+            if(m_queueEnabled)
             {
-                if(iter->HasDepth()) EnableDepth();
-                else
+                for(auto iter : f_model->GetGeometry()->GetMaterialVector())
                 {
-                    if(m_skipNoDepthMaterials) continue;
-                    else DisableDepth();
+                    if(!iter->HasDepth() && m_skipNoDepthMaterials) continue;
+                    GLuint l_texture = f_texturize ? (iter->HasTexture() ? iter->GetTexture() : m_dummyTexture)->GetTextureID() : 0U;
+                    m_renderQueue->Push(f_model, iter, l_texture, l_distance, f_texturize);
                 }
-                iter->IsTransparent() ? EnableBlending() : DisableBlending();
-                iter->IsDoubleSided() ? DisableCulling() : EnableCulling();
-
-                Texture *l_texture = iter->HasTexture() ? iter->GetTexture() : m_dummyTexture;
-
-                m_materialBind.x = CompareLastTexture(l_texture->GetTextureID()) && f_texturize;
-                if(m_materialBind.x) l_texture->Bind();
-                m_materialBind.y = CompareLastVAO(iter->GetVAO());
-                if(m_materialBind.y)
+            }
+            else
+            {
+                SetModelState(f_model);
+                for(auto iter : f_model->GetGeometry()->GetMaterialVector())
                 {
-                    m_activeShader->SetMaterialType(static_cast<int>(iter->GetType()));
-                    m_activeShader->SetMaterialParam(iter->GetParams());
+                    if(!iter->HasDepth() && m_skipNoDepthMaterials) continue;
+                    DrawMaterial(iter, f_texturize);
                 }
-                iter->Draw(m_materialBind.y);
             }
         }
     }
 }
+void ROC::RenderManager::UploadBoneMatrices()
+{
+    if(!m_skinnedModels.empty())
+    {
+        // Poses are final after pre-render, all of them are written at once and draws only bind own range
+        size_t l_size = 0U;
+        for(auto iter : m_skinnedModels)
+        {
+            iter->m_boneOffset = l_size;
+            l_size += Shader::GetBonesDataStride(iter->GetSkeleton()->GetPoseData().size());
+        }
+        l_size += Shader::GetBonesBlockSize();
+
+        unsigned char *l_data = reinterpret_cast<unsigned char*>(Shader::MapBonesData(l_size));
+        if(l_data)
+        {
+            for(auto iter : m_skinnedModels)
+            {
+                const std::vector<glm::vec4> &l_poseData = iter->GetSkeleton()->GetPoseData();
+                size_t l_dataSize = std::min(l_poseData.size()*sizeof(glm::vec4), Shader::GetBonesBlockSize());
+                std::memcpy(l_data + iter->m_boneOffset, l_poseData.data(), l_dataSize);
+            }
+            Shader::UnmapBonesData();
+        }
+        else
+        {
+            for(auto iter : m_skinnedModels) iter->m_boneOffset = std::numeric_limits<size_t>::max();
+        }
+    }
+}
+void ROC::RenderManager::SetModelState(Model *f_model)
+{
+    m_activeShader->SetModelMatrix(f_model->GetGlobalMatrix());
+    m_activeShader->SetInstanced(0U);
+
+    // Models created during current frame have no uploaded pose yet
+    if(f_model->HasSkeleton() && (f_model->m_boneOffset != std::numeric_limits<size_t>::max()))
+    {
+        Shader::BindBonesData(f_model->m_boneOffset);
+        m_activeShader->SetAnimated(1U);
+    }
+    else m_activeShader->SetAnimated(0U);
+}
+void ROC::RenderManager::DrawMaterial(Material *f_material, bool f_texturize, unsigned int f_instances)
+{
+    f_material->HasDepth() ? EnableDepth() : DisableDepth();
+    f_material->IsTransparent() ? EnableBlending() : DisableBlending();
+    f_material->IsDoubleSided() ? DisableCulling() : EnableCulling();
+
+    Texture *l_texture = f_material->HasTexture() ? f_material->GetTexture() : m_dummyTexture;
+
+    m_materialBind.x = CompareLastTexture(l_texture->GetTextureID()) && f_texturize;
+    if(m_materialBind.x) l_texture->Bind();
+    m_materialBind.y = CompareLastVAO(f_material->GetVAO());
+    if(m_materialBind.y)
+    {
+        m_activeShader->SetMaterialType(static_cast<int>(f_material->GetType()));
+        m_activeShader->SetMaterialParam(f_material->GetParams());
+    }
+    (f_instances > 1U) ? f_material->DrawInstanced(m_materialBind.y, f_instances) : f_material->Draw(m_materialBind.y);
+}
 void ROC::RenderManager::Render(Font *f_font, const glm::vec2 &f_pos, const sf::String &f_text, const glm::vec4 &f_color)
 {
     if(!m_locked && m_activeShader)
     {
+        FlushRenderQueue();
         EnableBlending();
         DisableDepth();
 
@@ -272,6 +368,7 @@ void ROC::RenderManager::Render(Drawable *f_drawable, const glm::vec2 &f_pos, co
 {
     if(!m_locked && m_activeShader)
     {
+        FlushRenderQueue();
         if(CompareLastVAO(m_quad2D->GetVAO())) m_quad2D->Bind();
         if(CompareLastTexture(f_drawable->GetTextureID())) f_drawable->Bind();
 
@@ -310,12 +407,14 @@ void ROC::RenderManager::Render(Drawable *f_drawable, const glm::vec3 &f_pos, co
             float l_radius = glm::length(l_halfSize);
             if(l_camera->IsInFrustum(f_pos, l_radius))
             {
+                FlushRenderQueue();
                 if(CompareLastVAO(m_quad3D->GetVAO())) m_quad3D->Bind();
                 if(CompareLastTexture(f_drawable->GetTextureID())) f_drawable->Bind();
 
                 m_quad3D->SetTransformation(f_pos, f_rot, f_size);
 
                 m_activeShader->SetAnimated(0U);
+                m_activeShader->SetInstanced(0U);
                 m_activeShader->SetModelMatrix(m_quad3D->GetMatrixRef());
                 m_activeShader->SetMaterialParam(g_EmptyVec4);
 
@@ -339,6 +438,7 @@ void ROC::RenderManager::ClearRenderArea(bool f_depth, bool f_color)
 {
     if(!m_locked)
     {
+        FlushRenderQueue();
         int l_params = 0;
         if(f_depth)
         {
@@ -349,6 +449,94 @@ void ROC::RenderManager::ClearRenderArea(bool f_depth, bool f_color)
         glClear(l_params);
     }
 }
+void ROC::RenderManager::SetViewport(const glm::ivec4 &f_area)
+{
+    FlushRenderQueue();
+    glViewport(f_area.r, f_area.g, f_area.b, f_area.a);
+}
+void ROC::RenderManager::SetPolygonMode(int f_mode)
+{
+    FlushRenderQueue();
+    glPolygonMode(GL_FRONT_AND_BACK, GL_POINT + f_mode);
+}
+
+void ROC::RenderManager::SetRenderQueueEnabled(bool f_state)
+{
+    if(m_queueEnabled != f_state)
+    {
+        if(!f_state) FlushRenderQueue();
+        m_queueEnabled = f_state;
+    }
+}
+void ROC::RenderManager::SetOcclusionCulling(bool f_state, Camera *f_camera, RenderTarget *f_target)
+{
+    m_occlusionCuller->SetSource(f_state, f_camera, f_target);
+}
+bool ROC::RenderManager::GetOcclusionCulling() const
+{
+    return m_occlusionCuller->IsEnabled();
+}
+void ROC::RenderManager::GetOcclusionStats(unsigned int &f_culled, unsigned int &f_visible) const
+{
+    f_culled = m_occlusionCuller->GetCulledCount();
+    f_visible = m_occlusionCuller->GetVisibleCount();
+}
+void ROC::RenderManager::RemoveAsOcclusionSource(Element *f_element)
+{
+    m_occlusionCuller->RemoveSource(f_element);
+}
+
+void ROC::RenderManager::FlushRenderQueue()
+{
+    if(!m_renderQueue->IsEmpty())
+    {
+        m_renderQueue->Sort();
+
+        bool l_instancing = (Material::IsInstancingSupported() && m_activeShader->IsInstancingSupported());
+        Model *l_lastModel = nullptr;
+        for(size_t i = 0U, j = m_renderQueue->GetSize(); i < j;)
+        {
+            const RenderQueue::rqDrawCall &l_drawCall = m_renderQueue->GetDrawCall(i);
+
+            // Consecutive static models with the same material are merged into one instanced draw
+            size_t l_batchEnd = i + 1U;
+            if(l_instancing && !l_drawCall.m_model->HasSkeleton())
+            {
+                while((l_batchEnd < j) && ((l_batchEnd - i) < ROC_MATERIAL_INSTANCES_COUNT))
+                {
+                    const RenderQueue::rqDrawCall &l_nextCall = m_renderQueue->GetDrawCall(l_batchEnd);
+                    if((l_nextCall.m_material != l_drawCall.m_material) || (l_nextCall.m_texturize != l_drawCall.m_texturize) || l_nextCall.m_model->HasSkeleton()) break;
+                    l_batchEnd++;
+                }
+            }
+
+            if(l_batchEnd - i > 1U)
+            {
+                m_instanceMatrices.clear();
+                for(size_t k = i; k < l_batchEnd; k++) m_instanceMatrices.push_back(m_renderQueue->GetDrawCall(k).m_model->GetGlobalMatrix());
+                Material::SetInstanceMatrices(m_instanceMatrices);
+
+                m_activeShader->SetAnimated(0U);
+                m_activeShader->SetInstanced(1U);
+                l_lastModel = nullptr;
+
+                DrawMaterial(l_drawCall.m_material, l_drawCall.m_texturize, static_cast<unsigned int>(l_batchEnd - i));
+            }
+            else
+            {
+                if(l_drawCall.m_model != l_lastModel)
+                {
+                    SetModelState(l_drawCall.m_model);
+                    l_lastModel = l_drawCall.m_model;
+                }
+                DrawMaterial(l_drawCall.m_material, l_drawCall.m_texturize);
+            }
+            i = l_batchEnd;
+        }
+        m_activeShader->SetInstanced(0U);
+        m_renderQueue->Clear();
+    }
+}
 
 void ROC::RenderManager::DisableDepth()
 {
@@ -417,12 +605,23 @@ void ROC::RenderManager::DoPulse()
     m_time = m_core->GetSfmlManager()->GetTime();
 
     ResetCallsReducing();
+    m_frustumCuller->Invalidate();
+    m_occlusionCuller->ResetCounters();
+    UploadBoneMatrices();
     for(auto iter : m_movieVector) iter->Update();
 
     m_locked = false;
     if(m_callback) (*m_callback)();
 
     m_core->GetLuaManager()->GetEventManager()->CallEvent("onRender", m_argument);
+    FlushRenderQueue();
+    if(m_occlusionCuller->IsEnabled())
+    {
+        // Depth of this frame is tested against models two frames later
+        glm::ivec2 l_windowSize;
+        m_core->GetSfmlManager()->GetWindowSize(l_windowSize);
+        m_occlusionCuller->Capture(l_windowSize, m_activeTarget ? m_activeTarget->GetFramebufferID() : 0U);
+    }
     m_locked = true;
     m_core->GetSfmlManager()->SwapBuffers();
 }
@@ -4,15 +4,21 @@ namespace ROC
 {
 
 class Core;
+class Element;
 class Model;
 class Scene;
 class Shader;
 class Quad2D;
 class Quad3D;
+class RenderQueue;
+class FrustumCuller;
+class OcclusionCuller;
+class Camera;
 class Drawable;
 class Movie;
 class RenderTarget;
 class Texture;
+class Material;
 class Font;
 class LuaArguments;
 typedef void(*OnRenderCallback)(void);
@@ -36,6 +42,12 @@ class RenderManager final
     Quad2D *m_quad2D;
     Quad3D *m_quad3D;
     Texture *m_dummyTexture;
+    RenderQueue *m_renderQueue;
+    bool m_queueEnabled;
+    std::vector<glm::mat4> m_instanceMatrices;
+    FrustumCuller *m_frustumCuller;
+    OcclusionCuller *m_occlusionCuller;
+    std::vector<Model*> m_skinnedModels;
 
     std::vector<Movie*> m_movieVector;
     std::vector<Movie*>::iterator m_movieVectorEnd;
@@ -60,6 +72,10 @@ class RenderManager final
     bool CompareLastTexture(GLuint f_texture);
     void EnableNonActiveShader(Shader *f_shader) const;
 
+    void UploadBoneMatrices();
+    void SetModelState(Model *f_model);
+    void DrawMaterial(Material *f_material, bool f_texturize, unsigned int f_instances = 1U);
+
     OnRenderCallback m_callback;
 
     RenderManager(const RenderManager& that);
@@ -76,8 +92,17 @@ public:
 
     void ClearRenderArea(bool f_depth = true, bool f_color = true);
     static inline void SetClearColour(const glm::vec4 &f_color) { glClearColor(f_color.r, f_color.g, f_color.b, f_color.a); }
-    static inline void SetViewport(const glm::ivec4 &f_area) { glViewport(f_area.r, f_area.g, f_area.b, f_area.a); }
-    static inline void SetPolygonMode(int f_mode) { glPolygonMode(GL_FRONT_AND_BACK, GL_POINT + f_mode); }
+    void SetViewport(const glm::ivec4 &f_area);
+    void SetPolygonMode(int f_mode);
+
+    void SetRenderQueueEnabled(bool f_state);
+    inline bool GetRenderQueueEnabled() const { return m_queueEnabled; }
+    inline Scene* GetActiveScene() const { return m_activeScene; }
+    void FlushRenderQueue();
+
+    void SetOcclusionCulling(bool f_state, Camera *f_camera = nullptr, RenderTarget *f_target = nullptr);
+    bool GetOcclusionCulling() const;
+    void GetOcclusionStats(unsigned int &f_culled, unsigned int &f_visible) const;
 
     inline void SetRenderCallback(OnRenderCallback f_callback) { m_callback = f_callback; }
 protected:
@@ -87,10 +112,14 @@ protected:
     void RemoveAsActiveTarget(RenderTarget *f_target);
     void RemoveAsActiveScene(Scene *f_scene);
     void RemoveAsActiveShader(Shader *f_shader);
+    void RemoveAsOcclusionSource(Element *f_element);
 
     void EnableActiveShader();
     void DisableActiveShader();
 
+    void AddModel(Model *f_model);
+    void RemoveModel(Model *f_model);
+
     void AddMovie(Movie *f_movie);
     void RemoveMovie(Movie *f_movie);
 
@@ -0,0 +1,59 @@
+#include "stdafx.h"
+
+#include "Managers/RenderManager/RenderQueue.h"
+#include "Elements/Geometry/Material.h"
+
+#define ROC_RENDERQUEUE_TRANSPARENT_BIT (1ULL << 63)
+#define ROC_RENDERQUEUE_DOUBLESIDE_BIT (1ULL << 62)
+
+ROC::RenderQueue::RenderQueue()
+{
+}
+ROC::RenderQueue::~RenderQueue()
+{
+    m_drawCalls.clear();
+    m_sortKeys.clear();
+}
+
+void ROC::RenderQueue::Push(Model *f_model, Material *f_material, GLuint f_texture, float f_distance, bool f_texturize)
+{
+    // Positive floats keep their order when compared as unsigned integers
+    unsigned int l_depth;
+    std::memcpy(&l_depth, &f_distance, sizeof(unsigned int));
+
+    unsigned long long l_key;
+    if(f_material->IsTransparent() || !f_material->HasDepth())
+    {
+        // Blended and depthless materials go last, farthest first
+        l_key = ROC_RENDERQUEUE_TRANSPARENT_BIT;
+        l_key |= static_cast<unsigned long long>((~l_depth) >> 1) << 32;
+        l_key |= static_cast<unsigned long long>(f_texture&0xFFFFU) << 16;
+        l_key |= static_cast<unsigned long long>(f_material->GetVAO()&0xFFFFU);
+    }
+    else
+    {
+        // Opaque materials are grouped by culling state, texture and VAO, then nearest first
+        l_key = f_material->IsDoubleSided() ? ROC_RENDERQUEUE_DOUBLESIDE_BIT : 0ULL;
+        l_key |= static_cast<unsigned long long>(f_texture&0xFFFFFU) << 42;
+        l_key |= static_cast<unsigned long long>(f_material->GetVAO()&0xFFFFFU) << 22;
+        l_key |= static_cast<unsigned long long>(l_depth >> 10);
+    }
+
+    m_sortKeys.emplace_back(l_key, static_cast<unsigned int>(m_drawCalls.size()));
+
+    rqDrawCall l_drawCall;
+    l_drawCall.m_model = f_model;
+    l_drawCall.m_material = f_material;
+    l_drawCall.m_texturize = f_texturize;
+    m_drawCalls.push_back(l_drawCall);
+}
+void ROC::RenderQueue::Sort()
+{
+    // Submission index is the second pair member, equal keys keep their order
+    std::sort(m_sortKeys.begin(), m_sortKeys.end());
+}
+void ROC::RenderQueue::Clear()
+{
+    m_drawCalls.clear();
+    m_sortKeys.clear();
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+namespace ROC
+{
+
+class Model;
+class Material;
+
+class RenderQueue final
+{
+    struct rqDrawCall
+    {
+        Model *m_model = nullptr;
+        Material *m_material = nullptr;
+        bool m_texturize = true;
+    };
+    std::vector<rqDrawCall> m_drawCalls;
+    std::vector<std::pair<unsigned long long, unsigned int>> m_sortKeys;
+
+    RenderQueue(const RenderQueue &that);
+    RenderQueue &operator =(const RenderQueue &that);
+protected:
+    RenderQueue();
+    ~RenderQueue();
+
+    void Push(Model *f_model, Material *f_material, GLuint f_texture, float f_distance, bool f_texturize);
+    void Sort();
+    void Clear();
+
+    inline bool IsEmpty() const { return m_drawCalls.empty(); }
+    inline size_t GetSize() const { return m_sortKeys.size(); }
+    inline const rqDrawCall& GetDrawCall(size_t f_index) const { return m_drawCalls[m_sortKeys[f_index].second]; }
+
+    friend class RenderManager;
+};
+
+}
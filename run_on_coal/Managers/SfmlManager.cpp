@@ -8,7 +8,6 @@
 #include "Managers/EventManager.h"
 #include "Managers/LogManager.h"
 #include "Managers/LuaManager.h"
-#include "Managers/PhysicsManager.h"
 #include "Elements/Shader/Shader.h"
 #include "Utils/PathUtils.h"
 
@@ -147,7 +146,6 @@ void ROC::SfmlManager::SetFramelimit(unsigned int f_fps)
     {
         m_frameLimit = f_fps;
         m_window->setFramerateLimit(m_frameLimit);
-        m_core->GetPhysicsManager()->UpdateWorldSteps(m_frameLimit);
     }
 }
 bool ROC::SfmlManager::SetIcon(const std::string &f_path)
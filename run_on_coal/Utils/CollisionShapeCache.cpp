@@ -0,0 +1,85 @@
+#include "stdafx.h"
+
+#include "Utils/CollisionShapeCache.h"
+
+std::map<ROC::CollisionShapeCache::scKey, ROC::CollisionShapeCache::scEntry> ROC::CollisionShapeCache::ms_shapeMap;
+std::unordered_map<btCollisionShape*, std::map<ROC::CollisionShapeCache::scKey, ROC::CollisionShapeCache::scEntry>::iterator> ROC::CollisionShapeCache::ms_shapeLookup;
+std::mutex ROC::CollisionShapeCache::ms_mutex;
+
+bool ROC::CollisionShapeCache::scKey::operator<(const scKey &f_key) const
+{
+    if(m_type != f_key.m_type) return (m_type < f_key.m_type);
+    for(int i = 0; i < 3; i++)
+    {
+        if(m_size[i] != f_key.m_size[i]) return (m_size[i] < f_key.m_size[i]);
+    }
+    for(int i = 0; i < 3; i++)
+    {
+        if(m_scale[i] != f_key.m_scale[i]) return (m_scale[i] < f_key.m_scale[i]);
+    }
+    return false;
+}
+
+btCollisionShape* ROC::CollisionShapeCache::CreateShape(int f_type, const glm::vec3 &f_size)
+{
+    btCollisionShape *l_shape = nullptr;
+    switch(f_type)
+    {
+        case ST_Sphere:
+            l_shape = new btSphereShape(f_size.x);
+            break;
+        case ST_Box:
+            l_shape = new btBoxShape(btVector3(f_size.x, f_size.y, f_size.z));
+            break;
+        case ST_Cylinder:
+            l_shape = new btCylinderShape(btVector3(f_size.x, f_size.y, f_size.z));
+            break;
+        case ST_Capsule:
+            l_shape = new btCapsuleShape(f_size.x, f_size.y);
+            break;
+        case ST_Cone:
+            l_shape = new btConeShape(f_size.x, f_size.y);
+            break;
+        default:
+            l_shape = new btEmptyShape();
+            break;
+    }
+    return l_shape;
+}
+
+btCollisionShape* ROC::CollisionShapeCache::AcquireShape(int f_type, const glm::vec3 &f_size, const glm::vec3 &f_scale)
+{
+    scKey l_key;
+    l_key.m_type = ((f_type >= ST_Sphere) && (f_type <= ST_Cone)) ? f_type : ST_Empty;
+    l_key.m_size = (l_key.m_type == ST_Empty) ? glm::vec3(0.f) : f_size;
+    l_key.m_scale = (l_key.m_type == ST_Empty) ? glm::vec3(1.f) : f_scale;
+
+    std::lock_guard<std::mutex> l_lock(ms_mutex);
+    auto l_iter = ms_shapeMap.find(l_key);
+    if(l_iter == ms_shapeMap.end())
+    {
+        scEntry l_entry;
+        l_entry.m_shape = CreateShape(l_key.m_type, l_key.m_size);
+        l_entry.m_shape->setLocalScaling(btVector3(l_key.m_scale.x, l_key.m_scale.y, l_key.m_scale.z));
+        l_entry.m_references = 0U;
+        l_iter = ms_shapeMap.insert(std::make_pair(l_key, l_entry)).first;
+        ms_shapeLookup.insert(std::make_pair(l_entry.m_shape, l_iter));
+    }
+    l_iter->second.m_references++;
+    return l_iter->second.m_shape;
+}
+void ROC::CollisionShapeCache::ReleaseShape(btCollisionShape *f_shape)
+{
+    std::lock_guard<std::mutex> l_lock(ms_mutex);
+    auto l_lookupIter = ms_shapeLookup.find(f_shape);
+    if(l_lookupIter != ms_shapeLookup.end())
+    {
+        auto l_iter = l_lookupIter->second;
+        if(--l_iter->second.m_references == 0U)
+        {
+            delete l_iter->second.m_shape;
+            ms_shapeMap.erase(l_iter);
+            ms_shapeLookup.erase(l_lookupIter);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+namespace ROC
+{
+
+// Bodies with same shape type, size and scale share one shape, it's deleted with last reference
+class CollisionShapeCache final
+{
+    struct scKey
+    {
+        int m_type;
+        glm::vec3 m_size;
+        glm::vec3 m_scale;
+
+        bool operator<(const scKey &f_key) const;
+    };
+    struct scEntry
+    {
+        btCollisionShape *m_shape;
+        unsigned int m_references;
+    };
+    static std::map<scKey, scEntry> ms_shapeMap;
+    static std::unordered_map<btCollisionShape*, std::map<scKey, scEntry>::iterator> ms_shapeLookup;
+    static std::mutex ms_mutex;
+
+    static btCollisionShape* CreateShape(int f_type, const glm::vec3 &f_size);
+public:
+    // Types match Collision::CollisionType and bone collision types, unknown types give empty shape
+    enum ShapeType : int
+    {
+        ST_Empty = -1,
+        ST_Sphere,
+        ST_Box,
+        ST_Cylinder,
+        ST_Capsule,
+        ST_Cone
+    };
+
+    static btCollisionShape* AcquireShape(int f_type, const glm::vec3 &f_size, const glm::vec3 &f_scale);
+    static void ReleaseShape(btCollisionShape *f_shape);
+};
+
+}
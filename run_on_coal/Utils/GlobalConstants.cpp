@@ -17,6 +17,11 @@ extern const std::vector<std::string> g_FilteringTypesTable
     "nearest", "linear"
 };
 
+extern const std::vector<std::string> g_CollisionTypesTable
+{
+    "sphere", "box", "cylinder", "capsule", "cone"
+};
+
 extern const std::vector<std::string> g_KeyNamesTable
 {
     "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q", "r", "s", "t", "u", "v", "w", "x", "y", "z",
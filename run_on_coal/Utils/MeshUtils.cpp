@@ -0,0 +1,264 @@
+#include "stdafx.h"
+
+#include "Utils/MeshUtils.h"
+#include "Elements/Geometry/GeometryFormat.hpp"
+
+#define ROC_MESH_CACHE_SIZE 32U
+#define ROC_MESH_CACHE_DECAY_POWER 1.5f
+#define ROC_MESH_LAST_TRIANGLE_SCORE 0.75f
+#define ROC_MESH_VALENCE_BOOST_SCALE 2.f
+#define ROC_MESH_VALENCE_BOOST_POWER 0.5f
+
+namespace MeshUtils
+{
+
+static float GetVertexScore(int f_cachePosition, unsigned int f_activeTriangles)
+{
+    float l_score = -1.f;
+    if(f_activeTriangles > 0U)
+    {
+        l_score = 0.f;
+        if(f_cachePosition >= 0)
+        {
+            if(f_cachePosition < 3) l_score = ROC_MESH_LAST_TRIANGLE_SCORE;
+            else
+            {
+                float l_scaler = 1.f / static_cast<float>(ROC_MESH_CACHE_SIZE - 3U);
+                l_score = std::pow(1.f - static_cast<float>(f_cachePosition - 3)*l_scaler, ROC_MESH_CACHE_DECAY_POWER);
+            }
+        }
+        l_score += ROC_MESH_VALENCE_BOOST_SCALE*std::pow(static_cast<float>(f_activeTriangles), -ROC_MESH_VALENCE_BOOST_POWER);
+    }
+    return l_score;
+}
+
+static unsigned int PackNormal1010102(const glm::vec3 &f_normal)
+{
+    glm::ivec3 l_value = glm::ivec3(glm::round(glm::clamp(f_normal, -1.f, 1.f)*511.f));
+    return ((static_cast<unsigned int>(l_value.x) & 0x3FFU) | ((static_cast<unsigned int>(l_value.y) & 0x3FFU) << 10) | ((static_cast<unsigned int>(l_value.z) & 0x3FFU) << 20));
+}
+static glm::u16vec2 PackUVUnorm16(const glm::vec2 &f_uv)
+{
+    return glm::u16vec2(glm::uvec2(glm::round(glm::clamp(f_uv, 0.f, 1.f)*65535.f)));
+}
+static glm::u8vec4 PackWeightUnorm8(const glm::vec4 &f_weight)
+{
+    glm::ivec4 l_value = glm::ivec4(glm::round(glm::clamp(f_weight, 0.f, 1.f)*255.f));
+    int l_sum = l_value.x + l_value.y + l_value.z + l_value.w;
+    if(l_sum > 0)
+    {
+        // Keep sum exactly 255, rounding error goes to the heaviest influence
+        int l_heaviest = 0;
+        for(int i = 1; i < 4; i++)
+        {
+            if(l_value[i] > l_value[l_heaviest]) l_heaviest = i;
+        }
+        l_value[l_heaviest] = glm::clamp(l_value[l_heaviest] + 255 - l_sum, 0, 255);
+    }
+    return glm::u8vec4(l_value);
+}
+static void AddAttribute(std::vector<ROC::GeometryFileAttribute> &f_attributes, unsigned int &f_stride, unsigned char f_location, unsigned char f_size, unsigned int f_type, unsigned int f_bytes, bool f_normalized, bool f_integer)
+{
+    ROC::GeometryFileAttribute l_attribute;
+    l_attribute.m_location = f_location;
+    l_attribute.m_size = f_size;
+    l_attribute.m_normalized = (f_normalized ? 1U : 0U);
+    l_attribute.m_integer = (f_integer ? 1U : 0U);
+    l_attribute.m_type = f_type;
+    l_attribute.m_offset = f_stride;
+    f_attributes.push_back(l_attribute);
+    f_stride = (f_stride + f_bytes + 3U) & ~3U;
+}
+
+// Linear-speed vertex cache optimisation (T. Forsyth), reorders triangles in place
+void OptimizeVertexCache(std::vector<unsigned int> &f_indices, unsigned int f_vertexCount)
+{
+    size_t l_triangleCount = f_indices.size() / 3U;
+    if((l_triangleCount > 1U) && (f_vertexCount > 0U))
+    {
+        std::vector<unsigned int> l_activeCount(f_vertexCount, 0U);
+        for(auto iter : f_indices) l_activeCount[iter]++;
+
+        // Triangles adjacent to each vertex, active ones are kept at the front of its range
+        std::vector<unsigned int> l_adjacencyOffset(f_vertexCount + 1U, 0U);
+        for(unsigned int i = 0U; i < f_vertexCount; i++) l_adjacencyOffset[i + 1U] = l_adjacencyOffset[i] + l_activeCount[i];
+        std::vector<unsigned int> l_adjacency(f_indices.size());
+        std::vector<unsigned int> l_adjacencyFill(l_adjacencyOffset.begin(), l_adjacencyOffset.end() - 1);
+        for(size_t i = 0U, j = f_indices.size(); i < j; i++) l_adjacency[l_adjacencyFill[f_indices[i]]++] = static_cast<unsigned int>(i / 3U);
+
+        std::vector<float> l_vertexScore(f_vertexCount);
+        for(unsigned int i = 0U; i < f_vertexCount; i++) l_vertexScore[i] = GetVertexScore(-1, l_activeCount[i]);
+
+        std::vector<float> l_triangleScore(l_triangleCount, 0.f);
+        std::vector<bool> l_triangleAdded(l_triangleCount, false);
+        for(size_t i = 0U; i < l_triangleCount; i++)
+        {
+            for(size_t j = 0U; j < 3U; j++) l_triangleScore[i] += l_vertexScore[f_indices[i * 3U + j]];
+        }
+
+        std::vector<unsigned int> l_output;
+        l_output.reserve(f_indices.size());
+        std::vector<unsigned int> l_cache;
+        l_cache.reserve(ROC_MESH_CACHE_SIZE + 3U);
+
+        size_t l_scanPosition = 0U;
+        size_t l_bestTriangle = l_triangleCount;
+        for(size_t l_emitted = 0U; l_emitted < l_triangleCount; l_emitted++)
+        {
+            if(l_bestTriangle == l_triangleCount)
+            {
+                // Nothing adjacent to cached vertices, continue from the first unused triangle
+                while(l_triangleAdded[l_scanPosition]) l_scanPosition++;
+                l_bestTriangle = l_scanPosition;
+            }
+
+            l_triangleAdded[l_bestTriangle] = true;
+            for(size_t i = 0U; i < 3U; i++)
+            {
+                unsigned int l_vertex = f_indices[l_bestTriangle * 3U + i];
+                l_output.push_back(l_vertex);
+
+                unsigned int l_begin = l_adjacencyOffset[l_vertex];
+                unsigned int l_end = l_begin + l_activeCount[l_vertex];
+                for(unsigned int j = l_begin; j < l_end; j++)
+                {
+                    if(l_adjacency[j] == l_bestTriangle)
+                    {
+                        std::swap(l_adjacency[j], l_adjacency[l_end - 1U]);
+                        break;
+                    }
+                }
+                l_activeCount[l_vertex]--;
+
+                auto l_cacheIter = std::find(l_cache.begin(), l_cache.end(), l_vertex);
+                if(l_cacheIter != l_cache.end()) l_cache.erase(l_cacheIter);
+                l_cache.insert(l_cache.begin(), l_vertex);
+            }
+
+            for(size_t i = 0U, j = l_cache.size(); i < j; i++)
+            {
+                unsigned int l_vertex = l_cache[i];
+                float l_score = GetVertexScore((i < ROC_MESH_CACHE_SIZE) ? static_cast<int>(i) : -1, l_activeCount[l_vertex]);
+                float l_difference = l_score - l_vertexScore[l_vertex];
+                l_vertexScore[l_vertex] = l_score;
+
+                unsigned int l_begin = l_adjacencyOffset[l_vertex];
+                for(unsigned int k = l_begin, l_end = l_begin + l_activeCount[l_vertex]; k < l_end; k++) l_triangleScore[l_adjacency[k]] += l_difference;
+            }
+            if(l_cache.size() > ROC_MESH_CACHE_SIZE) l_cache.resize(ROC_MESH_CACHE_SIZE);
+
+            l_bestTriangle = l_triangleCount;
+            float l_bestScore = -1.f;
+            for(auto l_vertex : l_cache)
+            {
+                unsigned int l_begin = l_adjacencyOffset[l_vertex];
+                for(unsigned int k = l_begin, l_end = l_begin + l_activeCount[l_vertex]; k < l_end; k++)
+                {
+                    unsigned int l_triangle = l_adjacency[k];
+                    if(l_triangleScore[l_triangle] > l_bestScore)
+                    {
+                        l_bestScore = l_triangleScore[l_triangle];
+                        l_bestTriangle = l_triangle;
+                    }
+                }
+            }
+        }
+        f_indices.swap(l_output);
+    }
+}
+
+glm::i8vec4 PackNormalSnorm8(const glm::vec3 &f_normal)
+{
+    return glm::i8vec4(glm::ivec4(glm::round(glm::clamp(glm::vec4(f_normal, 0.f), -1.f, 1.f)*127.f)));
+}
+
+// Interleaves vertices with the most compact encoding that keeps the data intact
+void PackVertices(const std::vector<glm::vec3> &f_vertices, const std::vector<glm::vec2> &f_uvs, const std::vector<glm::vec3> &f_normals,
+    const std::vector<glm::vec4> &f_weights, const std::vector<glm::ivec4> &f_indices, bool f_packedNormals,
+    std::vector<ROC::GeometryFileAttribute> &f_attributes, unsigned int &f_stride, std::vector<unsigned char> &f_data)
+{
+    size_t l_count = f_vertices.size();
+    bool l_hasUV = (f_uvs.size() == l_count);
+    bool l_hasNormal = (f_normals.size() == l_count);
+    bool l_hasSkin = ((f_weights.size() == l_count) && (f_indices.size() == l_count));
+
+    bool l_uvUnorm = l_hasUV;
+    for(size_t i = 0U; l_uvUnorm && (i < l_count); i++)
+    {
+        if(glm::any(glm::lessThan(f_uvs[i], glm::vec2(0.f))) || glm::any(glm::greaterThan(f_uvs[i], glm::vec2(1.f)))) l_uvUnorm = false;
+    }
+    int l_maxBone = 0;
+    for(size_t i = 0U; l_hasSkin && (i < l_count); i++) l_maxBone = glm::max(l_maxBone, glm::max(glm::max(f_indices[i].x, f_indices[i].y), glm::max(f_indices[i].z, f_indices[i].w)));
+    bool l_boneByte = (l_maxBone <= std::numeric_limits<unsigned char>::max());
+
+    // Attribute locations match VertexFormat::VertexAttributeLocation
+    f_attributes.clear();
+    f_stride = 0U;
+    AddAttribute(f_attributes, f_stride, 0U, 3U, ROC_GEOMETRY_TYPE_FLOAT, 12U, false, false);
+    if(l_hasUV) l_uvUnorm ? AddAttribute(f_attributes, f_stride, 1U, 2U, ROC_GEOMETRY_TYPE_UNSIGNED_SHORT, 4U, true, false) : AddAttribute(f_attributes, f_stride, 1U, 2U, ROC_GEOMETRY_TYPE_FLOAT, 8U, false, false);
+    if(l_hasNormal) f_packedNormals ? AddAttribute(f_attributes, f_stride, 2U, 4U, ROC_GEOMETRY_TYPE_INT_2_10_10_10_REV, 4U, true, false) : AddAttribute(f_attributes, f_stride, 2U, 4U, ROC_GEOMETRY_TYPE_BYTE, 4U, true, false);
+    if(l_hasSkin)
+    {
+        AddAttribute(f_attributes, f_stride, 3U, 4U, ROC_GEOMETRY_TYPE_UNSIGNED_BYTE, 4U, true, false);
+        l_boneByte ? AddAttribute(f_attributes, f_stride, 4U, 4U, ROC_GEOMETRY_TYPE_UNSIGNED_BYTE, 4U, false, true) : AddAttribute(f_attributes, f_stride, 4U, 4U, ROC_GEOMETRY_TYPE_UNSIGNED_SHORT, 8U, false, true);
+    }
+
+    f_data.assign(l_count*f_stride, 0U);
+    for(size_t i = 0U; i < l_count; i++)
+    {
+        unsigned char *l_vertex = f_data.data() + i*f_stride;
+        for(const auto &iter : f_attributes)
+        {
+            unsigned char *l_target = l_vertex + iter.m_offset;
+            switch(iter.m_location)
+            {
+                case 0U:
+                    std::memcpy(l_target, &f_vertices[i], sizeof(glm::vec3));
+                    break;
+                case 1U:
+                {
+                    if(l_uvUnorm)
+                    {
+                        glm::u16vec2 l_uv = PackUVUnorm16(f_uvs[i]);
+                        std::memcpy(l_target, &l_uv, sizeof(glm::u16vec2));
+                    }
+                    else std::memcpy(l_target, &f_uvs[i], sizeof(glm::vec2));
+                } break;
+                case 2U:
+                {
+                    if(f_packedNormals)
+                    {
+                        unsigned int l_normal = PackNormal1010102(f_normals[i]);
+                        std::memcpy(l_target, &l_normal, sizeof(unsigned int));
+                    }
+                    else
+                    {
+                        glm::i8vec4 l_normal = PackNormalSnorm8(f_normals[i]);
+                        std::memcpy(l_target, &l_normal, sizeof(glm::i8vec4));
+                    }
+                } break;
+                case 3U:
+                {
+                    glm::u8vec4 l_weight = PackWeightUnorm8(f_weights[i]);
+                    std::memcpy(l_target, &l_weight, sizeof(glm::u8vec4));
+                } break;
+                case 4U:
+                {
+                    glm::ivec4 l_bones = glm::max(f_indices[i], glm::ivec4(0));
+                    if(l_boneByte)
+                    {
+                        glm::u8vec4 l_index(l_bones);
+                        std::memcpy(l_target, &l_index, sizeof(glm::u8vec4));
+                    }
+                    else
+                    {
+                        glm::u16vec4 l_index(l_bones);
+                        std::memcpy(l_target, &l_index, sizeof(glm::u16vec4));
+                    }
+                } break;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace ROC
+{
+
+struct GeometryFileAttribute;
+
+}
+
+// Shared with modelConverter, no engine or OpenGL dependencies here
+namespace MeshUtils
+{
+
+void OptimizeVertexCache(std::vector<unsigned int> &f_indices, unsigned int f_vertexCount);
+
+glm::i8vec4 PackNormalSnorm8(const glm::vec3 &f_normal);
+void PackVertices(const std::vector<glm::vec3> &f_vertices, const std::vector<glm::vec2> &f_uvs, const std::vector<glm::vec3> &f_normals,
+    const std::vector<glm::vec4> &f_weights, const std::vector<glm::ivec4> &f_indices, bool f_packedNormals,
+    std::vector<ROC::GeometryFileAttribute> &f_attributes, unsigned int &f_stride, std::vector<unsigned char> &f_data);
+
+}
@@ -0,0 +1,306 @@
+#include "stdafx.h"
+
+#include "Utils/SpatialTree.h"
+
+float ROC::SpatialTree::GetBoxArea(const glm::vec3 &f_min, const glm::vec3 &f_max)
+{
+    glm::vec3 l_size = f_max - f_min;
+    return 2.f*(l_size.x*l_size.y + l_size.y*l_size.z + l_size.z*l_size.x);
+}
+bool ROC::SpatialTree::IsBoxOverlap(const glm::vec3 &f_minA, const glm::vec3 &f_maxA, const glm::vec3 &f_minB, const glm::vec3 &f_maxB)
+{
+    return ((f_minA.x <= f_maxB.x) && (f_minB.x <= f_maxA.x) && (f_minA.y <= f_maxB.y) && (f_minB.y <= f_maxA.y) && (f_minA.z <= f_maxB.z) && (f_minB.z <= f_maxA.z));
+}
+bool ROC::SpatialTree::IsBoxInSphere(const glm::vec3 &f_min, const glm::vec3 &f_max, const glm::vec3 &f_center, float f_radius)
+{
+    glm::vec3 l_offset = glm::clamp(f_center, f_min, f_max) - f_center;
+    return (glm::dot(l_offset, l_offset) <= f_radius*f_radius);
+}
+bool ROC::SpatialTree::IsBoxInFrustum(const glm::vec3 &f_min, const glm::vec3 &f_max, const glm::vec4 *f_planes)
+{
+    bool l_result = true;
+    glm::vec3 l_center = (f_min + f_max)*0.5f;
+    glm::vec3 l_extent = (f_max - f_min)*0.5f;
+    for(int i = 0; (i < 6) && l_result; i++)
+    {
+        const glm::vec4 &l_plane = f_planes[i];
+        float l_distance = l_plane.x*l_center.x + l_plane.y*l_center.y + l_plane.z*l_center.z + l_plane.w;
+        float l_radius = std::abs(l_plane.x)*l_extent.x + std::abs(l_plane.y)*l_extent.y + std::abs(l_plane.z)*l_extent.z;
+        l_result = (l_distance + l_radius >= 0.f);
+    }
+    return l_result;
+}
+
+ROC::SpatialTree::SpatialTree()
+{
+    m_root = ROC_SPATIALTREE_NULL_NODE;
+    m_freeNode = ROC_SPATIALTREE_NULL_NODE;
+}
+ROC::SpatialTree::~SpatialTree()
+{
+    m_nodes.clear();
+    m_stack.clear();
+}
+
+int ROC::SpatialTree::AllocateNode()
+{
+    int l_node;
+    if(m_freeNode == ROC_SPATIALTREE_NULL_NODE)
+    {
+        l_node = static_cast<int>(m_nodes.size());
+        m_nodes.emplace_back();
+    }
+    else
+    {
+        l_node = m_freeNode;
+        m_freeNode = m_nodes[l_node].m_parent;
+    }
+
+    stNode &l_nodeData = m_nodes[l_node];
+    l_nodeData.m_ptr = nullptr;
+    l_nodeData.m_parent = ROC_SPATIALTREE_NULL_NODE;
+    l_nodeData.m_left = ROC_SPATIALTREE_NULL_NODE;
+    l_nodeData.m_right = ROC_SPATIALTREE_NULL_NODE;
+    l_nodeData.m_height = 0;
+    return l_node;
+}
+void ROC::SpatialTree::FreeNode(int f_node)
+{
+    stNode &l_nodeData = m_nodes[f_node];
+    l_nodeData.m_ptr = nullptr;
+    l_nodeData.m_parent = m_freeNode;
+    l_nodeData.m_height = -1;
+    m_freeNode = f_node;
+}
+
+void ROC::SpatialTree::Combine(int f_node, int f_childA, int f_childB)
+{
+    stNode &l_node = m_nodes[f_node];
+    const stNode &l_childA = m_nodes[f_childA];
+    const stNode &l_childB = m_nodes[f_childB];
+    l_node.m_min = glm::min(l_childA.m_min, l_childB.m_min);
+    l_node.m_max = glm::max(l_childA.m_max, l_childB.m_max);
+    l_node.m_height = 1 + std::max(l_childA.m_height, l_childB.m_height);
+}
+
+void ROC::SpatialTree::InsertLeaf(int f_leaf)
+{
+    if(m_root == ROC_SPATIALTREE_NULL_NODE)
+    {
+        m_root = f_leaf;
+        m_nodes[f_leaf].m_parent = ROC_SPATIALTREE_NULL_NODE;
+        return;
+    }
+
+    // Descend to sibling with lowest surface area increase
+    glm::vec3 l_leafMin = m_nodes[f_leaf].m_min;
+    glm::vec3 l_leafMax = m_nodes[f_leaf].m_max;
+    int l_sibling = m_root;
+    while(!m_nodes[l_sibling].IsLeaf())
+    {
+        const stNode &l_node = m_nodes[l_sibling];
+        float l_area = GetBoxArea(l_node.m_min, l_node.m_max);
+        float l_combinedArea = GetBoxArea(glm::min(l_node.m_min, l_leafMin), glm::max(l_node.m_max, l_leafMax));
+        float l_cost = 2.f*l_combinedArea;
+        float l_inheritanceCost = 2.f*(l_combinedArea - l_area);
+
+        float l_childCost[2];
+        int l_children[2] = { l_node.m_left, l_node.m_right };
+        for(int i = 0; i < 2; i++)
+        {
+            const stNode &l_child = m_nodes[l_children[i]];
+            l_childCost[i] = GetBoxArea(glm::min(l_child.m_min, l_leafMin), glm::max(l_child.m_max, l_leafMax)) + l_inheritanceCost;
+            if(!l_child.IsLeaf()) l_childCost[i] -= GetBoxArea(l_child.m_min, l_child.m_max);
+        }
+
+        if((l_cost < l_childCost[0]) && (l_cost < l_childCost[1])) break;
+        l_sibling = (l_childCost[0] < l_childCost[1]) ? l_children[0] : l_children[1];
+    }
+
+    int l_oldParent = m_nodes[l_sibling].m_parent;
+    int l_newParent = AllocateNode();
+    m_nodes[l_newParent].m_parent = l_oldParent;
+    m_nodes[l_newParent].m_left = l_sibling;
+    m_nodes[l_newParent].m_right = f_leaf;
+    Combine(l_newParent, l_sibling, f_leaf);
+    m_nodes[l_sibling].m_parent = l_newParent;
+    m_nodes[f_leaf].m_parent = l_newParent;
+
+    if(l_oldParent != ROC_SPATIALTREE_NULL_NODE)
+    {
+        if(m_nodes[l_oldParent].m_left == l_sibling) m_nodes[l_oldParent].m_left = l_newParent;
+        else m_nodes[l_oldParent].m_right = l_newParent;
+    }
+    else m_root = l_newParent;
+
+    Refit(l_oldParent);
+}
+void ROC::SpatialTree::RemoveLeaf(int f_leaf)
+{
+    if(f_leaf == m_root)
+    {
+        m_root = ROC_SPATIALTREE_NULL_NODE;
+        return;
+    }
+
+    int l_parent = m_nodes[f_leaf].m_parent;
+    int l_grandParent = m_nodes[l_parent].m_parent;
+    int l_sibling = (m_nodes[l_parent].m_left == f_leaf) ? m_nodes[l_parent].m_right : m_nodes[l_parent].m_left;
+
+    // Sibling takes place of parent
+    m_nodes[l_sibling].m_parent = l_grandParent;
+    if(l_grandParent != ROC_SPATIALTREE_NULL_NODE)
+    {
+        if(m_nodes[l_grandParent].m_left == l_parent) m_nodes[l_grandParent].m_left = l_sibling;
+        else m_nodes[l_grandParent].m_right = l_sibling;
+    }
+    else m_root = l_sibling;
+    FreeNode(l_parent);
+
+    Refit(l_grandParent);
+}
+void ROC::SpatialTree::Refit(int f_node)
+{
+    for(int l_node = f_node; l_node != ROC_SPATIALTREE_NULL_NODE; l_node = m_nodes[l_node].m_parent)
+    {
+        l_node = Balance(l_node);
+        Combine(l_node, m_nodes[l_node].m_left, m_nodes[l_node].m_right);
+    }
+}
+int ROC::SpatialTree::Balance(int f_node)
+{
+    stNode &l_nodeA = m_nodes[f_node];
+    if(l_nodeA.IsLeaf() || (l_nodeA.m_height < 2)) return f_node;
+
+    int l_indexB = l_nodeA.m_left;
+    int l_indexC = l_nodeA.m_right;
+    int l_balance = m_nodes[l_indexC].m_height - m_nodes[l_indexB].m_height;
+    if((l_balance >= -1) && (l_balance <= 1)) return f_node;
+
+    // Higher child is rotated up, its higher grandchild stays with it and other one goes to former parent
+    bool l_rightHigher = (l_balance > 1);
+    int l_up = l_rightHigher ? l_indexC : l_indexB;
+    int l_stay = l_rightHigher ? l_indexB : l_indexC;
+    stNode &l_upNode = m_nodes[l_up];
+    int l_grandA = l_upNode.m_left;
+    int l_grandB = l_upNode.m_right;
+    int l_higher = (m_nodes[l_grandA].m_height > m_nodes[l_grandB].m_height) ? l_grandA : l_grandB;
+    int l_lower = (l_higher == l_grandA) ? l_grandB : l_grandA;
+
+    l_upNode.m_left = f_node;
+    l_upNode.m_right = l_higher;
+    l_upNode.m_parent = l_nodeA.m_parent;
+    l_nodeA.m_parent = l_up;
+    if(l_upNode.m_parent != ROC_SPATIALTREE_NULL_NODE)
+    {
+        stNode &l_parentNode = m_nodes[l_upNode.m_parent];
+        if(l_parentNode.m_left == f_node) l_parentNode.m_left = l_up;
+        else l_parentNode.m_right = l_up;
+    }
+    else m_root = l_up;
+
+    if(l_rightHigher) l_nodeA.m_right = l_lower;
+    else l_nodeA.m_left = l_lower;
+    m_nodes[l_lower].m_parent = f_node;
+    m_nodes[l_higher].m_parent = l_up;
+
+    Combine(f_node, l_stay, l_lower);
+    Combine(l_up, f_node, l_higher);
+    return l_up;
+}
+
+int ROC::SpatialTree::Insert(void *f_ptr, const glm::vec3 &f_min, const glm::vec3 &f_max)
+{
+    int l_leaf = AllocateNode();
+    stNode &l_leafNode = m_nodes[l_leaf];
+    l_leafNode.m_ptr = f_ptr;
+    l_leafNode.m_boundMin = f_min;
+    l_leafNode.m_boundMax = f_max;
+    l_leafNode.m_min = f_min - glm::vec3(ROC_SPATIALTREE_MARGIN);
+    l_leafNode.m_max = f_max + glm::vec3(ROC_SPATIALTREE_MARGIN);
+    InsertLeaf(l_leaf);
+    return l_leaf;
+}
+void ROC::SpatialTree::Remove(int f_proxy)
+{
+    RemoveLeaf(f_proxy);
+    FreeNode(f_proxy);
+}
+bool ROC::SpatialTree::Move(int f_proxy, const glm::vec3 &f_min, const glm::vec3 &f_max)
+{
+    bool l_result = false;
+    stNode &l_leafNode = m_nodes[f_proxy];
+    l_leafNode.m_boundMin = f_min;
+    l_leafNode.m_boundMax = f_max;
+    if(glm::any(glm::lessThan(f_min, l_leafNode.m_min)) || glm::any(glm::greaterThan(f_max, l_leafNode.m_max)))
+    {
+        // Leaf is reinserted only when bounds leave enlarged box
+        RemoveLeaf(f_proxy);
+        l_leafNode.m_min = f_min - glm::vec3(ROC_SPATIALTREE_MARGIN);
+        l_leafNode.m_max = f_max + glm::vec3(ROC_SPATIALTREE_MARGIN);
+        InsertLeaf(f_proxy);
+        l_result = true;
+    }
+    return l_result;
+}
+
+void ROC::SpatialTree::QueryBox(const glm::vec3 &f_min, const glm::vec3 &f_max, std::vector<void*> &f_result)
+{
+    if(m_root != ROC_SPATIALTREE_NULL_NODE) m_stack.push_back(m_root);
+    while(!m_stack.empty())
+    {
+        const stNode &l_node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        if(!IsBoxOverlap(l_node.m_min, l_node.m_max, f_min, f_max)) continue;
+
+        if(l_node.IsLeaf())
+        {
+            if(IsBoxOverlap(l_node.m_boundMin, l_node.m_boundMax, f_min, f_max)) f_result.push_back(l_node.m_ptr);
+        }
+        else
+        {
+            m_stack.push_back(l_node.m_left);
+            m_stack.push_back(l_node.m_right);
+        }
+    }
+}
+void ROC::SpatialTree::QuerySphere(const glm::vec3 &f_center, float f_radius, std::vector<void*> &f_result)
+{
+    if(m_root != ROC_SPATIALTREE_NULL_NODE) m_stack.push_back(m_root);
+    while(!m_stack.empty())
+    {
+        const stNode &l_node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        if(!IsBoxInSphere(l_node.m_min, l_node.m_max, f_center, f_radius)) continue;
+
+        if(l_node.IsLeaf())
+        {
+            if(IsBoxInSphere(l_node.m_boundMin, l_node.m_boundMax, f_center, f_radius)) f_result.push_back(l_node.m_ptr);
+        }
+        else
+        {
+            m_stack.push_back(l_node.m_left);
+            m_stack.push_back(l_node.m_right);
+        }
+    }
+}
+void ROC::SpatialTree::QueryFrustum(const glm::vec4 *f_planes, std::vector<void*> &f_result)
+{
+    if(m_root != ROC_SPATIALTREE_NULL_NODE) m_stack.push_back(m_root);
+    while(!m_stack.empty())
+    {
+        const stNode &l_node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        if(!IsBoxInFrustum(l_node.m_min, l_node.m_max, f_planes)) continue;
+
+        if(l_node.IsLeaf())
+        {
+            if(IsBoxInFrustum(l_node.m_boundMin, l_node.m_boundMax, f_planes)) f_result.push_back(l_node.m_ptr);
+        }
+        else
+        {
+            m_stack.push_back(l_node.m_left);
+            m_stack.push_back(l_node.m_right);
+        }
+    }
+}
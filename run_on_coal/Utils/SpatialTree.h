@@ -0,0 +1,59 @@
+#pragma once
+
+#define ROC_SPATIALTREE_NULL_NODE -1
+#define ROC_SPATIALTREE_MARGIN 0.5f
+
+namespace ROC
+{
+
+// Dynamic bounding volume hierarchy, leaves keep enlarged boxes to skip reinsertion on small moves
+class SpatialTree final
+{
+    struct stNode
+    {
+        glm::vec3 m_min;
+        glm::vec3 m_max;
+        glm::vec3 m_boundMin;
+        glm::vec3 m_boundMax;
+        void *m_ptr = nullptr;
+        int m_parent = ROC_SPATIALTREE_NULL_NODE; // Next free node for unused nodes
+        int m_left = ROC_SPATIALTREE_NULL_NODE;
+        int m_right = ROC_SPATIALTREE_NULL_NODE;
+        int m_height = -1;
+
+        inline bool IsLeaf() const { return (m_left == ROC_SPATIALTREE_NULL_NODE); }
+    };
+    std::vector<stNode> m_nodes;
+    int m_root;
+    int m_freeNode;
+    std::vector<int> m_stack;
+
+    int AllocateNode();
+    void FreeNode(int f_node);
+    void InsertLeaf(int f_leaf);
+    void RemoveLeaf(int f_leaf);
+    void Refit(int f_node);
+    int Balance(int f_node);
+    void Combine(int f_node, int f_childA, int f_childB);
+
+    static float GetBoxArea(const glm::vec3 &f_min, const glm::vec3 &f_max);
+    static bool IsBoxOverlap(const glm::vec3 &f_minA, const glm::vec3 &f_maxA, const glm::vec3 &f_minB, const glm::vec3 &f_maxB);
+    static bool IsBoxInSphere(const glm::vec3 &f_min, const glm::vec3 &f_max, const glm::vec3 &f_center, float f_radius);
+    static bool IsBoxInFrustum(const glm::vec3 &f_min, const glm::vec3 &f_max, const glm::vec4 *f_planes);
+
+    SpatialTree(const SpatialTree &that);
+    SpatialTree &operator =(const SpatialTree &that);
+public:
+    SpatialTree();
+    ~SpatialTree();
+
+    int Insert(void *f_ptr, const glm::vec3 &f_min, const glm::vec3 &f_max);
+    void Remove(int f_proxy);
+    bool Move(int f_proxy, const glm::vec3 &f_min, const glm::vec3 &f_max);
+
+    void QueryBox(const glm::vec3 &f_min, const glm::vec3 &f_max, std::vector<void*> &f_result);
+    void QuerySphere(const glm::vec3 &f_center, float f_radius, std::vector<void*> &f_result);
+    void QueryFrustum(const glm::vec4 *f_planes, std::vector<void*> &f_result);
+};
+
+}
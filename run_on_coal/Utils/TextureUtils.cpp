@@ -0,0 +1,285 @@
+#include "stdafx.h"
+
+#include "Utils/TextureUtils.h"
+
+#define ROC_TEXTURE_DDS_MAGIC 0x20534444U
+#define ROC_TEXTURE_DDS_MIPMAPCOUNT 0x20000U
+#define ROC_TEXTURE_DDS_FOURCC 0x4U
+#define ROC_TEXTURE_DDS_CUBEMAP 0x200U
+#define ROC_TEXTURE_DDS_VOLUME 0x200000U
+#define ROC_TEXTURE_KTX_ENDIANNESS 0x04030201U
+
+namespace TextureUtils
+{
+
+struct DDSPixelFormat
+{
+    unsigned int m_size;
+    unsigned int m_flags;
+    unsigned int m_fourCC;
+    unsigned int m_bitCount;
+    unsigned int m_masks[4];
+};
+struct DDSHeader
+{
+    unsigned int m_size;
+    unsigned int m_flags;
+    unsigned int m_height;
+    unsigned int m_width;
+    unsigned int m_pitch;
+    unsigned int m_depth;
+    unsigned int m_mipMapCount;
+    unsigned int m_reserved1[11];
+    DDSPixelFormat m_pixelFormat;
+    unsigned int m_caps[4];
+    unsigned int m_reserved2;
+};
+struct DDSHeaderDX10
+{
+    unsigned int m_dxgiFormat;
+    unsigned int m_dimension;
+    unsigned int m_miscFlag;
+    unsigned int m_arraySize;
+    unsigned int m_miscFlags2;
+};
+struct KTXHeader
+{
+    unsigned char m_identifier[12];
+    unsigned int m_endianness;
+    unsigned int m_glType;
+    unsigned int m_glTypeSize;
+    unsigned int m_glFormat;
+    unsigned int m_glInternalFormat;
+    unsigned int m_glBaseInternalFormat;
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_depth;
+    unsigned int m_arrayElements;
+    unsigned int m_faces;
+    unsigned int m_mipmapLevels;
+    unsigned int m_keyValueBytes;
+};
+
+static_assert(sizeof(DDSHeader) == 124U, "DDSHeader layout");
+static_assert(sizeof(KTXHeader) == 64U, "KTXHeader layout");
+
+const unsigned char g_KTXIdentifier[12] = { 0xABU, 0x4BU, 0x54U, 0x58U, 0x20U, 0x31U, 0x31U, 0xBBU, 0x0DU, 0x0AU, 0x1AU, 0x0AU };
+
+unsigned int MakeFourCC(char f_a, char f_b, char f_c, char f_d)
+{
+    return (static_cast<unsigned int>(f_a) | (static_cast<unsigned int>(f_b) << 8) | (static_cast<unsigned int>(f_c) << 16) | (static_cast<unsigned int>(f_d) << 24));
+}
+
+// BC1, BC3 and BC7 only, sRGB variants are read as linear like the rest of textures
+GLenum GetDXGIFormat(unsigned int f_format)
+{
+    GLenum l_format = GL_NONE;
+    switch(f_format)
+    {
+        case 71U: case 72U:
+            l_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            break;
+        case 77U: case 78U:
+            l_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            break;
+        case 98U: case 99U:
+            l_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            break;
+    }
+    return l_format;
+}
+GLenum GetKTXFormat(unsigned int f_format)
+{
+    GLenum l_format = GL_NONE;
+    switch(f_format)
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            l_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+            l_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            l_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            break;
+        case GL_COMPRESSED_RGBA_BPTC_UNORM: case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            l_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            break;
+    }
+    return l_format;
+}
+bool IsFormatSupported(GLenum f_format)
+{
+    bool l_result = false;
+    switch(f_format)
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            l_result = (GLEW_EXT_texture_compression_s3tc == GL_TRUE);
+            break;
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+            l_result = ((GLEW_VERSION_4_2 == GL_TRUE) || (GLEW_ARB_texture_compression_bptc == GL_TRUE));
+            break;
+    }
+    return l_result;
+}
+size_t GetLevelSize(GLenum f_format, int f_width, int f_height)
+{
+    size_t l_blockSize = ((f_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) || (f_format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT)) ? 8U : 16U;
+    return static_cast<size_t>(std::max((f_width + 3) / 4, 1))*static_cast<size_t>(std::max((f_height + 3) / 4, 1))*l_blockSize;
+}
+
+unsigned int GetMaxLevels(int f_width, int f_height)
+{
+    // Full chain is floor(log2(max(w,h)))+1, also keeps level shifts below 32
+    unsigned int l_levels = 1U;
+    for(int l_size = std::max(f_width, f_height); l_size > 1; l_size >>= 1) l_levels++;
+    return l_levels;
+}
+
+bool ReadFileData(const std::string &f_path, std::vector<unsigned char> &f_data)
+{
+    std::ifstream l_file(f_path, std::ios::binary);
+    if(l_file)
+    {
+        l_file.seekg(0, std::ios::end);
+        f_data.resize(static_cast<size_t>(l_file.tellg()));
+        l_file.seekg(0, std::ios::beg);
+        if(!f_data.empty()) l_file.read(reinterpret_cast<char*>(f_data.data()), f_data.size());
+    }
+    return (l_file && !f_data.empty());
+}
+
+bool LoadDDS(const std::vector<unsigned char> &f_file, CompressedImage &f_image)
+{
+    bool l_result = false;
+    if(f_file.size() > sizeof(unsigned int) + sizeof(DDSHeader))
+    {
+        unsigned int l_magic;
+        DDSHeader l_header;
+        std::memcpy(&l_magic, f_file.data(), sizeof(unsigned int));
+        std::memcpy(&l_header, f_file.data() + sizeof(unsigned int), sizeof(DDSHeader));
+        size_t l_offset = sizeof(unsigned int) + sizeof(DDSHeader);
+
+        if((l_magic == ROC_TEXTURE_DDS_MAGIC) && (l_header.m_size == sizeof(DDSHeader)) && ((l_header.m_caps[1] & (ROC_TEXTURE_DDS_CUBEMAP | ROC_TEXTURE_DDS_VOLUME)) == 0U) && ((l_header.m_pixelFormat.m_flags&ROC_TEXTURE_DDS_FOURCC) != 0U))
+        {
+            f_image.m_format = GL_NONE;
+            unsigned int l_fourCC = l_header.m_pixelFormat.m_fourCC;
+            if(l_fourCC == MakeFourCC('D', 'X', 'T', '1')) f_image.m_format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            else if(l_fourCC == MakeFourCC('D', 'X', 'T', '5')) f_image.m_format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            else if((l_fourCC == MakeFourCC('D', 'X', '1', '0')) && (f_file.size() > l_offset + sizeof(DDSHeaderDX10)))
+            {
+                DDSHeaderDX10 l_headerDX10;
+                std::memcpy(&l_headerDX10, f_file.data() + l_offset, sizeof(DDSHeaderDX10));
+                l_offset += sizeof(DDSHeaderDX10);
+                if(l_headerDX10.m_arraySize <= 1U) f_image.m_format = GetDXGIFormat(l_headerDX10.m_dxgiFormat);
+            }
+
+            if(f_image.m_format != GL_NONE)
+            {
+                f_image.m_width = static_cast<int>(l_header.m_width);
+                f_image.m_height = static_cast<int>(l_header.m_height);
+                unsigned int l_levels = ((l_header.m_flags&ROC_TEXTURE_DDS_MIPMAPCOUNT) != 0U) ? std::max(l_header.m_mipMapCount, 1U) : 1U;
+                l_levels = std::min(l_levels, GetMaxLevels(f_image.m_width, f_image.m_height));
+
+                // Levels follow each other without padding
+                l_result = true;
+                size_t l_dataSize = 0U;
+                for(unsigned int i = 0U; i < l_levels; i++)
+                {
+                    CompressedLevel l_level;
+                    l_level.m_width = std::max(f_image.m_width >> i, 1);
+                    l_level.m_height = std::max(f_image.m_height >> i, 1);
+                    l_level.m_offset = l_dataSize;
+                    l_level.m_size = GetLevelSize(f_image.m_format, l_level.m_width, l_level.m_height);
+                    l_dataSize += l_level.m_size;
+                    if(l_offset + l_dataSize > f_file.size())
+                    {
+                        l_result = false;
+                        break;
+                    }
+                    f_image.m_levels.push_back(l_level);
+                }
+                if(l_result) f_image.m_data.assign(f_file.begin() + l_offset, f_file.begin() + l_offset + l_dataSize);
+            }
+        }
+    }
+    return l_result;
+}
+bool LoadKTX(const std::vector<unsigned char> &f_file, CompressedImage &f_image)
+{
+    bool l_result = false;
+    if(f_file.size() > sizeof(KTXHeader))
+    {
+        KTXHeader l_header;
+        std::memcpy(&l_header, f_file.data(), sizeof(KTXHeader));
+        if(!std::memcmp(l_header.m_identifier, g_KTXIdentifier, sizeof(g_KTXIdentifier)) && (l_header.m_endianness == ROC_TEXTURE_KTX_ENDIANNESS) && (l_header.m_glType == 0U)
+            && (l_header.m_depth == 0U) && (l_header.m_arrayElements == 0U) && (l_header.m_faces == 1U))
+        {
+            f_image.m_format = GetKTXFormat(l_header.m_glInternalFormat);
+            if(f_image.m_format != GL_NONE)
+            {
+                f_image.m_width = static_cast<int>(l_header.m_width);
+                f_image.m_height = static_cast<int>(l_header.m_height);
+                unsigned int l_levels = std::min(std::max(l_header.m_mipmapLevels, 1U), GetMaxLevels(f_image.m_width, f_image.m_height));
+
+                // Each level is prefixed by its size, block sizes keep levels 4 bytes aligned
+                size_t l_offset = sizeof(KTXHeader) + l_header.m_keyValueBytes;
+                l_result = true;
+                for(unsigned int i = 0U; i < l_levels; i++)
+                {
+                    unsigned int l_imageSize = 0U;
+                    if(l_offset + sizeof(unsigned int) <= f_file.size()) std::memcpy(&l_imageSize, f_file.data() + l_offset, sizeof(unsigned int));
+                    l_offset += sizeof(unsigned int);
+
+                    CompressedLevel l_level;
+                    l_level.m_width = std::max(f_image.m_width >> i, 1);
+                    l_level.m_height = std::max(f_image.m_height >> i, 1);
+                    l_level.m_offset = f_image.m_data.size();
+                    l_level.m_size = GetLevelSize(f_image.m_format, l_level.m_width, l_level.m_height);
+                    if((l_imageSize != l_level.m_size) || (l_offset + l_level.m_size > f_file.size()))
+                    {
+                        l_result = false;
+                        break;
+                    }
+                    f_image.m_data.insert(f_image.m_data.end(), f_file.begin() + l_offset, f_file.begin() + l_offset + l_level.m_size);
+                    f_image.m_levels.push_back(l_level);
+                    l_offset += l_level.m_size;
+                }
+            }
+        }
+    }
+    return l_result;
+}
+
+bool IsCompressedContainer(const std::string &f_path)
+{
+    bool l_result = false;
+    size_t l_dot = f_path.find_last_of('.');
+    if(l_dot != std::string::npos)
+    {
+        std::string l_extension = f_path.substr(l_dot + 1U);
+        std::transform(l_extension.begin(), l_extension.end(), l_extension.begin(), ::tolower);
+        l_result = ((l_extension == "dds") || (l_extension == "ktx"));
+    }
+    return l_result;
+}
+
+bool LoadCompressedImage(const std::string &f_path, CompressedImage &f_image)
+{
+    // No GL calls here, safe to run on loader threads
+    bool l_result = false;
+    std::vector<unsigned char> l_file;
+    if(ReadFileData(f_path, l_file))
+    {
+        for(int i = 0; (i < 2) && !l_result; i++)
+        {
+            f_image.m_data.clear();
+            f_image.m_levels.clear();
+            l_result = ((i == 0) ? LoadDDS(l_file, f_image) : LoadKTX(l_file, f_image));
+        }
+        if(l_result) l_result = ((f_image.m_width > 0) && (f_image.m_height > 0) && !f_image.m_levels.empty() && IsFormatSupported(f_image.m_format));
+    }
+    return l_result;
+}
+
+}
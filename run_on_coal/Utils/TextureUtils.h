@@ -0,0 +1,25 @@
+#pragma once
+
+namespace TextureUtils
+{
+
+struct CompressedLevel
+{
+    size_t m_offset;
+    size_t m_size;
+    int m_width;
+    int m_height;
+};
+struct CompressedImage
+{
+    GLenum m_format;
+    int m_width;
+    int m_height;
+    std::vector<unsigned char> m_data;
+    std::vector<CompressedLevel> m_levels;
+};
+
+bool IsCompressedContainer(const std::string &f_path);
+bool LoadCompressedImage(const std::string &f_path, CompressedImage &f_image);
+
+}
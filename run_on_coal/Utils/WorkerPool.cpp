@@ -0,0 +1,63 @@
+#include "stdafx.h"
+
+#include "Utils/WorkerPool.h"
+
+ROC::WorkerPool::WorkerPool(unsigned int f_threads)
+{
+    m_updateFrame = 0U;
+    m_activeThreads = 0U;
+    m_threadSwitch = true;
+    m_job = nullptr;
+    m_jobData = nullptr;
+
+    unsigned int l_threadsCount = std::min(f_threads, ROC_WORKERPOOL_MAX_THREADS);
+    for(unsigned int i = 1U; i <= l_threadsCount; i++) m_threads.push_back(new std::thread(&ROC::WorkerPool::WorkerThread, this, i));
+}
+ROC::WorkerPool::~WorkerPool()
+{
+    m_threadMutex.lock();
+    m_threadSwitch = false;
+    m_threadMutex.unlock();
+    m_updateCondition.notify_all();
+    for(auto iter : m_threads)
+    {
+        iter->join();
+        delete iter;
+    }
+    m_threads.clear();
+}
+
+void ROC::WorkerPool::Run(WorkerJob f_job, void *f_data)
+{
+    m_job = f_job;
+    m_jobData = f_data;
+
+    m_threadMutex.lock();
+    m_activeThreads = static_cast<unsigned int>(m_threads.size());
+    m_updateFrame++;
+    m_threadMutex.unlock();
+    m_updateCondition.notify_all();
+
+    (*f_job)(f_data, 0U);
+
+    std::unique_lock<std::mutex> l_lock(m_threadMutex);
+    while(m_activeThreads > 0U) m_finishCondition.wait(l_lock);
+}
+
+void ROC::WorkerPool::WorkerThread(unsigned int f_index)
+{
+    unsigned long long l_frame = 0U;
+    std::unique_lock<std::mutex> l_lock(m_threadMutex);
+    while(true)
+    {
+        while(m_threadSwitch && (m_updateFrame == l_frame)) m_updateCondition.wait(l_lock);
+        if(!m_threadSwitch) break;
+        l_frame = m_updateFrame;
+        l_lock.unlock();
+
+        (*m_job)(m_jobData, f_index);
+
+        l_lock.lock();
+        if(--m_activeThreads == 0U) m_finishCondition.notify_one();
+    }
+}
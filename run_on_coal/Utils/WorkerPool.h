@@ -0,0 +1,40 @@
+#pragma once
+
+#define ROC_WORKERPOOL_MAX_THREADS 8U
+
+namespace ROC
+{
+
+typedef void(*WorkerJob)(void*, unsigned int);
+
+// Engine wide worker threads, managers run their parallel stages on them one after another
+class WorkerPool final
+{
+    // Main thread takes part in jobs too and has index 0
+    std::vector<std::thread*> m_threads;
+    std::mutex m_threadMutex;
+    std::condition_variable m_updateCondition;
+    std::condition_variable m_finishCondition;
+    unsigned long long m_updateFrame;
+    unsigned int m_activeThreads;
+    bool m_threadSwitch;
+
+    WorkerJob m_job;
+    void *m_jobData;
+
+    void WorkerThread(unsigned int f_index);
+
+    WorkerPool(const WorkerPool &that);
+    WorkerPool &operator =(const WorkerPool &that);
+public:
+    explicit WorkerPool(unsigned int f_threads);
+    ~WorkerPool();
+
+    inline unsigned int GetThreadsCount() const { return static_cast<unsigned int>(m_threads.size() + 1U); }
+    inline bool HasWorkers() const { return !m_threads.empty(); }
+
+    // Job is called once on every thread with its index and has to split work by itself, returns when all threads are done
+    void Run(WorkerJob f_job, void *f_data);
+};
+
+}
@@ -9,12 +9,16 @@
 #include <regex>
 #include <vector>
 #include <queue>
+#include <map>
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 #include <limits>
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <ctime>
 #include <direct.h>
 
@@ -44,7 +48,6 @@
 #include "lua.hpp"
 #include "pugixml.hpp"
 #include "zlib.h"
-#include "IntervalTree.h"
 
 #include "MessageIdentifiers.h"
 #include "BitStream.h"